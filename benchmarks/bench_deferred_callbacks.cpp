@@ -0,0 +1,52 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include "bench_platform.hpp"
+
+extern "C" {
+#include "monkeyboard_deferred_callbacks.h"
+}
+
+static uint32_t executed_callbacks = 0;
+
+static void count_callback(void* context) {
+    (void)context;
+    executed_callbacks++;
+}
+
+// Schedules state.range(0) callbacks and cancels them, as the pipelines do when a key resolves before its timeout
+static void BM_DeferredScheduleCancel(benchmark::State& state) {
+    uint8_t count = (uint8_t)state.range(0);
+    deferred_token_t tokens[MAX_DEFERRED_CALLBACKS];
+    g_bench_state.reset();
+
+    for (auto _ : state) {
+        for (uint8_t i = 0; i < count; i++) {
+            tokens[i] = schedule_deferred_callback(200 - i, count_callback, nullptr);
+        }
+        for (uint8_t i = 0; i < count; i++) {
+            benchmark::DoNotOptimize(cancel_deferred_callback(tokens[i]));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_DeferredScheduleCancel)->Arg(1)->Arg(4)->Arg(MAX_DEFERRED_CALLBACKS);
+
+// Schedules state.range(0) callbacks and lets them expire, executing them in order
+static void BM_DeferredScheduleExecute(benchmark::State& state) {
+    uint8_t count = (uint8_t)state.range(0);
+    g_bench_state.reset();
+    executed_callbacks = 0;
+    platform_time_t time = 0;
+
+    for (auto _ : state) {
+        g_bench_state.timer = time;
+        for (uint8_t i = 0; i < count; i++) {
+            schedule_deferred_callback(200 - i, count_callback, nullptr);
+        }
+        time += 200;
+        g_bench_state.set_timer(time);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+    state.counters["executed_per_iteration"] = (double)executed_callbacks / (double)state.iterations();
+}
+BENCHMARK(BM_DeferredScheduleExecute)->Arg(1)->Arg(4)->Arg(MAX_DEFERRED_CALLBACKS);
@@ -0,0 +1,79 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include "bench_platform.hpp"
+#include "platform_types.h"
+
+extern "C" {
+#include "key_event_buffer.h"
+}
+
+static platform_keypos_t bench_keypos(uint8_t index) {
+    platform_keypos_t keypos;
+    keypos.row = index / 12;
+    keypos.col = index % 12;
+    return keypos;
+}
+
+// Presses state.range(0) keys and releases them in the same order, as a roll held back by a pipeline
+static void BM_EventBufferAddPressRelease(benchmark::State& state) {
+    uint8_t keys = (uint8_t)state.range(0);
+    platform_key_event_buffer_t* buffer = platform_key_event_create_with_capacity(2 * keys, keys, false);
+    bool buffer_full = false;
+    platform_time_t time = 0;
+
+    for (auto _ : state) {
+        for (uint8_t i = 0; i < keys; i++) {
+            benchmark::DoNotOptimize(platform_key_event_add_physical_press(buffer, time++, bench_keypos(i), 0x04 + i, &buffer_full));
+        }
+        for (uint8_t i = 0; i < keys; i++) {
+            benchmark::DoNotOptimize(platform_key_event_add_physical_release(buffer, time++, bench_keypos(i), &buffer_full));
+        }
+        platform_key_event_reset(buffer);
+    }
+    state.SetItemsProcessed(state.iterations() * keys * 2);
+}
+BENCHMARK(BM_EventBufferAddPressRelease)->Arg(2)->Arg(8)->Arg(PLATFORM_KEY_EVENT_MAX_ELEMENTS / 2);
+
+// Removes the presses of state.range(0) buffered events by press id, oldest first: every removal compacts the
+// remaining events. The cost of adding the presses is included
+static void BM_EventBufferRemoveByPressId(benchmark::State& state) {
+    uint8_t keys = (uint8_t)state.range(0);
+    platform_key_event_buffer_t* buffer = platform_key_event_create_with_capacity(keys, keys, false);
+    uint8_t press_ids[PLATFORM_KEY_EVENT_MAX_ELEMENTS];
+    bool buffer_full = false;
+    platform_time_t time = 0;
+
+    for (auto _ : state) {
+        for (uint8_t i = 0; i < keys; i++) {
+            press_ids[i] = platform_key_event_add_physical_press(buffer, time++, bench_keypos(i), 0x04 + i, &buffer_full);
+        }
+        for (uint8_t i = 0; i < keys; i++) {
+            benchmark::DoNotOptimize(platform_key_event_remove_physical_press_by_press_id(buffer, press_ids[i]));
+        }
+        platform_key_event_reset(buffer);
+    }
+    state.SetItemsProcessed(state.iterations() * keys);
+}
+BENCHMARK(BM_EventBufferRemoveByPressId)->Arg(2)->Arg(8)->Arg(PLATFORM_KEY_EVENT_MAX_ELEMENTS);
+
+// Taps a key while state.range(0) keys are held. The press id of the tap is searched among the held presses and the
+// buffered events, so its cost grows with the number of held keys
+static void BM_EventBufferPressIdWithHeldKeys(benchmark::State& state) {
+    uint8_t held = (uint8_t)state.range(0);
+    platform_key_event_buffer_t* buffer = platform_key_event_create_with_capacity(held + 2, held + 1, false);
+    bool buffer_full = false;
+    platform_time_t time = 0;
+    for (uint8_t i = 0; i < held; i++) {
+        platform_key_event_add_physical_press(buffer, time++, bench_keypos(i), 0x04 + i, &buffer_full);
+    }
+
+    platform_keypos_t tapped = bench_keypos(held);
+    for (auto _ : state) {
+        uint8_t press_id = platform_key_event_add_physical_press(buffer, time++, tapped, 0x04, &buffer_full);
+        platform_key_event_add_physical_release(buffer, time++, tapped, &buffer_full);
+        platform_key_event_remove_physical_press_by_press_id(buffer, press_id);
+        platform_key_event_remove_physical_release_by_press_id(buffer, press_id);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_EventBufferPressIdWithHeldKeys)->Arg(0)->Arg(4)->Arg(PLATFORM_KEY_EVENT_MAX_ELEMENTS - 2);
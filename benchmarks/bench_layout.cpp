@@ -0,0 +1,76 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <vector>
+#include "bench_platform.hpp"
+#include "platform_interface.h"
+#include "platform_types.h"
+
+// Keyboard sizes: 4x12 (48 keys, 40% board) and 6x21 (126 keys, full size board)
+static void keyboard_sizes(benchmark::internal::Benchmark* benchmark) {
+    benchmark->Args({4, 12})->Args({6, 21});
+}
+
+static std::vector<platform_keycode_t> make_keymap(uint8_t num_layers, uint8_t rows, uint8_t cols) {
+    std::vector<platform_keycode_t> keymap(num_layers * rows * cols);
+    for (size_t i = 0; i < keymap.size(); i++) {
+        keymap[i] = (platform_keycode_t)(0x04 + i % 0x60);
+    }
+    return keymap;
+}
+
+// Resolves every key through get_keycode_from_layer_fn, as the key presses did before the resolved keymap
+static void BM_LayoutLookupFromLayer(benchmark::State& state) {
+    uint8_t rows = state.range(0);
+    uint8_t cols = state.range(1);
+    std::vector<platform_keycode_t> keymap = make_keymap(4, rows, cols);
+    bench_init_layout(keymap, 4, rows, cols);
+    platform_layout_set_layer(2);
+
+    for (auto _ : state) {
+        platform_keypos_t position;
+        for (position.row = 0; position.row < rows; position.row++) {
+            for (position.col = 0; position.col < cols; position.col++) {
+                uint8_t layer = platform_layout_get_current_layer();
+                benchmark::DoNotOptimize(platform_layout_get_keycode_from_layer(layer, position));
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * rows * cols);
+}
+BENCHMARK(BM_LayoutLookupFromLayer)->Apply(keyboard_sizes);
+
+// Resolves every key through the resolved keymap of the current layer
+static void BM_LayoutLookupResolved(benchmark::State& state) {
+    uint8_t rows = state.range(0);
+    uint8_t cols = state.range(1);
+    std::vector<platform_keycode_t> keymap = make_keymap(4, rows, cols);
+    bench_init_layout(keymap, 4, rows, cols);
+    platform_layout_set_layer(2);
+
+    for (auto _ : state) {
+        platform_keypos_t position;
+        for (position.row = 0; position.row < rows; position.row++) {
+            for (position.col = 0; position.col < cols; position.col++) {
+                benchmark::DoNotOptimize(platform_layout_get_keycode(position));
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * rows * cols);
+}
+BENCHMARK(BM_LayoutLookupResolved)->Apply(keyboard_sizes);
+
+// Cost of a layer change, which rebuilds the resolved keymap
+static void BM_LayoutLayerChange(benchmark::State& state) {
+    uint8_t rows = state.range(0);
+    uint8_t cols = state.range(1);
+    std::vector<platform_keycode_t> keymap = make_keymap(4, rows, cols);
+    bench_init_layout(keymap, 4, rows, cols);
+
+    uint8_t layer = 0;
+    for (auto _ : state) {
+        layer = (layer + 1) % 4;
+        platform_layout_set_layer(layer);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LayoutLayerChange)->Apply(keyboard_sizes);
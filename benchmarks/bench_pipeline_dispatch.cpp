@@ -0,0 +1,63 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <vector>
+#include "bench_platform.hpp"
+#include "platform_types.h"
+
+// Built twice: in the benchmarks executable the pipelines are registered at runtime and called through the function
+// pointer tables, in benchmarks_static they are the static pipeline list (MONKEYBOARD_STATIC_PIPELINES) built with LTO
+
+struct BenchKeyEvent {
+    uint8_t row;
+    uint8_t col;
+    bool pressed;
+    platform_time_t delta;
+};
+
+// Typing through the four pipelines: plain keys, a tap dance tap, the oneshot key, the key replacer and a combo
+static std::vector<BenchKeyEvent> make_typing_sequence(void) {
+    std::vector<BenchKeyEvent> events;
+    for (uint8_t i = 0; i < 24; i++) {
+        uint8_t row = 1 + i / 12;
+        uint8_t col = i % 12;
+        events.push_back({row, col, true, 40});
+        events.push_back({row, col, false, 30});
+    }
+    events.push_back({0, 0, true, 40});
+    events.push_back({0, 0, false, 30});
+    events.push_back({0, 1, true, 300});
+    events.push_back({0, 1, false, 30});
+    events.push_back({1, 0, true, 40});
+    events.push_back({1, 0, false, 30});
+    events.push_back({0, 2, true, 40});
+    events.push_back({0, 2, false, 30});
+    events.push_back({BENCH_COMBO_ROW, 10, true, 40});
+    events.push_back({BENCH_COMBO_ROW, 11, true, 5});
+    events.push_back({BENCH_COMBO_ROW, 10, false, 80});
+    events.push_back({BENCH_COMBO_ROW, 11, false, 5});
+    return events;
+}
+
+static void BM_PipelineTyping(benchmark::State& state) {
+    bench_init_pipelines();
+    std::vector<BenchKeyEvent> events = make_typing_sequence();
+    platform_time_t time = 0;
+    uint64_t cycles = 0;
+
+    for (auto _ : state) {
+        uint64_t start = bench_cycles();
+        for (const BenchKeyEvent& event : events) {
+            time += event.delta;
+            bench_process_key(event.row, event.col, event.pressed, time);
+        }
+        // Let the pending timeouts expire before the next sequence
+        time += 500;
+        g_bench_state.set_timer(time);
+        cycles += bench_cycles() - start;
+    }
+    state.SetItemsProcessed(state.iterations() * events.size());
+    state.counters["cycles_per_event"] = (double)cycles / (double)(state.iterations() * events.size());
+    // Same in both builds, the pipelines produce the same output
+    state.counters["outputs_per_sequence"] = (double)g_bench_state.outputs / (double)state.iterations();
+}
+BENCHMARK(BM_PipelineTyping);
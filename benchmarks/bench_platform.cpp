@@ -0,0 +1,217 @@
+#include "bench_platform.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include "platform_interface.h"
+#include "platform_types.h"
+
+extern "C" {
+#include "monkeyboard_deferred_callbacks.h"
+#include "monkeyboard_keycodes.h"
+#include "pipeline_combo.h"
+#include "pipeline_combo_initializer.h"
+#include "pipeline_executor.h"
+#include "pipeline_key_replacer.h"
+#include "pipeline_key_replacer_initializer.h"
+#include "pipeline_oneshot_modifier.h"
+#include "pipeline_oneshot_modifier_initializer.h"
+#include "pipeline_tap_dance.h"
+#include "pipeline_tap_dance_initializer.h"
+#include "platform_layout.h"
+}
+
+BenchPlatformState g_bench_state;
+
+void BenchPlatformState::reset() {
+    timer = 0;
+    outputs = 0;
+    layer_changes = 0;
+    clear_all_deferred_callbacks();
+}
+
+void BenchPlatformState::set_timer(platform_time_t time) {
+    deferred_callback_entry_t* entry = get_next_deferred_callback(time);
+    while (entry != nullptr && entry->execute_time <= time) {
+        timer = entry->execute_time;
+        execute_callback(entry);
+        entry = get_next_deferred_callback(time);
+    }
+    timer = time;
+}
+
+void bench_init_layout(const std::vector<platform_keycode_t>& keymap, uint8_t num_layers, uint8_t rows, uint8_t cols) {
+    platform_layout_init_2D_keymap(keymap.data(), num_layers, rows, cols);
+}
+
+static std::vector<platform_keycode_t> pipelines_keymap;
+
+static pipeline_combo_global_config_t* create_combo_config(void) {
+    platform_keypos_t left = {BENCH_COMBO_ROW, 10};
+    platform_keypos_t right = {BENCH_COMBO_ROW, 11};
+    pipeline_combo_key_translation_t none = create_combo_key_action(COMBO_KEY_ACTION_NONE, 0);
+    pipeline_combo_key_t** keys = static_cast<pipeline_combo_key_t**>(malloc(2 * sizeof(pipeline_combo_key_t*)));
+    keys[0] = create_combo_key(left, none, none);
+    keys[1] = create_combo_key(right, none, none);
+
+    pipeline_combo_global_config_t* config = static_cast<pipeline_combo_global_config_t*>(malloc(sizeof(*config)));
+    config->length = 1;
+    config->combos = static_cast<pipeline_combo_config_t**>(malloc(sizeof(pipeline_combo_config_t*)));
+    config->combos[0] = create_combo(2, keys,
+        create_combo_key_action(COMBO_KEY_ACTION_REGISTER, 0x29),
+        create_combo_key_action(COMBO_KEY_ACTION_UNREGISTER, 0x29));
+    config->strategy = COMBO_STRATEGY_DISCARD_WHEN_ONE_PRESSED_IN_COMMON;
+    return config;
+}
+
+static pipeline_tap_dance_global_config_t* create_tap_dance_config(void) {
+    pipeline_tap_dance_action_config_t* actions[] = {
+        createbehaviouraction_tap(1, 0x2C),
+        createbehaviouraction_hold(1, 1, TAP_DANCE_HOLD_PREFERRED)
+    };
+    pipeline_tap_dance_global_config_t* config = static_cast<pipeline_tap_dance_global_config_t*>(malloc(sizeof(*config)));
+    config->length = 1;
+    config->behaviours = static_cast<pipeline_tap_dance_behaviour_t**>(malloc(sizeof(pipeline_tap_dance_behaviour_t*)));
+    config->behaviours[0] = createbehaviour(BENCH_TAP_DANCE_KEY, actions, 2);
+    return config;
+}
+
+static pipeline_oneshot_modifier_global_t* create_oneshot_config(void) {
+    pipeline_oneshot_modifier_global_config_t* config = static_cast<pipeline_oneshot_modifier_global_config_t*>(malloc(sizeof(*config)));
+    config->length = 1;
+    config->modifier_pairs = static_cast<pipeline_oneshot_modifier_pair_t**>(malloc(sizeof(pipeline_oneshot_modifier_pair_t*)));
+    config->modifier_pairs[0] = pipeline_oneshot_modifier_create_pairs(BENCH_ONESHOT_KEY, MONKEEB_MOD_LSFT);
+    pipeline_oneshot_modifier_global_t* global = static_cast<pipeline_oneshot_modifier_global_t*>(malloc(sizeof(*global)));
+    global->config = config;
+    global->status = pipeline_oneshot_modifier_global_state_create();
+    return global;
+}
+
+static platform_key_replacer_event_buffer_t* create_key_replacer_buffer(const std::vector<platform_keycode_t>& keycodes) {
+    platform_key_replacer_event_buffer_t* buffer = static_cast<platform_key_replacer_event_buffer_t*>(malloc(sizeof(*buffer)));
+    buffer->buffer_length = keycodes.size();
+    for (size_t i = 0; i < keycodes.size(); i++) {
+        buffer->buffer[i].keycode = keycodes[i];
+        buffer->buffer[i].is_press = true;
+    }
+    return buffer;
+}
+
+static pipeline_key_replacer_global_config_t* create_key_replacer_config(void) {
+    pipeline_key_replacer_global_config_t* config = static_cast<pipeline_key_replacer_global_config_t*>(malloc(sizeof(*config)));
+    config->length = 1;
+    config->modifier_pairs = static_cast<pipeline_key_replacer_pair_t**>(malloc(sizeof(pipeline_key_replacer_pair_t*)));
+    config->modifier_pairs[0] = pipeline_key_replacer_create_pairs(BENCH_REPLACER_KEY,
+        create_key_replacer_buffer({0x0B, 0x0C, 0x0D}), create_key_replacer_buffer({}));
+    return config;
+}
+
+void bench_init_pipelines(void) {
+    const uint8_t rows = 4;
+    const uint8_t cols = 12;
+    pipelines_keymap.assign(2 * rows * cols, 0);
+    for (size_t i = 0; i < rows * cols; i++) {
+        pipelines_keymap[i] = (platform_keycode_t)(0x04 + i % 0x60);
+        pipelines_keymap[rows * cols + i] = PLATFORM_KC_TRANSPARENT;
+    }
+    pipelines_keymap[0] = BENCH_TAP_DANCE_KEY;
+    pipelines_keymap[1] = BENCH_ONESHOT_KEY;
+    pipelines_keymap[2] = BENCH_REPLACER_KEY;
+
+    g_bench_state.reset();
+    pipeline_executor_create_config(2, 2);
+    pipeline_combo_global_state_create();
+    pipeline_tap_dance_global_state_create();
+    pipeline_executor_add_physical_pipeline(0, &pipeline_combo_callback_process_data_executor, &pipeline_combo_callback_reset_executor, create_combo_config());
+    pipeline_executor_add_physical_pipeline(1, &pipeline_tap_dance_callback_process_data_executor, &pipeline_tap_dance_callback_reset_executor, create_tap_dance_config());
+    pipeline_executor_add_virtual_pipeline(0, &pipeline_oneshot_modifier_callback_process_data_executor, &pipeline_oneshot_modifier_callback_reset_executor, create_oneshot_config());
+    pipeline_executor_add_virtual_pipeline(1, &pipeline_key_replacer_callback_process_data_executor, &pipeline_key_replacer_callback_reset_executor, create_key_replacer_config());
+    bench_init_layout(pipelines_keymap, 2, rows, cols);
+}
+
+const std::vector<platform_keycode_t>& bench_pipelines_keymap(void) {
+    return pipelines_keymap;
+}
+
+void bench_process_key(uint8_t row, uint8_t col, bool pressed, platform_time_t time) {
+    g_bench_state.set_timer(time);
+    abskeyevent_t event;
+    event.keypos.row = row;
+    event.keypos.col = col;
+    event.pressed = pressed;
+    event.time = time;
+    pipeline_process_key(event);
+}
+
+extern "C" {
+
+void platform_tap_keycode(platform_keycode_t keycode) {
+    platform_register_keycode(keycode);
+    platform_unregister_keycode(keycode);
+}
+
+void platform_register_keycode(platform_keycode_t keycode) {
+    g_bench_state.outputs++;
+}
+
+void platform_unregister_keycode(platform_keycode_t keycode) {
+    g_bench_state.outputs++;
+}
+
+void platform_add_key(platform_keycode_t keycode) {
+    g_bench_state.outputs++;
+}
+
+void platform_del_key(platform_keycode_t keycode) {
+    g_bench_state.outputs++;
+}
+
+void platform_send_report(void) {
+    g_bench_state.outputs++;
+}
+
+bool platform_compare_keyposition(platform_keypos_t key1, platform_keypos_t key2) {
+    return (key1.row == key2.row && key1.col == key2.col);
+}
+
+void platform_layout_init_2D_keymap(const platform_keycode_t* layers, uint8_t num_layers, uint8_t rows, uint8_t cols) {
+    platform_layout_init_2d_keymap_impl(layers, num_layers, rows, cols);
+}
+
+bool platform_layout_is_valid_layer(uint8_t layer) {
+    return platform_layout_is_valid_layer_impl(layer);
+}
+
+void platform_layout_set_layer(uint8_t layer) {
+    g_bench_state.layer_changes++;
+    platform_layout_set_layer_impl(layer);
+}
+
+uint8_t platform_layout_get_current_layer(void) {
+    return platform_layout_get_current_layer_impl();
+}
+
+platform_keycode_t platform_layout_get_keycode(platform_keypos_t position) {
+    return platform_layout_get_keycode_impl(position);
+}
+
+platform_keycode_t platform_layout_get_keycode_from_layer(uint8_t layer, platform_keypos_t position) {
+    return platform_layout_get_keycode_from_layer_impl(layer, position);
+}
+
+platform_deferred_token platform_defer_exec(uint32_t delay_ms, void (*callback)(void*), void* data) {
+    return schedule_deferred_callback(delay_ms, callback, data);
+}
+
+bool platform_cancel_deferred_exec(platform_deferred_token token) {
+    return cancel_deferred_callback(token);
+}
+
+platform_time_t monkeyboard_get_time_32(void) {
+    return g_bench_state.timer;
+}
+
+uint32_t platform_cycle_count(void) {
+    return (uint32_t)bench_cycles();
+}
+
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+#include <vector>
+#include "platform_types.h"
+
+extern "C" {
+#include "monkeyboard_keycodes.h"
+}
+
+// Silent platform for benchmarks: no output is recorded, only counted
+struct BenchPlatformState {
+    platform_time_t timer = 0;
+    uint32_t outputs = 0;      // Register, unregister, add, del and send report calls
+    uint32_t layer_changes = 0;
+
+    void reset();
+    void set_timer(platform_time_t time); // Executes the deferred callbacks due
+};
+
+extern BenchPlatformState g_bench_state;
+
+// Initializes a 2D layout with the given keymap (layers * rows * cols).
+// The keymap has to outlive the benchmark
+void bench_init_layout(const std::vector<platform_keycode_t>& keymap, uint8_t num_layers, uint8_t rows, uint8_t cols);
+
+// Keys of the 4x12 keymap used by bench_init_pipelines
+#define BENCH_TAP_DANCE_KEY (CUSTOM_KEYCODE_MIN + 1) // (0, 0): tap sends KC_SPC, hold activates layer 1
+#define BENCH_ONESHOT_KEY (CUSTOM_KEYCODE_MIN + 2)   // (0, 1): oneshot left shift
+#define BENCH_REPLACER_KEY (CUSTOM_KEYCODE_MIN + 3)  // (0, 2): replaced by a three key sequence
+#define BENCH_COMBO_ROW 3                            // (3, 10) + (3, 11): combo sending KC_ESC
+
+// Initializes a 4x12 layout with two layers and an executor with the four pipelines, in this order:
+// combo and tap dance (physical), oneshot modifier and key replacer (virtual).
+// It's the same list as benchmarks/static_pipelines/monkeyboard_static_pipelines.h
+void bench_init_pipelines(void);
+
+// Keymap of bench_init_pipelines (2 layers * 4 rows * 12 cols), layer 0 first
+const std::vector<platform_keycode_t>& bench_pipelines_keymap(void);
+
+// Processes a key event at the given time, executing first the deferred callbacks due
+void bench_process_key(uint8_t row, uint8_t col, bool pressed, platform_time_t time);
+
+// CPU cycle counter, or the nanoseconds of the monotonic clock where there's no cycle counter to read
+inline uint64_t bench_cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+#endif
+}
@@ -0,0 +1,77 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <vector>
+#include "bench_platform.hpp"
+#include "platform_types.h"
+
+// End to end cost of pipeline_process_key for the keys handled by each pipeline of bench_init_pipelines.
+// BM_PipelineTyping (bench_pipeline_dispatch.cpp) measures them mixed in a typing sequence
+
+struct BenchKeyStep {
+    uint8_t row;
+    uint8_t col;
+    bool pressed;
+    platform_time_t delta;
+};
+
+static void run_key_steps(benchmark::State& state, const std::vector<BenchKeyStep>& steps) {
+    bench_init_pipelines();
+    platform_time_t time = 0;
+    uint64_t cycles = 0;
+
+    for (auto _ : state) {
+        uint64_t start = bench_cycles();
+        for (const BenchKeyStep& step : steps) {
+            time += step.delta;
+            bench_process_key(step.row, step.col, step.pressed, time);
+        }
+        // Let the pending timeouts expire before the next repetition
+        time += 500;
+        g_bench_state.set_timer(time);
+        cycles += bench_cycles() - start;
+    }
+    state.SetItemsProcessed(state.iterations() * steps.size());
+    state.counters["cycles_per_event"] = (double)cycles / (double)(state.iterations() * steps.size());
+    state.counters["outputs_per_iteration"] = (double)g_bench_state.outputs / (double)state.iterations();
+}
+
+// A key no pipeline acts on
+static void BM_ProcessKeyPlain(benchmark::State& state) {
+    run_key_steps(state, {{1, 5, true, 40}, {1, 5, false, 30}});
+}
+BENCHMARK(BM_ProcessKeyPlain);
+
+static void BM_ProcessKeyTapDanceTap(benchmark::State& state) {
+    run_key_steps(state, {{0, 0, true, 40}, {0, 0, false, 30}});
+}
+BENCHMARK(BM_ProcessKeyTapDanceTap);
+
+// Holds the tap dance key past its timeout, activating layer 1, and types a key on it
+static void BM_ProcessKeyTapDanceHold(benchmark::State& state) {
+    run_key_steps(state, {{0, 0, true, 40}, {1, 5, true, 300}, {1, 5, false, 30}, {0, 0, false, 30}});
+}
+BENCHMARK(BM_ProcessKeyTapDanceHold);
+
+static void BM_ProcessKeyOneshot(benchmark::State& state) {
+    run_key_steps(state, {{0, 1, true, 40}, {0, 1, false, 30}, {1, 5, true, 40}, {1, 5, false, 30}});
+}
+BENCHMARK(BM_ProcessKeyOneshot);
+
+static void BM_ProcessKeyReplacer(benchmark::State& state) {
+    run_key_steps(state, {{0, 2, true, 40}, {0, 2, false, 30}});
+}
+BENCHMARK(BM_ProcessKeyReplacer);
+
+static void BM_ProcessKeyCombo(benchmark::State& state) {
+    run_key_steps(state, {
+        {BENCH_COMBO_ROW, 10, true, 40}, {BENCH_COMBO_ROW, 11, true, 5},
+        {BENCH_COMBO_ROW, 10, false, 80}, {BENCH_COMBO_ROW, 11, false, 5}
+    });
+}
+BENCHMARK(BM_ProcessKeyCombo);
+
+// One combo key pressed alone: the combo waits for its timeout before releasing the key to the next pipelines
+static void BM_ProcessKeyComboTimeout(benchmark::State& state) {
+    run_key_steps(state, {{BENCH_COMBO_ROW, 10, true, 40}, {BENCH_COMBO_ROW, 10, false, 300}});
+}
+BENCHMARK(BM_ProcessKeyComboTimeout);
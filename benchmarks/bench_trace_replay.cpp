@@ -0,0 +1,66 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <cstdio>
+#include <unistd.h>
+#include <vector>
+#include "bench_platform.hpp"
+#include "platform_types.h"
+#include "trace_replayer.hpp"
+
+extern "C" {
+#include "monkeyboard_trace.h"
+}
+
+// Writes a trace of `events` key events typed on the bench_init_pipelines keymap: plain keys, with a tap dance tap,
+// the oneshot key and a combo every 64 taps
+static void write_typing_trace(const char* path, uint32_t events) {
+    FILE* file = fopen(path, "wb");
+    uint8_t buffer[64 * 1024];
+    monkeyboard_trace_recorder_t recorder;
+    monkeyboard_trace_recorder_init(&recorder, buffer, sizeof(buffer), 12, 0,
+        [](const uint8_t* data, size_t size, void* user_data) { fwrite(data, 1, size, static_cast<FILE*>(user_data)); }, file);
+
+    platform_time_t time = 0;
+    auto tap = [&](uint8_t row, uint8_t col) {
+        abskeyevent_t event;
+        event.keypos.row = row;
+        event.keypos.col = col;
+        event.pressed = true;
+        event.time = time += 40;
+        monkeyboard_trace_recorder_record(&recorder, event);
+        event.pressed = false;
+        event.time = time += 30;
+        monkeyboard_trace_recorder_record(&recorder, event);
+    };
+    for (uint32_t i = 0; recorder.recorded_events < events; i++) {
+        switch (i % 64) {
+            case 0: tap(0, 0); break;
+            case 16: tap(0, 1); break;
+            case 32: tap(BENCH_COMBO_ROW, 10); tap(BENCH_COMBO_ROW, 11); break;
+            default: tap(1 + (i / 12) % 2, i % 12); break;
+        }
+    }
+    monkeyboard_trace_recorder_flush(&recorder);
+    fclose(file);
+}
+
+// Replays a memory mapped trace of state.range(0) events through the four pipelines under virtual time
+static void BM_TraceReplay(benchmark::State& state) {
+    char path[] = "/tmp/monkeyboard_bench_trace_XXXXXX";
+    int fd = mkstemp(path);
+    close(fd);
+    write_typing_trace(path, (uint32_t)state.range(0));
+
+    long long events = 0;
+    {
+        MappedTrace trace(path);
+        for (auto _ : state) {
+            bench_init_pipelines();
+            events += replay_trace(trace.data(), trace.size(), [](platform_time_t time) { g_bench_state.set_timer(time); });
+        }
+        state.counters["trace_bytes_per_event"] = (double)(trace.size() - MONKEYBOARD_TRACE_HEADER_SIZE) / (double)state.range(0);
+    }
+    std::remove(path);
+    state.SetItemsProcessed(events);
+}
+BENCHMARK(BM_TraceReplay)->Arg(1 << 20)->Arg(4 << 20)->Unit(benchmark::kMillisecond);
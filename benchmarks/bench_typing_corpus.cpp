@@ -0,0 +1,40 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "bench_platform.hpp"
+#include "platform_types.h"
+#include "typing_corpus_generator.hpp"
+
+// Synthetic text typed at state.range(0) WPM with rollovers through the four pipelines. The space bar is the tap dance
+// key (tap sends space, hold activates layer 1), so the rollovers out of a word stress its tap/hold decision.
+// a, b and c are not on the keymap (the tap dance, oneshot and key replacer keys take their positions) and are skipped
+static void BM_CorpusTyping(benchmark::State& state) {
+    bench_init_pipelines();
+    std::map<char, platform_keypos_t> key_positions = TypingCorpusGenerator::key_positions_from_keymap(bench_pipelines_keymap().data(), 4, 12);
+    key_positions[' '] = {0, 0};
+
+    TypingModel model;
+    model.burst_wpm = (double)state.range(0);
+    model.rollover_probability = 0.3;
+    TypingCorpusGenerator generator(key_positions, model, 1234);
+    std::vector<abskeyevent_t> events = generator.generate(generator.random_text(2000));
+
+    platform_time_t time = 0;
+    uint64_t cycles = 0;
+    for (auto _ : state) {
+        uint64_t start = bench_cycles();
+        for (const abskeyevent_t& event : events) {
+            bench_process_key(event.keypos.row, event.keypos.col, event.pressed, time + event.time);
+        }
+        // Let the pending timeouts expire before the next repetition
+        time += events.back().time + 1000;
+        g_bench_state.set_timer(time);
+        cycles += bench_cycles() - start;
+    }
+    state.SetItemsProcessed(state.iterations() * events.size());
+    state.counters["cycles_per_event"] = (double)cycles / (double)(state.iterations() * events.size());
+    state.counters["outputs_per_event"] = (double)g_bench_state.outputs / (double)(state.iterations() * events.size());
+}
+BENCHMARK(BM_CorpusTyping)->Arg(60)->Arg(120)->Arg(200);
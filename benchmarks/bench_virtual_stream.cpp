@@ -0,0 +1,59 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <vector>
+#include "bench_platform.hpp"
+#include "platform_types.h"
+
+extern "C" {
+#include "pipeline_executor.h"
+#include "pipeline_oneshot_modifier.h"
+#include "pipeline_oneshot_modifier_initializer.h"
+}
+
+// A physical pipeline sending a macro of state.range(0) taps when (0, 0) is pressed. Macros longer than the virtual
+// buffer are streamed through the virtual stage, the oneshot pipeline is there so the virtual events are dispatched
+static uint8_t macro_length = 0;
+
+static void macro_callback(pipeline_physical_callback_params_t* params, const pipeline_physical_actions_t* actions, const pipeline_physical_return_actions_t* return_actions, void* user_data) {
+    platform_key_event_t* event = params->key_event;
+    if (params->callback_type == PIPELINE_CALLBACK_KEY_EVENT && event->keypos.row == 0 && event->keypos.col == 0) {
+        if (event->is_press) {
+            for (uint8_t i = 0; i < macro_length; i++) {
+                actions->tap_key_fn(0x04 + i % 26);
+            }
+            actions->remove_physical_press_fn(event->press_id);
+        } else {
+            actions->remove_physical_release_fn(event->press_id);
+        }
+    }
+    return_actions->no_capture_fn();
+}
+
+static void macro_reset(void* user_data) {
+    (void)user_data;
+}
+
+static void BM_VirtualMacroStream(benchmark::State& state) {
+    static std::vector<platform_keycode_t> keymap(4 * 12, 0x04);
+    macro_length = (uint8_t)state.range(0);
+
+    g_bench_state.reset();
+    pipeline_executor_create_config(1, 1);
+    pipeline_executor_add_physical_pipeline(0, &macro_callback, &macro_reset, nullptr);
+    pipeline_oneshot_modifier_global_t oneshot;
+    pipeline_oneshot_modifier_global_config_t oneshot_config = { 0, nullptr };
+    oneshot.config = &oneshot_config;
+    oneshot.status = pipeline_oneshot_modifier_global_state_create();
+    pipeline_executor_add_virtual_pipeline(0, &pipeline_oneshot_modifier_callback_process_data_executor, &pipeline_oneshot_modifier_callback_reset_executor, &oneshot);
+    bench_init_layout(keymap, 1, 4, 12);
+
+    platform_time_t time = 0;
+    for (auto _ : state) {
+        bench_process_key(0, 0, true, time += 20);
+        bench_process_key(0, 0, false, time += 20);
+    }
+    state.SetItemsProcessed(state.iterations() * macro_length * 2);
+    // Every virtual event reaches the platform: two outputs per tap
+    state.counters["outputs_per_macro"] = (double)g_bench_state.outputs / (double)state.iterations();
+}
+BENCHMARK(BM_VirtualMacroStream)->Arg(8)->Arg(32)->Arg(128);
@@ -0,0 +1,15 @@
+// Static pipeline list of the benchmarks (see pipeline_executor.h). Same pipelines as bench_init_pipelines
+#pragma once
+
+#include "pipeline_combo.h"
+#include "pipeline_tap_dance.h"
+#include "pipeline_oneshot_modifier.h"
+#include "pipeline_key_replacer.h"
+
+#define MONKEYBOARD_STATIC_PHYSICAL_PIPELINES(PIPELINE) \
+    PIPELINE(pipeline_combo_callback_process_data_executor, pipeline_combo_callback_reset_executor) \
+    PIPELINE(pipeline_tap_dance_callback_process_data_executor, pipeline_tap_dance_callback_reset_executor)
+
+#define MONKEYBOARD_STATIC_VIRTUAL_PIPELINES(PIPELINE) \
+    PIPELINE(pipeline_oneshot_modifier_callback_process_data_executor, pipeline_oneshot_modifier_callback_reset_executor) \
+    PIPELINE(pipeline_key_replacer_callback_process_data_executor, pipeline_key_replacer_callback_reset_executor)
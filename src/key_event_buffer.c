@@ -1,12 +1,16 @@
 #include "monkeyboard_debug.h"
 #include "key_event_buffer.h"
 #include "key_press_buffer.h"
+#include "platform_interface.h"
 #include "platform_types.h"
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include "monkeyboard_memory.h"
 #include <string.h>
 
+_Static_assert(sizeof(platform_key_event_t) == 12, "platform_key_event_t must not have padding");
+
 // This function is used to get a unique keypress ID for each key event
 // It ensures that the ID is always between 1 and 255, wrapping around if necessary
 // This is useful for identifying key events in the buffer
@@ -58,15 +62,46 @@ static uint8_t get_keypress_id(platform_key_event_buffer_t* event_buffer, platfo
 }
 
 platform_key_event_buffer_t* platform_key_event_create(void) {
-    platform_key_event_buffer_t* key_buffer = (platform_key_event_buffer_t*)malloc(sizeof(platform_key_event_buffer_t));
+    return platform_key_event_create_with_capacity(PLATFORM_KEY_EVENT_MAX_ELEMENTS, PLATFORM_KEY_BUFFER_MAX_ELEMENTS, false);
+}
+
+// The events are allocated together with the buffer
+platform_key_event_buffer_t* platform_key_event_create_with_capacity(uint8_t event_capacity, uint8_t press_capacity, bool growable) {
+    platform_key_event_buffer_t* key_buffer = (platform_key_event_buffer_t*)monkeyboard_malloc(sizeof(platform_key_event_buffer_t) + sizeof(platform_key_event_t) * event_capacity);
     if (key_buffer == NULL) {
         return NULL;
     }
+    key_buffer->event_buffer = (platform_key_event_t*)(key_buffer + 1);
     key_buffer->event_buffer_pos = 0;
-    key_buffer->key_press_buffer = platform_key_press_create();
+    key_buffer->capacity = event_capacity;
+    key_buffer->growable = growable;
+    key_buffer->key_press_buffer = platform_key_press_create_with_capacity(press_capacity, growable);
     return key_buffer;
 }
 
+// Makes room for one more event, growing the buffer if it is full and growable
+static bool has_room(platform_key_event_buffer_t* event_buffer) {
+    if (event_buffer->event_buffer_pos < event_buffer->capacity) {
+        return true;
+    }
+#if defined(MONKEYBOARD_GROWABLE_BUFFERS)
+    uint8_t capacity = monkeyboard_memory_grown_capacity(event_buffer->capacity);
+    if (!event_buffer->growable || capacity == event_buffer->capacity) {
+        return false;
+    }
+    bool release = event_buffer->event_buffer != (platform_key_event_t*)(event_buffer + 1);
+    platform_key_event_t* events = monkeyboard_memory_grow(event_buffer->event_buffer, sizeof(platform_key_event_t) * event_buffer->event_buffer_pos, sizeof(platform_key_event_t) * capacity, release);
+    if (events == NULL) {
+        return false;
+    }
+    event_buffer->event_buffer = events;
+    event_buffer->capacity = capacity;
+    return true;
+#else
+    return false;
+#endif
+}
+
 void platform_key_event_reset(platform_key_event_buffer_t* event_buffer) {
     if (event_buffer == NULL) {
         return;
@@ -83,7 +118,7 @@ void platform_key_event_remove_event_keys(platform_key_event_buffer_t* event_buf
 }
 
 static bool platform_key_event_add_event_internal(platform_key_event_buffer_t *event_buffer, platform_time_t time, platform_keypos_t keypos, platform_keycode_t keycode, bool is_press, uint8_t press_id, bool* buffer_full) {
-    if (event_buffer->event_buffer_pos >= PLATFORM_KEY_EVENT_MAX_ELEMENTS) {
+    if (!has_room(event_buffer)) {
         *buffer_full = true;
         return false; // Buffer is full
     }
@@ -149,7 +184,7 @@ bool platform_key_event_add_physical_release(platform_key_event_buffer_t *event_
         #elif defined(AGNOSTIC_USE_2D_ARRAY)
             DEBUG_PRINT_ERROR("Failed to add release event for keypos: %d, %d", keypos.row, keypos.col);
         #endif
-        platform_key_press_remove_press(event_buffer->key_press_buffer, key_press->keypos);
+        // The press is kept, so the release can be added again once the event buffer has room
         return false;
     } else {
         platform_key_press_remove_press(event_buffer->key_press_buffer, key_press->keypos);
@@ -180,7 +215,7 @@ static bool try_get_release_position_by_press_id(platform_key_event_buffer_t *ev
 
 void internal_platform_key_event_remove_event(platform_key_event_buffer_t *event_buffer, uint8_t position) {
     if (position < event_buffer->event_buffer_pos - 1) {
-        memcpy(&event_buffer->event_buffer[position], &event_buffer->event_buffer[position + 1], sizeof(platform_key_event_t) * (event_buffer->event_buffer_pos - 1 - position));
+        memmove(&event_buffer->event_buffer[position], &event_buffer->event_buffer[position + 1], sizeof(platform_key_event_t) * (event_buffer->event_buffer_pos - 1 - position));
     }
     event_buffer->event_buffer_pos--;
 }
@@ -229,6 +264,37 @@ void platform_key_event_change_keycode(platform_key_event_buffer_t *event_buffer
     }
 }
 
+// The presses found on the first event_count events are resolved again from the layer, along with their releases
+// anywhere on the buffer and their entry on the press buffer. A release whose press was already processed keeps its
+// keycode, so it still matches the keycode that was sent for the press.
+void platform_key_event_change_keycodes_from_layer(platform_key_event_buffer_t *event_buffer, uint8_t event_count, uint8_t layer) {
+    uint32_t resolved_press_ids[8] = {0}; // One bit per press id
+    bool any_resolved = false;
+    for (uint8_t i = 0; i < event_buffer->event_buffer_pos; i++) {
+        platform_key_event_t* event = &event_buffer->event_buffer[i];
+        uint32_t press_id_bit = 1UL << (event->press_id % 32);
+        if (event->is_press) {
+            if (i < event_count) {
+                event->keycode = platform_layout_get_keycode_from_layer(layer, event->keypos);
+                resolved_press_ids[event->press_id / 32] |= press_id_bit;
+                any_resolved = true;
+            }
+        } else if (resolved_press_ids[event->press_id / 32] & press_id_bit) {
+            event->keycode = platform_layout_get_keycode_from_layer(layer, event->keypos);
+        }
+    }
+    if (!any_resolved) {
+        return;
+    }
+    platform_key_press_buffer_t* press_buffer = event_buffer->key_press_buffer;
+    for (uint8_t i = 0; i < press_buffer->press_buffer_pos; i++) {
+        platform_key_press_key_press_t* key_press = &press_buffer->press_buffer[i];
+        if (resolved_press_ids[key_press->press_id / 32] & (1UL << (key_press->press_id % 32))) {
+            key_press->keycode = platform_layout_get_keycode_from_layer(layer, key_press->keypos);
+        }
+    }
+}
+
 // void platform_key_event_update_layer_for_physical_events(platform_key_event_buffer_t *event_buffer, uint8_t layer, uint8_t pos) {
 //     if (event_buffer == NULL) {
 //         return;
@@ -28,29 +28,37 @@
 extern "C" {
 #endif
 
+// Default capacity, used by platform_key_event_create
+#ifndef PLATFORM_KEY_EVENT_MAX_ELEMENTS
 #define PLATFORM_KEY_EVENT_MAX_ELEMENTS 20
+#endif
 
 typedef struct {
     uint8_t position;
     bool found;
 } platform_key_event_position_t;
 
+// The 32-bit members go first and the small ones are packed at the end, so an event has no padding
+// (12 bytes instead of 20). Events are moved on every compaction of the buffer.
 typedef struct {
-    platform_keypos_t keypos;
     platform_keycode_t keycode;
-    bool is_press;
     platform_time_t time;
+    platform_keypos_t keypos;
     uint8_t press_id; // Unique ID for the key event, used to track presses/releases
+    bool is_press;
 } platform_key_event_t;
 
 typedef struct {
-    platform_key_event_t event_buffer[PLATFORM_KEY_EVENT_MAX_ELEMENTS];
+    platform_key_event_t* event_buffer; // Allocated after the buffer, or on its own allocation once grown
     uint8_t event_buffer_pos;
+    uint8_t capacity;
+    bool growable; // Doubles the capacity when full (see monkeyboard_memory.h)
     platform_key_press_buffer_t* key_press_buffer; // Buffer for physical key presses
 } platform_key_event_buffer_t;
 
 // Key buffer functions
 platform_key_event_buffer_t* platform_key_event_create(void);
+platform_key_event_buffer_t* platform_key_event_create_with_capacity(uint8_t event_capacity, uint8_t press_capacity, bool growable);
 void platform_key_event_reset(platform_key_event_buffer_t* event_buffer);
 
 void platform_key_event_remove_event_keys(platform_key_event_buffer_t* event_buffer);
@@ -60,6 +68,9 @@ void internal_platform_key_event_remove_event(platform_key_event_buffer_t *event
 platform_key_event_position_t platform_key_event_remove_physical_press_by_press_id(platform_key_event_buffer_t *event_buffer, uint8_t press_id);
 platform_key_event_position_t platform_key_event_remove_physical_release_by_press_id(platform_key_event_buffer_t *event_buffer, uint8_t press_id);
 void platform_key_event_change_keycode(platform_key_event_buffer_t *event_buffer, uint8_t press_id, platform_keycode_t keycode);
+// Same as calling platform_key_event_change_keycode with the keycode of the layer for each of the first event_count
+// events, in one pass over the event buffer and one over the press buffer
+void platform_key_event_change_keycodes_from_layer(platform_key_event_buffer_t *event_buffer, uint8_t event_count, uint8_t layer);
 
 // void platform_key_event_update_layer_for_physical_events(platform_key_event_buffer_t *event_buffer, uint8_t layer, uint8_t pos);
 
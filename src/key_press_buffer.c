@@ -5,17 +5,49 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include "monkeyboard_memory.h"
 #include <string.h>
 
 platform_key_press_buffer_t* platform_key_press_create(void){
-    platform_key_press_buffer_t* key_buffer = (platform_key_press_buffer_t*)malloc(sizeof(platform_key_press_buffer_t));
+    return platform_key_press_create_with_capacity(PLATFORM_KEY_BUFFER_MAX_ELEMENTS, false);
+}
+
+// The presses are allocated together with the buffer
+platform_key_press_buffer_t* platform_key_press_create_with_capacity(uint8_t capacity, bool growable) {
+    platform_key_press_buffer_t* key_buffer = (platform_key_press_buffer_t*)monkeyboard_malloc(sizeof(platform_key_press_buffer_t) + sizeof(platform_key_press_key_press_t) * capacity);
     if (key_buffer == NULL) {
         return NULL;
     }
+    key_buffer->press_buffer = (platform_key_press_key_press_t*)(key_buffer + 1);
     key_buffer->press_buffer_pos = 0;
+    key_buffer->capacity = capacity;
+    key_buffer->growable = growable;
     return key_buffer;
 }
 
+// Makes room for one more press, growing the buffer if it is full and growable
+static bool has_room(platform_key_press_buffer_t* key_buffer) {
+    if (key_buffer->press_buffer_pos < key_buffer->capacity) {
+        return true;
+    }
+#if defined(MONKEYBOARD_GROWABLE_BUFFERS)
+    uint8_t capacity = monkeyboard_memory_grown_capacity(key_buffer->capacity);
+    if (!key_buffer->growable || capacity == key_buffer->capacity) {
+        return false;
+    }
+    bool release = key_buffer->press_buffer != (platform_key_press_key_press_t*)(key_buffer + 1);
+    platform_key_press_key_press_t* press_buffer = monkeyboard_memory_grow(key_buffer->press_buffer, sizeof(platform_key_press_key_press_t) * key_buffer->press_buffer_pos, sizeof(platform_key_press_key_press_t) * capacity, release);
+    if (press_buffer == NULL) {
+        return false;
+    }
+    key_buffer->press_buffer = press_buffer;
+    key_buffer->capacity = capacity;
+    return true;
+#else
+    return false;
+#endif
+}
+
 void platform_key_press_reset(platform_key_press_buffer_t* key_buffer) {
     if (key_buffer == NULL) {
         return;
@@ -41,7 +73,8 @@ platform_key_press_key_press_t* platform_key_press_add_press(platform_key_press_
         }
     }
 
-    if (key_buffer->press_buffer_pos < PLATFORM_KEY_BUFFER_MAX_ELEMENTS) {
+    if (has_room(key_buffer)) {
+        only_press_buffer = key_buffer->press_buffer;
         only_press_buffer[key_buffer->press_buffer_pos].keypos = keypos;
         only_press_buffer[key_buffer->press_buffer_pos].press_id = press_id;
         only_press_buffer[key_buffer->press_buffer_pos].keycode = keycode;
@@ -80,9 +113,9 @@ bool platform_key_press_remove_press(platform_key_press_buffer_t *key_buffer, pl
         if (pos < key_buffer->press_buffer_pos) {
             size_t num_elements_to_shift = key_buffer->press_buffer_pos - pos - 1;
             if (num_elements_to_shift > 0) {
-                memcpy(&only_press_buffer[pos], &only_press_buffer[pos + 1], sizeof(platform_key_press_key_press_t) * num_elements_to_shift);
+                memmove(&only_press_buffer[pos], &only_press_buffer[pos + 1], sizeof(platform_key_press_key_press_t) * num_elements_to_shift);
             }
-            // No memcpy needed if pos is the last element; just decrement the count.
+            // No memmove needed if pos is the last element; just decrement the count.
             key_buffer->press_buffer_pos--;
             return true;
         }
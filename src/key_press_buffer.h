@@ -27,7 +27,10 @@
 extern "C" {
 #endif
 
+// Default capacity, used by platform_key_press_create
+#ifndef PLATFORM_KEY_BUFFER_MAX_ELEMENTS
 #define PLATFORM_KEY_BUFFER_MAX_ELEMENTS 10
+#endif
 
 typedef struct {
     platform_keypos_t keypos;
@@ -37,12 +40,15 @@ typedef struct {
 } platform_key_press_key_press_t;
 
 typedef struct {
-    platform_key_press_key_press_t press_buffer[PLATFORM_KEY_BUFFER_MAX_ELEMENTS];
+    platform_key_press_key_press_t* press_buffer; // Allocated after the buffer, or on its own allocation once grown
     uint8_t press_buffer_pos;
+    uint8_t capacity;
+    bool growable; // Doubles the capacity when full (see monkeyboard_memory.h)
 } platform_key_press_buffer_t;
 
 // Key buffer safe functions
 platform_key_press_buffer_t* platform_key_press_create(void);
+platform_key_press_buffer_t* platform_key_press_create_with_capacity(uint8_t capacity, bool growable);
 void platform_key_press_reset(platform_key_press_buffer_t* press_buffer);
 
 platform_key_press_key_press_t* platform_key_press_add_press(platform_key_press_buffer_t *press_buffer, platform_keypos_t keypos, platform_keycode_t keycode, uint8_t press_id);
@@ -3,17 +3,49 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include "monkeyboard_memory.h"
 #include <string.h>
 
 platform_virtual_event_buffer_t* platform_virtual_event_create(void){
-    platform_virtual_event_buffer_t* virtual_buffer = (platform_virtual_event_buffer_t*)malloc(sizeof(platform_virtual_event_buffer_t));
+    return platform_virtual_event_create_with_capacity(PLATFORM_KEY_VIRTUAL_BUFFER_MAX_ELEMENTS, false);
+}
+
+// The events are allocated together with the buffer
+platform_virtual_event_buffer_t* platform_virtual_event_create_with_capacity(uint8_t capacity, bool growable) {
+    platform_virtual_event_buffer_t* virtual_buffer = (platform_virtual_event_buffer_t*)monkeyboard_malloc(sizeof(platform_virtual_event_buffer_t) + sizeof(platform_virtual_buffer_virtual_event_t) * capacity);
     if (virtual_buffer == NULL) {
         return NULL;
     }
+    virtual_buffer->press_buffer = (platform_virtual_buffer_virtual_event_t*)(virtual_buffer + 1);
     virtual_buffer->press_buffer_pos = 0;
+    virtual_buffer->capacity = capacity;
+    virtual_buffer->growable = growable;
     return virtual_buffer;
 }
 
+// Makes room for one more event, growing the buffer if it is full and growable
+static bool has_room(platform_virtual_event_buffer_t* virtual_buffer) {
+    if (virtual_buffer->press_buffer_pos < virtual_buffer->capacity) {
+        return true;
+    }
+#if defined(MONKEYBOARD_GROWABLE_BUFFERS)
+    uint8_t capacity = monkeyboard_memory_grown_capacity(virtual_buffer->capacity);
+    if (!virtual_buffer->growable || capacity == virtual_buffer->capacity) {
+        return false;
+    }
+    bool release = virtual_buffer->press_buffer != (platform_virtual_buffer_virtual_event_t*)(virtual_buffer + 1);
+    platform_virtual_buffer_virtual_event_t* press_buffer = monkeyboard_memory_grow(virtual_buffer->press_buffer, sizeof(platform_virtual_buffer_virtual_event_t) * virtual_buffer->press_buffer_pos, sizeof(platform_virtual_buffer_virtual_event_t) * capacity, release);
+    if (press_buffer == NULL) {
+        return false;
+    }
+    virtual_buffer->press_buffer = press_buffer;
+    virtual_buffer->capacity = capacity;
+    return true;
+#else
+    return false;
+#endif
+}
+
 void platform_virtual_event_reset(platform_virtual_event_buffer_t* virtual_buffer) {
     if (virtual_buffer == NULL) {
         return;
@@ -26,11 +58,13 @@ bool platform_virtual_event_add_press(platform_virtual_event_buffer_t *virtual_b
     if (virtual_buffer == NULL) {
         return false;
     }
-    platform_virtual_buffer_virtual_event_t* only_press_buffer = virtual_buffer->press_buffer;
-
-    if (virtual_buffer->press_buffer_pos < PLATFORM_KEY_VIRTUAL_BUFFER_MAX_ELEMENTS) {
+    if (has_room(virtual_buffer)) {
+        platform_virtual_buffer_virtual_event_t* only_press_buffer = virtual_buffer->press_buffer;
         only_press_buffer[virtual_buffer->press_buffer_pos].keycode = keycode;
         only_press_buffer[virtual_buffer->press_buffer_pos].is_press = true;
+#if defined(MONKEYBOARD_EVENT_ORIGIN)
+        only_press_buffer[virtual_buffer->press_buffer_pos].origin.press_id = 0; // Set by the executor
+#endif
         ++virtual_buffer->press_buffer_pos;
         return true;
     }
@@ -42,11 +76,13 @@ bool platform_virtual_event_add_release(platform_virtual_event_buffer_t *virtual
     if (virtual_buffer == NULL) {
         return false;
     }
-    platform_virtual_buffer_virtual_event_t* only_press_buffer = virtual_buffer->press_buffer;
-
-    if (virtual_buffer->press_buffer_pos < PLATFORM_KEY_VIRTUAL_BUFFER_MAX_ELEMENTS) {
+    if (has_room(virtual_buffer)) {
+        platform_virtual_buffer_virtual_event_t* only_press_buffer = virtual_buffer->press_buffer;
         only_press_buffer[virtual_buffer->press_buffer_pos].keycode = keycode;
         only_press_buffer[virtual_buffer->press_buffer_pos].is_press = false;
+#if defined(MONKEYBOARD_EVENT_ORIGIN)
+        only_press_buffer[virtual_buffer->press_buffer_pos].origin.press_id = 0; // Set by the executor
+#endif
         ++virtual_buffer->press_buffer_pos;
         return true;
     }
@@ -9,20 +9,29 @@
 extern "C" {
 #endif
 
+// Default capacity, used by platform_virtual_event_create
+#ifndef PLATFORM_KEY_VIRTUAL_BUFFER_MAX_ELEMENTS
 #define PLATFORM_KEY_VIRTUAL_BUFFER_MAX_ELEMENTS 10
+#endif
 
 typedef struct {
     platform_keycode_t keycode;
     bool is_press;
+#if defined(MONKEYBOARD_EVENT_ORIGIN)
+    platform_event_origin_t origin;
+#endif
 } platform_virtual_buffer_virtual_event_t;
 
 typedef struct {
-    platform_virtual_buffer_virtual_event_t press_buffer[PLATFORM_KEY_VIRTUAL_BUFFER_MAX_ELEMENTS];
+    platform_virtual_buffer_virtual_event_t* press_buffer; // Allocated after the buffer, or on its own allocation once grown
     uint8_t press_buffer_pos;
+    uint8_t capacity;
+    bool growable; // Doubles the capacity when full (see monkeyboard_memory.h)
 } platform_virtual_event_buffer_t;
 
 // Key buffer safe functions
 platform_virtual_event_buffer_t* platform_virtual_event_create(void);
+platform_virtual_event_buffer_t* platform_virtual_event_create_with_capacity(uint8_t capacity, bool growable);
 void platform_virtual_event_reset(platform_virtual_event_buffer_t* virtual_buffer);
 
 bool platform_virtual_event_add_press(platform_virtual_event_buffer_t *virtual_buffer, platform_keycode_t keycode);
@@ -0,0 +1,379 @@
+#include "monkeyboard_config_blob.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "key_virtual_buffer.h"
+#include "platform_interface.h"
+#include "platform_types.h"
+
+_Static_assert(sizeof(monkeyboard_config_blob_header_t) == 16, "Unexpected blob header size");
+_Static_assert(sizeof(monkeyboard_config_blob_section_t) == 12, "Unexpected blob section size");
+_Static_assert(sizeof(monkeyboard_config_blob_keymap_t) == 8, "Unexpected blob keymap size");
+_Static_assert(sizeof(monkeyboard_config_blob_combo_t) == 12, "Unexpected blob combo size");
+_Static_assert(sizeof(monkeyboard_config_blob_combo_key_t) == 12, "Unexpected blob combo key size");
+_Static_assert(sizeof(monkeyboard_config_blob_tap_dance_t) == 12, "Unexpected blob tap dance size");
+_Static_assert(sizeof(monkeyboard_config_blob_tap_dance_action_t) == 8, "Unexpected blob tap dance action size");
+_Static_assert(sizeof(monkeyboard_config_blob_oneshot_t) == 8, "Unexpected blob oneshot size");
+_Static_assert(sizeof(monkeyboard_config_blob_key_replacer_t) == 8, "Unexpected blob key replacer size");
+_Static_assert(sizeof(monkeyboard_config_blob_key_replacer_event_t) == 8, "Unexpected blob key replacer event size");
+
+#define RAM_ALIGNMENT sizeof(void*)
+
+// Bounds checked reader over the records of a section
+typedef struct {
+    const uint8_t* position;
+    const uint8_t* end;
+} section_reader_t;
+
+// Bump allocator over the RAM buffer. When not building it only counts the bytes needed
+typedef struct {
+    uint8_t* base;
+    size_t used;
+    size_t capacity;
+    bool build;
+} ram_arena_t;
+
+static const void* read_record(section_reader_t* reader, size_t size) {
+    if ((size_t)(reader->end - reader->position) < size) {
+        return NULL;
+    }
+    const void* record = reader->position;
+    reader->position += size;
+    return record;
+}
+
+static void* arena_alloc(ram_arena_t* arena, size_t size) {
+    size_t offset = (arena->used + RAM_ALIGNMENT - 1) & ~(RAM_ALIGNMENT - 1);
+    arena->used = offset + size;
+    if (!arena->build || arena->used > arena->capacity) {
+        return NULL;
+    }
+    return arena->base + offset;
+}
+
+static platform_keypos_t keypos_from_blob(uint16_t keypos) {
+#if defined(AGNOSTIC_USE_1D_ARRAY)
+    return keypos;
+#elif defined(AGNOSTIC_USE_2D_ARRAY)
+    platform_keypos_t position;
+    position.row = (uint8_t)(keypos >> 8);
+    position.col = (uint8_t)(keypos & 0xFF);
+    return position;
+#endif
+}
+
+static const monkeyboard_config_blob_section_t* section_table(const void* blob) {
+    return (const monkeyboard_config_blob_section_t*)((const uint8_t*)blob + sizeof(monkeyboard_config_blob_header_t));
+}
+
+monkeyboard_config_blob_status_t monkeyboard_config_blob_validate(const void* blob, size_t size) {
+    if (blob == NULL || size < sizeof(monkeyboard_config_blob_header_t)) {
+        return MONKEYBOARD_CONFIG_BLOB_TRUNCATED;
+    }
+    const monkeyboard_config_blob_header_t* header = (const monkeyboard_config_blob_header_t*)blob;
+    if (header->magic != MONKEYBOARD_CONFIG_BLOB_MAGIC) {
+        return MONKEYBOARD_CONFIG_BLOB_BAD_MAGIC;
+    }
+    if (header->version != MONKEYBOARD_CONFIG_BLOB_VERSION) {
+        return MONKEYBOARD_CONFIG_BLOB_BAD_VERSION;
+    }
+    size_t table_end = sizeof(monkeyboard_config_blob_header_t) + (size_t)header->section_count * sizeof(monkeyboard_config_blob_section_t);
+    if (header->total_size > size || table_end > header->total_size) {
+        return MONKEYBOARD_CONFIG_BLOB_TRUNCATED;
+    }
+    const monkeyboard_config_blob_section_t* sections = section_table(blob);
+    for (uint16_t i = 0; i < header->section_count; i++) {
+        if (sections[i].offset % MONKEYBOARD_CONFIG_BLOB_ALIGNMENT != 0 || sections[i].offset < table_end ||
+            sections[i].offset > header->total_size || sections[i].size > header->total_size - sections[i].offset) {
+            return MONKEYBOARD_CONFIG_BLOB_BAD_SECTION;
+        }
+    }
+    return MONKEYBOARD_CONFIG_BLOB_OK;
+}
+
+const void* monkeyboard_config_blob_get_section(const void* blob, monkeyboard_config_section_type_t type, uint16_t* count, uint32_t* size) {
+    const monkeyboard_config_blob_header_t* header = (const monkeyboard_config_blob_header_t*)blob;
+    const monkeyboard_config_blob_section_t* sections = section_table(blob);
+    for (uint16_t i = 0; i < header->section_count; i++) {
+        if (sections[i].type == type) {
+            if (count) *count = sections[i].count;
+            if (size) *size = sections[i].size;
+            return (const uint8_t*)blob + sections[i].offset;
+        }
+    }
+    return NULL;
+}
+
+static monkeyboard_config_blob_status_t load_keymap(const void* section, uint16_t count, uint32_t size, ram_arena_t* arena) {
+    section_reader_t reader = { (const uint8_t*)section, (const uint8_t*)section + size };
+    const monkeyboard_config_blob_keymap_t* keymap = read_record(&reader, sizeof(monkeyboard_config_blob_keymap_t));
+    if (keymap == NULL || keymap->num_layers == 0 || keymap->num_layers != count) {
+        return MONKEYBOARD_CONFIG_BLOB_BAD_SECTION;
+    }
+    const platform_keycode_t* extended_keycodes = read_record(&reader, keymap->extended_count * sizeof(uint32_t));
+    size_t layer_keys = (size_t)keymap->rows * keymap->cols;
+    const platform_compact_keycode_t* keys = read_record(&reader, keymap->num_layers * layer_keys * sizeof(platform_compact_keycode_t));
+    if (extended_keycodes == NULL || keys == NULL) {
+        return MONKEYBOARD_CONFIG_BLOB_BAD_SECTION;
+    }
+#if defined(AGNOSTIC_USE_1D_ARRAY)
+    const platform_compact_keycode_t** layers = arena_alloc(arena, keymap->num_layers * sizeof(platform_compact_keycode_t*));
+    if (layers) {
+        for (uint8_t i = 0; i < keymap->num_layers; i++) {
+            layers[i] = keys + i * layer_keys;
+        }
+        platform_layout_init_compact_1D_keymap(layers, keymap->num_layers, (uint16_t)layer_keys, extended_keycodes, keymap->extended_count);
+    }
+#elif defined(AGNOSTIC_USE_2D_ARRAY)
+    if (keymap->cols > UINT8_MAX) {
+        return MONKEYBOARD_CONFIG_BLOB_BAD_SECTION;
+    }
+    if (arena->build) {
+        platform_layout_init_compact_2D_keymap(keys, keymap->num_layers, keymap->rows, (uint8_t)keymap->cols, extended_keycodes, keymap->extended_count);
+    }
+#endif
+    return MONKEYBOARD_CONFIG_BLOB_OK;
+}
+
+static monkeyboard_config_blob_status_t load_combos(const void* section, uint16_t count, uint32_t size, ram_arena_t* arena, pipeline_combo_global_config_t** result) {
+    section_reader_t reader = { (const uint8_t*)section, (const uint8_t*)section + size };
+    const uint32_t* strategy = read_record(&reader, sizeof(uint32_t));
+    if (strategy == NULL || *strategy > COMBO_STRATEGY_DISCARD_WHEN_ALL_PRESSED_IN_COMMON) {
+        return MONKEYBOARD_CONFIG_BLOB_BAD_SECTION;
+    }
+    pipeline_combo_global_config_t* global = arena_alloc(arena, sizeof(pipeline_combo_global_config_t));
+    pipeline_combo_config_t** combos = arena_alloc(arena, count * sizeof(pipeline_combo_config_t*));
+    for (uint16_t i = 0; i < count; i++) {
+        const monkeyboard_config_blob_combo_t* record = read_record(&reader, sizeof(monkeyboard_config_blob_combo_t));
+        if (record == NULL || record->press_action > COMBO_KEY_ACTION_UNREGISTER || record->release_action > COMBO_KEY_ACTION_UNREGISTER) {
+            return MONKEYBOARD_CONFIG_BLOB_BAD_SECTION;
+        }
+        pipeline_combo_config_t* combo = arena_alloc(arena, sizeof(pipeline_combo_config_t));
+        pipeline_combo_key_t** keys = arena_alloc(arena, record->key_count * sizeof(pipeline_combo_key_t*));
+        for (uint8_t j = 0; j < record->key_count; j++) {
+            const monkeyboard_config_blob_combo_key_t* key_record = read_record(&reader, sizeof(monkeyboard_config_blob_combo_key_t));
+            if (key_record == NULL || key_record->press_action > COMBO_KEY_ACTION_UNREGISTER || key_record->release_action > COMBO_KEY_ACTION_UNREGISTER) {
+                return MONKEYBOARD_CONFIG_BLOB_BAD_SECTION;
+            }
+            pipeline_combo_key_t* key = arena_alloc(arena, sizeof(pipeline_combo_key_t));
+            if (key) {
+                key->keypos = keypos_from_blob(key_record->keypos);
+                key->key_on_press.action = (pipeline_combo_key_action_t)key_record->press_action;
+                key->key_on_press.key = key_record->press_keycode;
+                key->key_on_release.action = (pipeline_combo_key_action_t)key_record->release_action;
+                key->key_on_release.key = key_record->release_keycode;
+                key->press_id = 0;
+                key->is_pressed = false;
+                keys[j] = key;
+            }
+        }
+        if (combo) {
+            combo->keys_length = record->key_count;
+            combo->keys = keys;
+            combo->key_on_press_combo.action = (pipeline_combo_key_action_t)record->press_action;
+            combo->key_on_press_combo.key = record->press_keycode;
+            combo->key_on_release_combo.action = (pipeline_combo_key_action_t)record->release_action;
+            combo->key_on_release_combo.key = record->release_keycode;
+            combo->combo_status = COMBO_IDLE;
+            combo->first_key_event = false;
+            combo->time_from_first_key_event = 0;
+            combos[i] = combo;
+        }
+    }
+    if (global) {
+        global->length = count;
+        global->combos = combos;
+        global->strategy = (combo_activate_strategy_t)*strategy;
+    }
+    *result = global;
+    return MONKEYBOARD_CONFIG_BLOB_OK;
+}
+
+static monkeyboard_config_blob_status_t load_tap_dance(const void* section, uint16_t count, uint32_t size, ram_arena_t* arena, pipeline_tap_dance_global_config_t** result) {
+    section_reader_t reader = { (const uint8_t*)section, (const uint8_t*)section + size };
+    pipeline_tap_dance_global_config_t* global = arena_alloc(arena, sizeof(pipeline_tap_dance_global_config_t));
+    pipeline_tap_dance_behaviour_t** behaviours = arena_alloc(arena, count * sizeof(pipeline_tap_dance_behaviour_t*));
+    for (uint16_t i = 0; i < count; i++) {
+        const monkeyboard_config_blob_tap_dance_t* record = read_record(&reader, sizeof(monkeyboard_config_blob_tap_dance_t));
+        if (record == NULL) {
+            return MONKEYBOARD_CONFIG_BLOB_BAD_SECTION;
+        }
+        pipeline_tap_dance_behaviour_t* behaviour = arena_alloc(arena, sizeof(pipeline_tap_dance_behaviour_t));
+        pipeline_tap_dance_behaviour_config_t* config = arena_alloc(arena, sizeof(pipeline_tap_dance_behaviour_config_t));
+        pipeline_tap_dance_behaviour_status_t* status = arena_alloc(arena, sizeof(pipeline_tap_dance_behaviour_status_t));
+        pipeline_tap_dance_action_config_t** actions = arena_alloc(arena, record->action_count * sizeof(pipeline_tap_dance_action_config_t*));
+        for (uint8_t j = 0; j < record->action_count; j++) {
+            const monkeyboard_config_blob_tap_dance_action_t* action_record = read_record(&reader, sizeof(monkeyboard_config_blob_tap_dance_action_t));
+            if (action_record == NULL || action_record->action > TDCL_HOLD_KEY_CHANGELAYERTEMPO || action_record->hold_strategy > TAP_DANCE_BALANCED) {
+                return MONKEYBOARD_CONFIG_BLOB_BAD_SECTION;
+            }
+            pipeline_tap_dance_action_config_t* action = arena_alloc(arena, sizeof(pipeline_tap_dance_action_config_t));
+            if (action) {
+                action->tap_count = action_record->tap_count;
+                action->action = (td_customlayer_action_t)action_record->action;
+                action->keycode = action_record->keycode;
+                action->layer = action_record->layer;
+                action->hold_strategy = (tap_dance_hold_strategy_t)action_record->hold_strategy;
+                actions[j] = action;
+            }
+        }
+        if (behaviour) {
+            config->keycodemodifier = record->keycode;
+            config->hold_timeout = record->hold_timeout;
+            config->tap_timeout = record->tap_timeout;
+            config->actionslength = record->action_count;
+            config->actions = actions;
+            reset_behaviour_state(status);
+            behaviour->config = config;
+            behaviour->status = status;
+            behaviours[i] = behaviour;
+        }
+    }
+    if (global) {
+        global->length = count;
+        global->behaviours = behaviours;
+    }
+    *result = global;
+    return MONKEYBOARD_CONFIG_BLOB_OK;
+}
+
+static monkeyboard_config_blob_status_t load_oneshot(const void* section, uint16_t count, uint32_t size, ram_arena_t* arena, pipeline_oneshot_modifier_global_t** result) {
+    section_reader_t reader = { (const uint8_t*)section, (const uint8_t*)section + size };
+    pipeline_oneshot_modifier_global_t* global = arena_alloc(arena, sizeof(pipeline_oneshot_modifier_global_t));
+    pipeline_oneshot_modifier_global_config_t* config = arena_alloc(arena, sizeof(pipeline_oneshot_modifier_global_config_t));
+    pipeline_oneshot_modifier_global_status_t* status = arena_alloc(arena, sizeof(pipeline_oneshot_modifier_global_status_t));
+    pipeline_oneshot_modifier_pair_t** pairs = arena_alloc(arena, count * sizeof(pipeline_oneshot_modifier_pair_t*));
+    for (uint16_t i = 0; i < count; i++) {
+        const monkeyboard_config_blob_oneshot_t* record = read_record(&reader, sizeof(monkeyboard_config_blob_oneshot_t));
+        if (record == NULL) {
+            return MONKEYBOARD_CONFIG_BLOB_BAD_SECTION;
+        }
+        pipeline_oneshot_modifier_pair_t* pair = arena_alloc(arena, sizeof(pipeline_oneshot_modifier_pair_t));
+        if (pair) {
+            pair->keycode = record->keycode;
+            pair->modifiers = record->modifiers;
+            pairs[i] = pair;
+        }
+    }
+    if (global) {
+        config->length = count;
+        config->modifier_pairs = pairs;
+        status->modifiers = 0;
+        global->config = config;
+        global->status = status;
+    }
+    *result = global;
+    return MONKEYBOARD_CONFIG_BLOB_OK;
+}
+
+static monkeyboard_config_blob_status_t load_key_replacer_events(section_reader_t* reader, uint8_t count, platform_key_replacer_event_buffer_t* buffer) {
+    if (count > PLATFORM_KEY_VIRTUAL_BUFFER_MAX_ELEMENTS) {
+        return MONKEYBOARD_CONFIG_BLOB_BAD_SECTION;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        const monkeyboard_config_blob_key_replacer_event_t* record = read_record(reader, sizeof(monkeyboard_config_blob_key_replacer_event_t));
+        if (record == NULL) {
+            return MONKEYBOARD_CONFIG_BLOB_BAD_SECTION;
+        }
+        if (buffer) {
+            buffer->buffer[i].keycode = record->keycode;
+            buffer->buffer[i].is_press = record->is_press != 0;
+        }
+    }
+    if (buffer) {
+        buffer->buffer_length = count;
+    }
+    return MONKEYBOARD_CONFIG_BLOB_OK;
+}
+
+static monkeyboard_config_blob_status_t load_key_replacer(const void* section, uint16_t count, uint32_t size, ram_arena_t* arena, pipeline_key_replacer_global_config_t** result) {
+    section_reader_t reader = { (const uint8_t*)section, (const uint8_t*)section + size };
+    pipeline_key_replacer_global_config_t* global = arena_alloc(arena, sizeof(pipeline_key_replacer_global_config_t));
+    pipeline_key_replacer_pair_t** pairs = arena_alloc(arena, count * sizeof(pipeline_key_replacer_pair_t*));
+    for (uint16_t i = 0; i < count; i++) {
+        const monkeyboard_config_blob_key_replacer_t* record = read_record(&reader, sizeof(monkeyboard_config_blob_key_replacer_t));
+        if (record == NULL) {
+            return MONKEYBOARD_CONFIG_BLOB_BAD_SECTION;
+        }
+        pipeline_key_replacer_pair_t* pair = arena_alloc(arena, sizeof(pipeline_key_replacer_pair_t));
+        platform_key_replacer_event_buffer_t* press_buffer = arena_alloc(arena, sizeof(platform_key_replacer_event_buffer_t));
+        platform_key_replacer_event_buffer_t* release_buffer = arena_alloc(arena, sizeof(platform_key_replacer_event_buffer_t));
+        if (load_key_replacer_events(&reader, record->press_count, press_buffer) != MONKEYBOARD_CONFIG_BLOB_OK ||
+            load_key_replacer_events(&reader, record->release_count, release_buffer) != MONKEYBOARD_CONFIG_BLOB_OK) {
+            return MONKEYBOARD_CONFIG_BLOB_BAD_SECTION;
+        }
+        if (pair) {
+            pair->keycode = record->keycode;
+            pair->press_event_buffer = press_buffer;
+            pair->release_event_buffer = release_buffer;
+            pairs[i] = pair;
+        }
+    }
+    if (global) {
+        global->length = count;
+        global->modifier_pairs = pairs;
+    }
+    *result = global;
+    return MONKEYBOARD_CONFIG_BLOB_OK;
+}
+
+// Walks every section, building the pipeline configurations on the arena. When the arena is not building it
+// only checks the records and counts the RAM needed
+static monkeyboard_config_blob_status_t load_sections(const void* blob, ram_arena_t* arena, monkeyboard_config_blob_pipelines_t* pipelines) {
+    const monkeyboard_config_blob_header_t* header = (const monkeyboard_config_blob_header_t*)blob;
+    const monkeyboard_config_blob_section_t* sections = section_table(blob);
+    monkeyboard_config_blob_status_t status = MONKEYBOARD_CONFIG_BLOB_OK;
+    for (uint16_t i = 0; i < header->section_count && status == MONKEYBOARD_CONFIG_BLOB_OK; i++) {
+        const void* section = (const uint8_t*)blob + sections[i].offset;
+        switch (sections[i].type) {
+            case MONKEYBOARD_CONFIG_SECTION_KEYMAP:
+                status = load_keymap(section, sections[i].count, sections[i].size, arena);
+                break;
+            case MONKEYBOARD_CONFIG_SECTION_COMBOS:
+                status = load_combos(section, sections[i].count, sections[i].size, arena, &pipelines->combos);
+                break;
+            case MONKEYBOARD_CONFIG_SECTION_TAP_DANCE:
+                status = load_tap_dance(section, sections[i].count, sections[i].size, arena, &pipelines->tap_dance);
+                break;
+            case MONKEYBOARD_CONFIG_SECTION_ONESHOT:
+                status = load_oneshot(section, sections[i].count, sections[i].size, arena, &pipelines->oneshot);
+                break;
+            case MONKEYBOARD_CONFIG_SECTION_KEY_REPLACER:
+                status = load_key_replacer(section, sections[i].count, sections[i].size, arena, &pipelines->key_replacer);
+                break;
+            default:
+                break; // Unknown sections are skipped, so newer packers can add optional sections
+        }
+    }
+    return status;
+}
+
+monkeyboard_config_blob_status_t monkeyboard_config_blob_required_ram(const void* blob, size_t size, size_t* ram_size) {
+    monkeyboard_config_blob_status_t status = monkeyboard_config_blob_validate(blob, size);
+    if (status != MONKEYBOARD_CONFIG_BLOB_OK) {
+        return status;
+    }
+    ram_arena_t arena = { NULL, 0, 0, false };
+    monkeyboard_config_blob_pipelines_t pipelines = { NULL, NULL, NULL, NULL };
+    status = load_sections(blob, &arena, &pipelines);
+    *ram_size = arena.used;
+    return status;
+}
+
+monkeyboard_config_blob_status_t monkeyboard_config_blob_load(const void* blob, size_t size, void* ram, size_t ram_size, monkeyboard_config_blob_pipelines_t* pipelines) {
+    // Check the records and the RAM needed before touching the layout or the buffer
+    size_t required_ram = 0;
+    monkeyboard_config_blob_status_t status = monkeyboard_config_blob_required_ram(blob, size, &required_ram);
+    if (status != MONKEYBOARD_CONFIG_BLOB_OK) {
+        return status;
+    }
+    if (required_ram > ram_size || (required_ram > 0 && ram == NULL)) {
+        return MONKEYBOARD_CONFIG_BLOB_NO_RAM;
+    }
+    ram_arena_t arena = { (uint8_t*)ram, 0, ram_size, true };
+    pipelines->combos = NULL;
+    pipelines->tap_dance = NULL;
+    pipelines->oneshot = NULL;
+    pipelines->key_replacer = NULL;
+    return load_sections(blob, &arena, pipelines);
+}
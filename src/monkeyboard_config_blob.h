@@ -0,0 +1,164 @@
+// Binary configuration blob.
+//
+// The keymap and the pipeline configurations can be stored as a single flat binary blob, packed on the
+// host (see monkeyboard_config_packer.h) and flashed or memory mapped as it is. The blob has no pointers:
+// every section is referenced by its offset from the start of the blob, so it can be placed at any address.
+//
+// Layout (little endian, every record aligned to 4 bytes, the blob itself must be 4 bytes aligned):
+//
+//   monkeyboard_config_blob_header_t
+//   monkeyboard_config_blob_section_t[section_count]
+//   sections...
+//
+// Sections:
+// - KEYMAP: monkeyboard_config_blob_keymap_t, the extended keycode table (uint32_t[extended_count]) and the
+//   compact keymap (uint16_t[num_layers * rows * cols], padded to 4 bytes). The keymap is used in place.
+// - COMBOS: uint32_t strategy, then one monkeyboard_config_blob_combo_t per combo, each one followed by
+//   its monkeyboard_config_blob_combo_key_t records.
+// - TAP_DANCE: one monkeyboard_config_blob_tap_dance_t per behaviour, each one followed by its
+//   monkeyboard_config_blob_tap_dance_action_t records.
+// - ONESHOT: one monkeyboard_config_blob_oneshot_t per pair.
+// - KEY_REPLACER: one monkeyboard_config_blob_key_replacer_t per pair, each one followed by its press
+//   events and then its release events (monkeyboard_config_blob_key_replacer_event_t).
+//
+// The pipelines keep their runtime state inside their configuration structures and walk them through
+// pointer arrays, so they can't run on the blob records directly. monkeyboard_config_blob_load builds them
+// in a single buffer provided by the caller (see monkeyboard_config_blob_required_ram). Only the keymap, which
+// is read only, is used from the blob; the layout still allocates its state and the resolved keymap cache through
+// monkeyboard_malloc (see monkeyboard_memory.h), so a heapless build needs MONKEYBOARD_STATIC_ARENA.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "pipeline_combo.h"
+#include "pipeline_tap_dance.h"
+#include "pipeline_oneshot_modifier.h"
+#include "pipeline_key_replacer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MONKEYBOARD_CONFIG_BLOB_MAGIC 0x43424B4Du // "MKBC"
+#define MONKEYBOARD_CONFIG_BLOB_VERSION 1
+#define MONKEYBOARD_CONFIG_BLOB_ALIGNMENT 4
+
+typedef enum {
+    MONKEYBOARD_CONFIG_SECTION_KEYMAP = 1,
+    MONKEYBOARD_CONFIG_SECTION_COMBOS = 2,
+    MONKEYBOARD_CONFIG_SECTION_TAP_DANCE = 3,
+    MONKEYBOARD_CONFIG_SECTION_ONESHOT = 4,
+    MONKEYBOARD_CONFIG_SECTION_KEY_REPLACER = 5
+} monkeyboard_config_section_type_t;
+
+typedef enum {
+    MONKEYBOARD_CONFIG_BLOB_OK,
+    MONKEYBOARD_CONFIG_BLOB_BAD_MAGIC,
+    MONKEYBOARD_CONFIG_BLOB_BAD_VERSION,
+    MONKEYBOARD_CONFIG_BLOB_TRUNCATED,
+    MONKEYBOARD_CONFIG_BLOB_BAD_SECTION,
+    MONKEYBOARD_CONFIG_BLOB_NO_RAM
+} monkeyboard_config_blob_status_t;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t section_count;
+    uint32_t total_size;        // Size of the whole blob, header included
+    uint32_t reserved;
+} monkeyboard_config_blob_header_t;
+
+typedef struct {
+    uint16_t type;              // monkeyboard_config_section_type_t
+    uint16_t count;             // Number of top level records (combos, behaviours, pairs, layers)
+    uint32_t offset;            // From the start of the blob
+    uint32_t size;
+} monkeyboard_config_blob_section_t;
+
+typedef struct {
+    uint8_t num_layers;
+    uint8_t rows;               // 1 for 1D keymaps
+    uint16_t cols;              // Number of keys for 1D keymaps
+    uint16_t extended_count;
+    uint16_t reserved;
+} monkeyboard_config_blob_keymap_t;
+
+// Key positions are stored as the position for 1D keymaps and as (row << 8) | col for 2D keymaps
+typedef struct {
+    uint8_t key_count;
+    uint8_t press_action;       // pipeline_combo_key_action_t
+    uint8_t release_action;
+    uint8_t reserved;
+    uint32_t press_keycode;
+    uint32_t release_keycode;
+} monkeyboard_config_blob_combo_t;
+
+typedef struct {
+    uint16_t keypos;
+    uint8_t press_action;
+    uint8_t release_action;
+    uint32_t press_keycode;
+    uint32_t release_keycode;
+} monkeyboard_config_blob_combo_key_t;
+
+typedef struct {
+    uint32_t keycode;
+    uint16_t hold_timeout;
+    uint16_t tap_timeout;
+    uint8_t action_count;
+    uint8_t reserved[3];
+} monkeyboard_config_blob_tap_dance_t;
+
+typedef struct {
+    uint8_t tap_count;
+    uint8_t action;             // td_customlayer_action_t
+    uint8_t layer;
+    uint8_t hold_strategy;      // tap_dance_hold_strategy_t
+    uint32_t keycode;
+} monkeyboard_config_blob_tap_dance_action_t;
+
+typedef struct {
+    uint32_t keycode;
+    uint8_t modifiers;
+    uint8_t reserved[3];
+} monkeyboard_config_blob_oneshot_t;
+
+typedef struct {
+    uint32_t keycode;
+    uint8_t press_count;
+    uint8_t release_count;
+    uint16_t reserved;
+} monkeyboard_config_blob_key_replacer_t;
+
+typedef struct {
+    uint32_t keycode;
+    uint8_t is_press;
+    uint8_t reserved[3];
+} monkeyboard_config_blob_key_replacer_event_t;
+
+// Pipeline configurations built by monkeyboard_config_blob_load. NULL when the blob has no such section
+typedef struct {
+    pipeline_combo_global_config_t* combos;
+    pipeline_tap_dance_global_config_t* tap_dance;
+    pipeline_oneshot_modifier_global_t* oneshot;
+    pipeline_key_replacer_global_config_t* key_replacer;
+} monkeyboard_config_blob_pipelines_t;
+
+monkeyboard_config_blob_status_t monkeyboard_config_blob_validate(const void* blob, size_t size);
+
+// Returns the section of the given type, or NULL if the blob doesn't have it. The blob must be valid
+const void* monkeyboard_config_blob_get_section(const void* blob, monkeyboard_config_section_type_t type, uint16_t* count, uint32_t* size);
+
+// Checks every record of the blob and returns the bytes of RAM needed by monkeyboard_config_blob_load
+monkeyboard_config_blob_status_t monkeyboard_config_blob_required_ram(const void* blob, size_t size, size_t* ram_size);
+
+// Initializes the layout with the keymap of the blob (if it has one) and builds the pipeline configurations
+// on the ram buffer, which must be aligned for pointers. The blob and the buffer must outlive the pipelines.
+// The pipeline global states (e.g. pipeline_tap_dance_global_state_create) are still created by the caller.
+monkeyboard_config_blob_status_t monkeyboard_config_blob_load(const void* blob, size_t size, void* ram, size_t ram_size, monkeyboard_config_blob_pipelines_t* pipelines);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,256 @@
+#include "monkeyboard_config_packer.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "monkeyboard_config_blob.h"
+#include "monkeyboard_keycodes.h"
+#include "platform_types.h"
+
+#define MAX_SECTIONS 5
+
+// Writes the blob, or only measures it when there is no output buffer (or it is too small)
+typedef struct {
+    uint8_t* out;
+    size_t capacity;
+    size_t position;
+    bool ok;
+} blob_writer_t;
+
+static void write_at(blob_writer_t* writer, size_t position, const void* data, size_t size) {
+    if (writer->out != NULL && position + size <= writer->capacity) {
+        memcpy(writer->out + position, data, size);
+    }
+}
+
+static void write_bytes(blob_writer_t* writer, const void* data, size_t size) {
+    write_at(writer, writer->position, data, size);
+    writer->position += size;
+}
+
+static void write_padding(blob_writer_t* writer) {
+    static const uint8_t zeros[MONKEYBOARD_CONFIG_BLOB_ALIGNMENT] = {0};
+    size_t padding = (MONKEYBOARD_CONFIG_BLOB_ALIGNMENT - writer->position % MONKEYBOARD_CONFIG_BLOB_ALIGNMENT) % MONKEYBOARD_CONFIG_BLOB_ALIGNMENT;
+    write_bytes(writer, zeros, padding);
+}
+
+static uint16_t keypos_to_blob(platform_keypos_t keypos) {
+#if defined(AGNOSTIC_USE_1D_ARRAY)
+    return keypos;
+#elif defined(AGNOSTIC_USE_2D_ARRAY)
+    return (uint16_t)((keypos.row << 8) | keypos.col);
+#endif
+}
+
+static uint16_t pack_keymap(blob_writer_t* writer, const monkeyboard_config_packer_sources_t* sources) {
+    size_t keys = (size_t)sources->num_layers * sources->rows * sources->cols;
+    platform_keycode_t extended[PLATFORM_COMPACT_EXTENDED_MAX_KEYCODES];
+    uint16_t extended_count = 0;
+
+    // Keycodes that don't fit on a compact entry go to the extended table, once each
+    for (size_t i = 0; i < keys; i++) {
+        platform_keycode_t keycode = sources->keymap[i];
+        if (keycode < PLATFORM_COMPACT_EXTENDED_MIN) {
+            continue;
+        }
+        uint16_t index = 0;
+        while (index < extended_count && extended[index] != keycode) index++;
+        if (index == extended_count) {
+            if (extended_count == PLATFORM_COMPACT_EXTENDED_MAX_KEYCODES) {
+                writer->ok = false;
+                return 0;
+            }
+            extended[extended_count++] = keycode;
+        }
+    }
+
+    monkeyboard_config_blob_keymap_t header = {
+        .num_layers = sources->num_layers,
+        .rows = sources->rows,
+        .cols = sources->cols,
+        .extended_count = extended_count
+    };
+    write_bytes(writer, &header, sizeof(header));
+    write_bytes(writer, extended, extended_count * sizeof(platform_keycode_t));
+    for (size_t i = 0; i < keys; i++) {
+        platform_keycode_t keycode = sources->keymap[i];
+        platform_compact_keycode_t compact_keycode = (platform_compact_keycode_t)keycode;
+        if (keycode >= PLATFORM_COMPACT_EXTENDED_MIN) {
+            uint16_t index = 0;
+            while (extended[index] != keycode) index++;
+            compact_keycode = PLATFORM_COMPACT_EXTENDED(index);
+        }
+        write_bytes(writer, &compact_keycode, sizeof(compact_keycode));
+    }
+    return sources->num_layers;
+}
+
+static uint16_t pack_combos(blob_writer_t* writer, const pipeline_combo_global_config_t* config) {
+    uint32_t strategy = (uint32_t)config->strategy;
+    write_bytes(writer, &strategy, sizeof(strategy));
+    for (size_t i = 0; i < config->length; i++) {
+        const pipeline_combo_config_t* combo = config->combos[i];
+        if (combo->keys_length > UINT8_MAX) {
+            writer->ok = false;
+            return 0;
+        }
+        monkeyboard_config_blob_combo_t record = {
+            .key_count = (uint8_t)combo->keys_length,
+            .press_action = (uint8_t)combo->key_on_press_combo.action,
+            .release_action = (uint8_t)combo->key_on_release_combo.action,
+            .press_keycode = combo->key_on_press_combo.key,
+            .release_keycode = combo->key_on_release_combo.key
+        };
+        write_bytes(writer, &record, sizeof(record));
+        for (size_t j = 0; j < combo->keys_length; j++) {
+            const pipeline_combo_key_t* key = combo->keys[j];
+            monkeyboard_config_blob_combo_key_t key_record = {
+                .keypos = keypos_to_blob(key->keypos),
+                .press_action = (uint8_t)key->key_on_press.action,
+                .release_action = (uint8_t)key->key_on_release.action,
+                .press_keycode = key->key_on_press.key,
+                .release_keycode = key->key_on_release.key
+            };
+            write_bytes(writer, &key_record, sizeof(key_record));
+        }
+    }
+    return (uint16_t)config->length;
+}
+
+static uint16_t pack_tap_dance(blob_writer_t* writer, const pipeline_tap_dance_global_config_t* config) {
+    for (size_t i = 0; i < config->length; i++) {
+        const pipeline_tap_dance_behaviour_config_t* behaviour = config->behaviours[i]->config;
+        if (behaviour->actionslength > UINT8_MAX) {
+            writer->ok = false;
+            return 0;
+        }
+        monkeyboard_config_blob_tap_dance_t record = {
+            .keycode = behaviour->keycodemodifier,
+            .hold_timeout = behaviour->hold_timeout,
+            .tap_timeout = behaviour->tap_timeout,
+            .action_count = (uint8_t)behaviour->actionslength
+        };
+        write_bytes(writer, &record, sizeof(record));
+        for (size_t j = 0; j < behaviour->actionslength; j++) {
+            const pipeline_tap_dance_action_config_t* action = behaviour->actions[j];
+            monkeyboard_config_blob_tap_dance_action_t action_record = {
+                .tap_count = action->tap_count,
+                .action = (uint8_t)action->action,
+                .layer = action->layer,
+                .hold_strategy = (uint8_t)action->hold_strategy,
+                .keycode = action->keycode
+            };
+            write_bytes(writer, &action_record, sizeof(action_record));
+        }
+    }
+    return (uint16_t)config->length;
+}
+
+static uint16_t pack_oneshot(blob_writer_t* writer, const pipeline_oneshot_modifier_global_config_t* config) {
+    for (size_t i = 0; i < config->length; i++) {
+        monkeyboard_config_blob_oneshot_t record = {
+            .keycode = config->modifier_pairs[i]->keycode,
+            .modifiers = config->modifier_pairs[i]->modifiers
+        };
+        write_bytes(writer, &record, sizeof(record));
+    }
+    return (uint16_t)config->length;
+}
+
+static void pack_key_replacer_events(blob_writer_t* writer, const platform_key_replacer_event_buffer_t* buffer) {
+    for (uint8_t i = 0; buffer != NULL && i < buffer->buffer_length; i++) {
+        monkeyboard_config_blob_key_replacer_event_t record = {
+            .keycode = buffer->buffer[i].keycode,
+            .is_press = buffer->buffer[i].is_press ? 1 : 0
+        };
+        write_bytes(writer, &record, sizeof(record));
+    }
+}
+
+static uint16_t pack_key_replacer(blob_writer_t* writer, const pipeline_key_replacer_global_config_t* config) {
+    for (size_t i = 0; i < config->length; i++) {
+        const pipeline_key_replacer_pair_t* pair = config->modifier_pairs[i];
+        monkeyboard_config_blob_key_replacer_t record = {
+            .keycode = pair->keycode,
+            .press_count = pair->press_event_buffer ? pair->press_event_buffer->buffer_length : 0,
+            .release_count = pair->release_event_buffer ? pair->release_event_buffer->buffer_length : 0
+        };
+        write_bytes(writer, &record, sizeof(record));
+        pack_key_replacer_events(writer, pair->press_event_buffer);
+        pack_key_replacer_events(writer, pair->release_event_buffer);
+    }
+    return (uint16_t)config->length;
+}
+
+static bool fits_section_count(size_t length) {
+    return length <= UINT16_MAX;
+}
+
+size_t monkeyboard_config_pack(const monkeyboard_config_packer_sources_t* sources, void* out, size_t out_size) {
+    uint16_t types[MAX_SECTIONS];
+    uint16_t section_count = 0;
+    if (sources->keymap) types[section_count++] = MONKEYBOARD_CONFIG_SECTION_KEYMAP;
+    if (sources->combos) types[section_count++] = MONKEYBOARD_CONFIG_SECTION_COMBOS;
+    if (sources->tap_dance) types[section_count++] = MONKEYBOARD_CONFIG_SECTION_TAP_DANCE;
+    if (sources->oneshot) types[section_count++] = MONKEYBOARD_CONFIG_SECTION_ONESHOT;
+    if (sources->key_replacer) types[section_count++] = MONKEYBOARD_CONFIG_SECTION_KEY_REPLACER;
+
+    if ((sources->combos && !fits_section_count(sources->combos->length)) ||
+        (sources->tap_dance && !fits_section_count(sources->tap_dance->length)) ||
+        (sources->oneshot && !fits_section_count(sources->oneshot->length)) ||
+        (sources->key_replacer && !fits_section_count(sources->key_replacer->length))) {
+        return 0;
+    }
+
+    // Measure first, write only if the whole blob fits
+    blob_writer_t writer = { NULL, 0, 0, true };
+    for (uint8_t pass = 0; pass < 2; pass++) {
+        if (pass == 1) {
+            if (out == NULL || out_size < writer.position) {
+                return writer.position;
+            }
+            writer.out = (uint8_t*)out;
+            writer.capacity = out_size;
+            writer.position = 0;
+        }
+
+        monkeyboard_config_blob_section_t sections[MAX_SECTIONS];
+        writer.position = sizeof(monkeyboard_config_blob_header_t) + section_count * sizeof(monkeyboard_config_blob_section_t);
+        for (uint16_t i = 0; i < section_count; i++) {
+            sections[i].type = types[i];
+            sections[i].offset = (uint32_t)writer.position;
+            switch (types[i]) {
+                case MONKEYBOARD_CONFIG_SECTION_KEYMAP:
+                    sections[i].count = pack_keymap(&writer, sources);
+                    break;
+                case MONKEYBOARD_CONFIG_SECTION_COMBOS:
+                    sections[i].count = pack_combos(&writer, sources->combos);
+                    break;
+                case MONKEYBOARD_CONFIG_SECTION_TAP_DANCE:
+                    sections[i].count = pack_tap_dance(&writer, sources->tap_dance);
+                    break;
+                case MONKEYBOARD_CONFIG_SECTION_ONESHOT:
+                    sections[i].count = pack_oneshot(&writer, sources->oneshot);
+                    break;
+                default:
+                    sections[i].count = pack_key_replacer(&writer, sources->key_replacer);
+                    break;
+            }
+            if (!writer.ok) {
+                return 0;
+            }
+            sections[i].size = (uint32_t)(writer.position - sections[i].offset);
+            write_padding(&writer);
+        }
+
+        monkeyboard_config_blob_header_t header = {
+            .magic = MONKEYBOARD_CONFIG_BLOB_MAGIC,
+            .version = MONKEYBOARD_CONFIG_BLOB_VERSION,
+            .section_count = section_count,
+            .total_size = (uint32_t)writer.position
+        };
+        write_at(&writer, 0, &header, sizeof(header));
+        write_at(&writer, sizeof(header), sections, section_count * sizeof(monkeyboard_config_blob_section_t));
+    }
+    return writer.position;
+}
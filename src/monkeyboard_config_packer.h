@@ -0,0 +1,40 @@
+// Host side packer of the binary configuration blob (see monkeyboard_config_blob.h).
+//
+// Builds the blob from the same C structures used to configure the pipelines at runtime, so a keyboard
+// configuration can be written once and either used directly or packed to be flashed. The blob is written
+// with the byte order of the host, which has to match the one of the keyboard (little endian).
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "pipeline_combo.h"
+#include "pipeline_tap_dance.h"
+#include "pipeline_oneshot_modifier.h"
+#include "pipeline_key_replacer.h"
+#include "platform_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Sources of the blob. Any of them can be NULL to leave its section out
+typedef struct {
+    const platform_keycode_t* keymap;   // Flattened keymap, [num_layers][rows][cols] or [num_layers][num_keys]
+    uint8_t num_layers;
+    uint8_t rows;                       // 1 for 1D keymaps
+    uint16_t cols;                      // Number of keys for 1D keymaps
+    const pipeline_combo_global_config_t* combos;
+    const pipeline_tap_dance_global_config_t* tap_dance;
+    const pipeline_oneshot_modifier_global_config_t* oneshot;
+    const pipeline_key_replacer_global_config_t* key_replacer;
+} monkeyboard_config_packer_sources_t;
+
+// Packs the sources into out and returns the size of the blob. Nothing is written if out is NULL or smaller
+// than the blob, so it can be called first to get the size. Returns 0 if the sources can't be packed
+// (more than PLATFORM_COMPACT_EXTENDED_MAX_KEYCODES extended keycodes, or a count out of the blob limits).
+size_t monkeyboard_config_pack(const monkeyboard_config_packer_sources_t* sources, void* out, size_t out_size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -2,7 +2,21 @@
 
 #include "monkeyboard_platform_detection.h"
 
-#if defined(FRAMEWORK_UNIT_TEST)
+// MONKEYBOARD_DEBUG_BINARY logs to the binary ring of monkeyboard_debug_ring.h on any platform, without formatting
+#if defined(MONKEYBOARD_DEBUG_BINARY)
+    #if !defined(MONKEYBOARD_DEBUG)
+        #define MONKEYBOARD_DEBUG
+    #endif
+
+    #include "monkeyboard_debug_ring.h"
+
+    #define DEBUG_PRINT_NL() MONKEYBOARD_DEBUG_LOG("\n")
+    #define DEBUG_PRINT(fmt, ...) MONKEYBOARD_DEBUG_LOG("" fmt "\n", ##__VA_ARGS__)
+    #define DEBUG_PRINT_RAW(fmt, ...) MONKEYBOARD_DEBUG_LOG("" fmt "", ##__VA_ARGS__)
+    #define DEBUG_PRINT_PREFIX(prefix, fmt, ...) MONKEYBOARD_DEBUG_LOG(prefix fmt "\n", ##__VA_ARGS__)
+    #define DEBUG_PRINT_RAW_PREFIX(prefix, fmt, ...) MONKEYBOARD_DEBUG_LOG(prefix fmt "", ##__VA_ARGS__)
+    #define DEBUG_PRINT_ERROR(fmt, ...) MONKEYBOARD_DEBUG_LOG("# ERROR #: " fmt "\n", ##__VA_ARGS__)
+#elif defined(FRAMEWORK_UNIT_TEST)
     #if !defined(MONKEYBOARD_DEBUG)
         #define MONKEYBOARD_DEBUG
     #endif
@@ -0,0 +1,55 @@
+#include "monkeyboard_debug_ring.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#define RING_MASK (MONKEYBOARD_DEBUG_RING_WORDS - 1)
+
+_Static_assert((MONKEYBOARD_DEBUG_RING_WORDS & RING_MASK) == 0, "MONKEYBOARD_DEBUG_RING_WORDS has to be a power of two");
+
+monkeyboard_debug_ring_t monkeyboard_debug_ring;
+
+void monkeyboard_debug_ring_log(const char* format, uint8_t arg_count, const monkeyboard_debug_word_t* args) {
+    monkeyboard_debug_ring_t* ring = &monkeyboard_debug_ring;
+    uint32_t head = ring->head;
+    uint32_t record_words = MONKEYBOARD_DEBUG_RECORD_HEADER_WORDS + arg_count;
+    if (head - ring->tail + record_words > MONKEYBOARD_DEBUG_RING_WORDS) {
+        ring->dropped_records++;
+        return;
+    }
+    ring->words[head & RING_MASK] = (monkeyboard_debug_word_t)format;
+    ring->words[(head + 1) & RING_MASK] = arg_count;
+    for (uint8_t i = 0; i < arg_count; i++) {
+        ring->words[(head + MONKEYBOARD_DEBUG_RECORD_HEADER_WORDS + i) & RING_MASK] = args[i];
+    }
+    // The record is complete before the consumer can see it
+    atomic_thread_fence(memory_order_release);
+    ring->head = head + record_words;
+}
+
+size_t monkeyboard_debug_ring_read(monkeyboard_debug_word_t* out, size_t max_words) {
+    monkeyboard_debug_ring_t* ring = &monkeyboard_debug_ring;
+    uint32_t head = ring->head;
+    atomic_thread_fence(memory_order_acquire);
+    uint32_t tail = ring->tail;
+    size_t words = 0;
+    while (tail != head) {
+        uint32_t record_words = MONKEYBOARD_DEBUG_RECORD_HEADER_WORDS + (uint32_t)ring->words[(tail + 1) & RING_MASK];
+        if (words + record_words > max_words) break;
+        for (uint32_t i = 0; i < record_words; i++) {
+            out[words++] = ring->words[(tail + i) & RING_MASK];
+        }
+        tail += record_words;
+    }
+    // The words are copied before the producer can overwrite them
+    atomic_thread_fence(memory_order_release);
+    ring->tail = tail;
+    return words;
+}
+
+void monkeyboard_debug_ring_reset(void) {
+    monkeyboard_debug_ring.head = 0;
+    monkeyboard_debug_ring.tail = 0;
+    monkeyboard_debug_ring.dropped_records = 0;
+}
@@ -0,0 +1,72 @@
+// Binary debug log (MONKEYBOARD_DEBUG_BINARY): the DEBUG_* macros of monkeyboard_debug.h append the address of their
+// format string and their raw arguments to a lock-free ring instead of formatting them, so the diagnostics cost a few
+// stores and don't change the timing of the pipelines. The ring is drained by the transport (console, raw HID...) and
+// decoded on the host (tests/debug_ring_decoder.hpp), resolving the format strings from the firmware image.
+//
+// Record: the format string address, the argument count and the arguments, one word each. Every argument is stored as
+// a word: integers up to the word size and string addresses (%s). Up to MONKEYBOARD_DEBUG_LOG_MAX_ARGS arguments.
+// Only the address of a string is kept, and the host reads it from the firmware image: the formats and the %s
+// arguments must be string literals (.rodata). A string built on the stack or in RAM can't be decoded, the decoder
+// shows its address instead.
+//
+// Single producer, single consumer: the firmware logs from one context and drains from one context. A record that
+// doesn't fit is dropped and counted.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Size of the ring in words, a power of two
+#ifndef MONKEYBOARD_DEBUG_RING_WORDS
+#define MONKEYBOARD_DEBUG_RING_WORDS 1024
+#endif
+
+#define MONKEYBOARD_DEBUG_LOG_MAX_ARGS 8
+#define MONKEYBOARD_DEBUG_RECORD_HEADER_WORDS 2
+
+typedef uintptr_t monkeyboard_debug_word_t;
+
+typedef struct {
+    monkeyboard_debug_word_t words[MONKEYBOARD_DEBUG_RING_WORDS];
+    volatile uint32_t head; // Words written, only updated by the producer
+    volatile uint32_t tail; // Words read, only updated by the consumer
+    volatile uint32_t dropped_records;
+} monkeyboard_debug_ring_t;
+
+extern monkeyboard_debug_ring_t monkeyboard_debug_ring;
+
+void monkeyboard_debug_ring_log(const char* format, uint8_t arg_count, const monkeyboard_debug_word_t* args);
+// Moves whole records to out, up to max_words. Returns the words moved
+size_t monkeyboard_debug_ring_read(monkeyboard_debug_word_t* out, size_t max_words);
+void monkeyboard_debug_ring_reset(void);
+
+// Logs the format string and the arguments: MONKEYBOARD_DEBUG_LOG("K:%04u, P:%d", keycode, is_press)
+#define MONKEYBOARD_DEBUG_LOG(format, ...) do { \
+        const monkeyboard_debug_word_t monkeyboard_debug_args[] = { MONKEYBOARD_DEBUG_WORDS(__VA_ARGS__) 0 }; \
+        monkeyboard_debug_ring_log(format, MONKEYBOARD_DEBUG_NARGS(__VA_ARGS__), monkeyboard_debug_args); \
+    } while (0)
+
+#define MONKEYBOARD_DEBUG_NARGS(...) MONKEYBOARD_DEBUG_NARGS_(0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define MONKEYBOARD_DEBUG_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, count, ...) count
+#define MONKEYBOARD_DEBUG_CONCAT(a, b) MONKEYBOARD_DEBUG_CONCAT_(a, b)
+#define MONKEYBOARD_DEBUG_CONCAT_(a, b) a##b
+#define MONKEYBOARD_DEBUG_WORDS(...) MONKEYBOARD_DEBUG_CONCAT(MONKEYBOARD_DEBUG_WORDS_, MONKEYBOARD_DEBUG_NARGS(__VA_ARGS__))(__VA_ARGS__)
+#define MONKEYBOARD_DEBUG_WORDS_0()
+#define MONKEYBOARD_DEBUG_WORDS_1(a) (monkeyboard_debug_word_t)(a),
+#define MONKEYBOARD_DEBUG_WORDS_2(a, ...) (monkeyboard_debug_word_t)(a), MONKEYBOARD_DEBUG_WORDS_1(__VA_ARGS__)
+#define MONKEYBOARD_DEBUG_WORDS_3(a, ...) (monkeyboard_debug_word_t)(a), MONKEYBOARD_DEBUG_WORDS_2(__VA_ARGS__)
+#define MONKEYBOARD_DEBUG_WORDS_4(a, ...) (monkeyboard_debug_word_t)(a), MONKEYBOARD_DEBUG_WORDS_3(__VA_ARGS__)
+#define MONKEYBOARD_DEBUG_WORDS_5(a, ...) (monkeyboard_debug_word_t)(a), MONKEYBOARD_DEBUG_WORDS_4(__VA_ARGS__)
+#define MONKEYBOARD_DEBUG_WORDS_6(a, ...) (monkeyboard_debug_word_t)(a), MONKEYBOARD_DEBUG_WORDS_5(__VA_ARGS__)
+#define MONKEYBOARD_DEBUG_WORDS_7(a, ...) (monkeyboard_debug_word_t)(a), MONKEYBOARD_DEBUG_WORDS_6(__VA_ARGS__)
+#define MONKEYBOARD_DEBUG_WORDS_8(a, ...) (monkeyboard_debug_word_t)(a), MONKEYBOARD_DEBUG_WORDS_7(__VA_ARGS__)
+
+#ifdef __cplusplus
+}
+#endif
@@ -3,27 +3,66 @@
 #include <stdint.h>
 #include <string.h>
 #include "platform_interface.h"
+#include "monkeyboard_memory.h"
 
-// Static storage for callback entries
-static deferred_callback_entry_t callback_queue[MAX_DEFERRED_CALLBACKS];
+// Static storage for callback entries, used with the default capacity
+static deferred_callback_entry_t default_callback_queue[MAX_DEFERRED_CALLBACKS];
+static deferred_callback_entry_t *callback_queue = default_callback_queue;
+static uint8_t callback_capacity = MAX_DEFERRED_CALLBACKS;
+static bool callback_queue_growable = false;
 static uint32_t next_add_order = 0;
 static deferred_token_t next_token = 1; // Start at 1, 0 is invalid
 
+void deferred_callbacks_create(uint8_t capacity, bool growable) {
+    if (capacity != callback_capacity) {
+        if (callback_queue != default_callback_queue) {
+            monkeyboard_free(callback_queue);
+        }
+        callback_queue = capacity == MAX_DEFERRED_CALLBACKS ? default_callback_queue : monkeyboard_malloc(sizeof(deferred_callback_entry_t) * capacity);
+        callback_capacity = capacity;
+    }
+    callback_queue_growable = growable;
+    clear_all_deferred_callbacks();
+}
+
+// Grows a full growable queue. The new slots are inactive
+static bool grow_callback_queue(void) {
+#if defined(MONKEYBOARD_GROWABLE_BUFFERS)
+    uint8_t capacity = monkeyboard_memory_grown_capacity(callback_capacity);
+    if (!callback_queue_growable || capacity == callback_capacity) {
+        return false;
+    }
+    deferred_callback_entry_t *queue = monkeyboard_memory_grow(callback_queue, sizeof(deferred_callback_entry_t) * callback_capacity, sizeof(deferred_callback_entry_t) * capacity, callback_queue != default_callback_queue);
+    if (queue == NULL) {
+        return false;
+    }
+    memset(&queue[callback_capacity], 0, sizeof(deferred_callback_entry_t) * (capacity - callback_capacity));
+    callback_queue = queue;
+    callback_capacity = capacity;
+    return true;
+#else
+    return false;
+#endif
+}
+
 // Helper function to find an empty slot
-static int8_t find_empty_slot(void) {
-    for (int8_t i = 0; i < MAX_DEFERRED_CALLBACKS; i++) {
+static int16_t find_empty_slot(void) {
+    for (int16_t i = 0; i < callback_capacity; i++) {
         if (!callback_queue[i].active) {
             return i;
         }
     }
+    if (grow_callback_queue()) {
+        return find_empty_slot();
+    }
     return -1; // No empty slots
 }
 
 // Helper function to find a callback by token
-static int8_t find_callback_by_token(deferred_token_t token) {
+static int16_t find_callback_by_token(deferred_token_t token) {
     if (token == DEFERRED_INVALID_TOKEN) return -1;
 
-    for (int8_t i = 0; i < MAX_DEFERRED_CALLBACKS; i++) {
+    for (int16_t i = 0; i < callback_capacity; i++) {
         if (callback_queue[i].active && callback_queue[i].token == token) {
             return i;
         }
@@ -34,8 +73,8 @@ static int8_t find_callback_by_token(deferred_token_t token) {
 // Helper function to sort callbacks by execution time, then by add order
 static void sort_callbacks(void) {
     // Simple bubble sort - efficient enough for small arrays
-    for (int i = 0; i < MAX_DEFERRED_CALLBACKS - 1; i++) {
-        for (int j = 0; j < MAX_DEFERRED_CALLBACKS - 1 - i; j++) {
+    for (int i = 0; i < callback_capacity - 1; i++) {
+        for (int j = 0; j < callback_capacity - 1 - i; j++) {
             if (!callback_queue[j].active) continue;
             if (!callback_queue[j + 1].active) continue;
 
@@ -62,7 +101,7 @@ static void sort_callbacks(void) {
 deferred_token_t schedule_deferred_callback(uint32_t delay_ms, deferred_callback_t callback, void *context) {
     if (!callback) return DEFERRED_INVALID_TOKEN;
 
-    int8_t slot = find_empty_slot();
+    int16_t slot = find_empty_slot();
     if (slot < 0) return DEFERRED_INVALID_TOKEN; // Queue is full
 
     uint32_t current_time = monkeyboard_get_time_32();
@@ -89,7 +128,7 @@ deferred_token_t schedule_deferred_callback(uint32_t delay_ms, deferred_callback
 // Cancel a scheduled callback by token
 // Returns true if the callback was found and cancelled, false otherwise
 bool cancel_deferred_callback(deferred_token_t token) {
-    int8_t slot = find_callback_by_token(token);
+    int16_t slot = find_callback_by_token(token);
     if (slot < 0) return false; // Token not found
 
     // Mark slot as inactive
@@ -108,7 +147,11 @@ bool cancel_deferred_callback(deferred_token_t token) {
 // Execute the next pending callback immediately
 void execute_callback(deferred_callback_entry_t *callback) {
     if (callback != NULL) {
-        callback->callback(callback->context);
+        // The slot is released before the callback runs: a callback scheduling a new callback sorts the queue,
+        // so the slot could hold the new callback by the time this one returns
+        deferred_callback_t function = callback->callback;
+        void *context = callback->context;
+
         // Mark slot as inactive
         callback->active = false;
 
@@ -118,6 +161,8 @@ void execute_callback(deferred_callback_entry_t *callback) {
         callback->execute_time = 0;
         callback->add_order = 0;
         callback->token = DEFERRED_INVALID_TOKEN;
+
+        function(context);
     }
 }
 
@@ -126,7 +171,7 @@ void execute_deferred_executions(void) {
     uint32_t current_time = monkeyboard_get_time_32();
 
     // Process callbacks in order (queue is kept sorted)
-    for (int8_t i = 0; i < MAX_DEFERRED_CALLBACKS; i++) {
+    for (int16_t i = 0; i < callback_capacity; i++) {
         if (!callback_queue[i].active) continue;
 
         // Check if this callback is due
@@ -145,7 +190,7 @@ void execute_deferred_executions(void) {
 // Get the first pending callback that is due to execute
 deferred_callback_entry_t *get_next_deferred_callback(uint32_t current_time) {
 
-    for (int8_t i = 0; i < MAX_DEFERRED_CALLBACKS; i++) {
+    for (int16_t i = 0; i < callback_capacity; i++) {
         if (callback_queue[i].active && time_is_after_or_equal(current_time, callback_queue[i].execute_time)) {
             return &callback_queue[i];
         }
@@ -157,7 +202,7 @@ deferred_callback_entry_t *get_next_deferred_callback(uint32_t current_time) {
 
 // Clear all pending callbacks
 void clear_all_deferred_callbacks(void) {
-    memset(callback_queue, 0, sizeof(callback_queue));
+    memset(callback_queue, 0, sizeof(deferred_callback_entry_t) * callback_capacity);
     // Reset token counter but keep it valid
     next_token = 1;
 }
@@ -165,7 +210,7 @@ void clear_all_deferred_callbacks(void) {
 // Get the number of pending callbacks
 uint8_t get_pending_callback_count(void) {
     uint8_t count = 0;
-    for (int8_t i = 0; i < MAX_DEFERRED_CALLBACKS; i++) {
+    for (int16_t i = 0; i < callback_capacity; i++) {
         if (callback_queue[i].active) {
             count++;
         }
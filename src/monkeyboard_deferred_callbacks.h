@@ -6,7 +6,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 
-// Maximum number of deferred callbacks that can be queued
+// Default number of deferred callbacks that can be queued
 #ifndef MAX_DEFERRED_CALLBACKS
 #define MAX_DEFERRED_CALLBACKS 16
 #endif
@@ -33,6 +33,9 @@ extern "C" {
 #endif
 
 // Public API functions
+// Sets the number of callbacks that can be queued and clears the queue. The default capacity uses a static queue, any
+// other is allocated. A growable queue doubles its capacity when full (see monkeyboard_memory.h)
+void deferred_callbacks_create(uint8_t capacity, bool growable);
 deferred_token_t schedule_deferred_callback(uint32_t delay_ms, deferred_callback_t callback, void *context);
 bool cancel_deferred_callback(deferred_token_t token);
 void execute_callback(deferred_callback_entry_t *callback);
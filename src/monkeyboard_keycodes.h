@@ -29,6 +29,16 @@ typedef struct {
     uint32_t custom_func;   // Valid for CUSTOM only
 } keycode_info_t;
 
+// Compact keymaps store basic and modified keycodes on 16 bits. Entries from PLATFORM_COMPACT_EXTENDED_MIN are an index
+// on the extended keycode table of the keymap, used for unicode and custom keycodes (and modified keycodes with
+// the eight modifiers, whose values collide with the escape)
+#define PLATFORM_COMPACT_EXTENDED_MIN 0xFF00
+#define PLATFORM_COMPACT_EXTENDED_MAX_KEYCODES 256
+#define PLATFORM_COMPACT_EXTENDED(index) ((platform_compact_keycode_t)(PLATFORM_COMPACT_EXTENDED_MIN | (index)))
+
+#define PLATFORM_KC_NO          0x00
+#define PLATFORM_KC_TRANSPARENT 0x01 // Resolves to the key on the layers below (same value as QMK KC_TRANSPARENT)
+
 #define PLATFORM_KC_LEFT_CTRL   0xE0
 #define PLATFORM_KC_LEFT_SHIFT  0xE1
 #define PLATFORM_KC_LEFT_ALT    0xE2
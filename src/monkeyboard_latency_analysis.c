@@ -0,0 +1,159 @@
+#include "monkeyboard_latency_analysis.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "pipeline_combo.h"
+#include "pipeline_tap_dance.h"
+#include "platform_interface.h"
+#include "platform_types.h"
+
+static uint32_t min_u32(uint32_t a, uint32_t b) {
+    return a < b ? a : b;
+}
+
+static bool is_combo_key(const pipeline_combo_global_config_t* config, platform_keypos_t keypos) {
+    for (size_t i = 0; i < config->length; i++) {
+        pipeline_combo_config_t* combo = config->combos[i];
+        for (size_t j = 0; j < combo->keys_length; j++) {
+            if (platform_compare_keyposition(combo->keys[j]->keypos, keypos)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static bool has_action(const pipeline_tap_dance_behaviour_config_t* config, uint8_t tap_count, td_customlayer_action_t action_type) {
+    for (size_t i = 0; i < config->actionslength; i++) {
+        pipeline_tap_dance_action_config_t* action = config->actions[i];
+        if (action->tap_count == tap_count && action->action == action_type) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint8_t max_tap_count(const pipeline_tap_dance_behaviour_config_t* config) {
+    uint8_t max = 0;
+    for (size_t i = 0; i < config->actionslength; i++) {
+        if (config->actions[i]->tap_count > max) {
+            max = config->actions[i]->tap_count;
+        }
+    }
+    return max;
+}
+
+// Delay of the press number tap_count of the behaviour, following the decisions of pipeline_tap_dance.c.
+// held_ms is the time the key is held, UINT32_MAX for the worst case
+static uint32_t tap_dance_delay(const pipeline_tap_dance_behaviour_config_t* config, uint8_t tap_count, uint8_t last_tap_count, uint32_t held_ms, uint8_t* sources) {
+    bool subsequent_actions = tap_count < last_tap_count;
+    uint32_t delay = 0;
+    if (has_action(config, tap_count, TDCL_HOLD_KEY_CHANGELAYERTEMPO)) {
+        // Released before the hold timeout, or decided as hold when it expires
+        *sources |= MONKEYBOARD_LATENCY_HOLD;
+        delay = min_u32(held_ms, config->hold_timeout);
+        // A release before the hold timeout waits for the next tap (the worst case is released just before it)
+        if (subsequent_actions && (held_ms < config->hold_timeout || held_ms == UINT32_MAX)) {
+            *sources |= MONKEYBOARD_LATENCY_MULTI_TAP;
+            delay += config->tap_timeout;
+        }
+    } else if (subsequent_actions) {
+        // Captured until the release without timeout, then waits for the next tap
+        *sources |= MONKEYBOARD_LATENCY_MULTI_TAP;
+        if (held_ms == UINT32_MAX) {
+            *sources |= MONKEYBOARD_LATENCY_WAITS_FOR_RELEASE;
+            delay = config->tap_timeout;
+        } else {
+            delay = held_ms + config->tap_timeout;
+        }
+    }
+    return delay;
+}
+
+void monkeyboard_latency_analysis_config_init(monkeyboard_latency_analysis_config_t* config, const pipeline_combo_global_config_t* combo, const pipeline_tap_dance_global_config_t* tap_dance) {
+    config->combo = combo;
+    config->tap_dance = tap_dance;
+    config->typical_tap_ms = MONKEYBOARD_LATENCY_TYPICAL_TAP_MS;
+}
+
+monkeyboard_key_latency_t monkeyboard_latency_analysis_key(const monkeyboard_latency_analysis_config_t* config, uint8_t layer, platform_keypos_t keypos) {
+    monkeyboard_key_latency_t latency = { 0, 0, 0 };
+
+    uint32_t combo_worst = 0;
+    uint32_t combo_typical = 0;
+    if (config->combo != NULL && is_combo_key(config->combo, keypos)) {
+        // Held back until the other keys of the combo are pressed or the interval expires
+        latency.sources |= MONKEYBOARD_LATENCY_COMBO;
+        combo_worst = PIPELINE_COMBO_INTERVAL_TIMEOUT_MS;
+        combo_typical = min_u32(config->typical_tap_ms, PIPELINE_COMBO_INTERVAL_TIMEOUT_MS);
+    }
+
+    uint32_t tap_dance_worst = 0;
+    uint32_t tap_dance_typical = 0;
+    if (config->tap_dance != NULL) {
+        platform_keycode_t keycode = platform_layout_get_keycode_from_layer(layer, keypos);
+        for (size_t i = 0; i < config->tap_dance->length; i++) {
+            const pipeline_tap_dance_behaviour_config_t* behaviour = config->tap_dance->behaviours[i]->config;
+            if (behaviour->keycodemodifier != keycode) {
+                continue;
+            }
+            uint8_t last_tap_count = max_tap_count(behaviour);
+            for (uint8_t tap_count = 1; tap_count <= last_tap_count; tap_count++) {
+                uint32_t delay = tap_dance_delay(behaviour, tap_count, last_tap_count, UINT32_MAX, &latency.sources);
+                if (delay > tap_dance_worst) {
+                    tap_dance_worst = delay;
+                }
+            }
+            if (last_tap_count > 0) {
+                uint8_t typical_sources = 0;
+                tap_dance_typical = tap_dance_delay(behaviour, 1, last_tap_count, config->typical_tap_ms, &typical_sources);
+            }
+            break;
+        }
+    }
+
+    // The tap dance only sees the key once the combo releases it, but both decisions start on the press
+    latency.worst_ms = combo_worst + tap_dance_worst;
+    latency.typical_ms = combo_typical > tap_dance_typical ? combo_typical : tap_dance_typical;
+    return latency;
+}
+
+static void add_to_layer_latency(monkeyboard_key_latency_t* layer_latency, monkeyboard_key_latency_t key_latency, uint16_t* keys_with_delay) {
+    if (key_latency.sources != 0 && keys_with_delay != NULL) {
+        (*keys_with_delay)++;
+    }
+    if (key_latency.worst_ms > layer_latency->worst_ms) {
+        layer_latency->worst_ms = key_latency.worst_ms;
+    }
+    if (key_latency.typical_ms > layer_latency->typical_ms) {
+        layer_latency->typical_ms = key_latency.typical_ms;
+    }
+    layer_latency->sources |= key_latency.sources;
+}
+
+#if defined(AGNOSTIC_USE_1D_ARRAY)
+monkeyboard_key_latency_t monkeyboard_latency_analysis_layer(const monkeyboard_latency_analysis_config_t* config, uint8_t layer, uint16_t num_keys, uint16_t* keys_with_delay) {
+    monkeyboard_key_latency_t layer_latency = { 0, 0, 0 };
+    if (keys_with_delay != NULL) {
+        *keys_with_delay = 0;
+    }
+    for (uint16_t keypos = 0; keypos < num_keys; keypos++) {
+        add_to_layer_latency(&layer_latency, monkeyboard_latency_analysis_key(config, layer, keypos), keys_with_delay);
+    }
+    return layer_latency;
+}
+#elif defined(AGNOSTIC_USE_2D_ARRAY)
+monkeyboard_key_latency_t monkeyboard_latency_analysis_layer(const monkeyboard_latency_analysis_config_t* config, uint8_t layer, uint8_t rows, uint8_t cols, uint16_t* keys_with_delay) {
+    monkeyboard_key_latency_t layer_latency = { 0, 0, 0 };
+    if (keys_with_delay != NULL) {
+        *keys_with_delay = 0;
+    }
+    for (uint8_t row = 0; row < rows; row++) {
+        for (uint8_t col = 0; col < cols; col++) {
+            platform_keypos_t keypos = { row, col };
+            add_to_layer_latency(&layer_latency, monkeyboard_latency_analysis_key(config, layer, keypos), keys_with_delay);
+        }
+    }
+    return layer_latency;
+}
+#endif
@@ -0,0 +1,64 @@
+// Static analysis of the delay the configuration adds to each key, without typing anything: for a key position on a
+// layer, how long the pipelines can hold the key back before its first output. It can back a UI showing the delay of
+// each programmed key, or a CI check that the latency sensitive layers stay under a budget.
+//
+// The delay comes from:
+// - Combos: a key of a combo is held back until the other keys are pressed, up to PIPELINE_COMBO_INTERVAL_TIMEOUT_MS.
+// - Tap dance hold actions: the key is held back until it's released, up to its hold_timeout.
+// - Tap dance multi-tap actions: after a release the key waits its tap_timeout for the next tap. Without hold action
+//   the key is held back until its release, however long it's held (MONKEYBOARD_LATENCY_WAITS_FOR_RELEASE).
+// Combos run before the tap dance, so the delays of a key in both add up on the worst case.
+//
+// Only the delay of the key itself is analyzed: keys typed while a tap dance key is undecided can wait for its
+// decision too, depending on its hold strategy.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pipeline_combo.h"
+#include "pipeline_tap_dance.h"
+#include "platform_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Time a key is held on a typical tap, used for the typical delay
+#ifndef MONKEYBOARD_LATENCY_TYPICAL_TAP_MS
+#define MONKEYBOARD_LATENCY_TYPICAL_TAP_MS 100
+#endif
+
+// Sources of the delay of a key
+#define MONKEYBOARD_LATENCY_COMBO             (1 << 0)
+#define MONKEYBOARD_LATENCY_HOLD              (1 << 1)
+#define MONKEYBOARD_LATENCY_MULTI_TAP         (1 << 2)
+#define MONKEYBOARD_LATENCY_WAITS_FOR_RELEASE (1 << 3) // The worst case doesn't include the time the key is held
+
+typedef struct {
+    const pipeline_combo_global_config_t* combo;         // Optional
+    const pipeline_tap_dance_global_config_t* tap_dance; // Optional
+    uint16_t typical_tap_ms;
+} monkeyboard_latency_analysis_config_t;
+
+typedef struct {
+    uint32_t typical_ms; // Delay of a single tap held typical_tap_ms
+    uint32_t worst_ms;   // Longest delay, with the key released at the worst moment before its timeouts
+    uint8_t sources;     // MONKEYBOARD_LATENCY_* flags, 0 for keys sent as soon as they are pressed
+} monkeyboard_key_latency_t;
+
+void monkeyboard_latency_analysis_config_init(monkeyboard_latency_analysis_config_t* config, const pipeline_combo_global_config_t* combo, const pipeline_tap_dance_global_config_t* tap_dance);
+
+// The keycode of the key is read from the layout (platform_layout_get_keycode_from_layer)
+monkeyboard_key_latency_t monkeyboard_latency_analysis_key(const monkeyboard_latency_analysis_config_t* config, uint8_t layer, platform_keypos_t keypos);
+
+// Worst delay of the keys of the layer. keys_with_delay (optional) gets the number of keys with any delay
+#if defined(AGNOSTIC_USE_1D_ARRAY)
+monkeyboard_key_latency_t monkeyboard_latency_analysis_layer(const monkeyboard_latency_analysis_config_t* config, uint8_t layer, uint16_t num_keys, uint16_t* keys_with_delay);
+#elif defined(AGNOSTIC_USE_2D_ARRAY)
+monkeyboard_key_latency_t monkeyboard_latency_analysis_layer(const monkeyboard_latency_analysis_config_t* config, uint8_t layer, uint8_t rows, uint8_t cols, uint16_t* keys_with_delay);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,7 +1,10 @@
 #include "monkeyboard_layer_manager.h"
 #include "monkeyboard_debug.h"
 #include "platform_interface.h"
+#include "platform_layout.h"
 #include "platform_types.h"
+#include "monkeyboard_memory.h"
+#include "monkeyboard_timeline.h"
 #include <stdint.h>
 
 #if defined(MONKEYBOARD_DEBUG)
@@ -13,54 +16,117 @@
     #define DEBUG_LAYOUT_RAW(...) ((void)0)
 #endif
 
-pipeline_tap_dance_nested_layers_t nested_layers;
+static pipeline_tap_dance_layer_info_t default_slots[MAX_NUM_NESTED_LAYERS];
+pipeline_tap_dance_nested_layers_t nested_layers = { .layer = default_slots, .capacity = MAX_NUM_NESTED_LAYERS };
 uint8_t original_layer;
+// Slot of the layer activated by each press id. An entry is only valid while its slot is in use by that press id
+static uint8_t owner_slot[UINT8_MAX + 1];
+
+// Returns the position of the highest bit set. The mask can't be 0
+static inline uint8_t highest_slot(uint32_t mask) {
+#if defined(__GNUC__)
+    return (uint8_t)(31 - __builtin_clz(mask));
+#else
+    uint8_t slot = 0;
+    while (mask >>= 1) slot++;
+    return slot;
+#endif
+}
+
+// Moves the slots in use to the lowest slots, keeping their activation order
+static void compact_slots(void) {
+    uint8_t free_slot = 0;
+    for (uint8_t slot = 0; slot < nested_layers.capacity; slot++) {
+        if (nested_layers.slot_mask & (1UL << slot)) {
+            nested_layers.layer[free_slot] = nested_layers.layer[slot];
+            owner_slot[nested_layers.layer[free_slot].press_id] = free_slot;
+            free_slot++;
+        }
+    }
+    nested_layers.slot_mask = (free_slot == 32) ? UINT32_MAX : ((1UL << free_slot) - 1);
+}
+
+// Publishes the active layers to the layout, so the transparent keys fall through them
+static void publish_layer_stack(void) {
+    uint8_t stack[NESTED_LAYERS_MAX_CAPACITY + 1];
+    uint8_t count = 0;
+    uint32_t pending = nested_layers.slot_mask;
+    while (pending != 0) {
+        uint8_t slot = highest_slot(pending);
+        pending &= ~(1UL << slot);
+        stack[count++] = nested_layers.layer[slot].layer;
+    }
+    stack[count++] = original_layer;
+    platform_layout_set_layer_stack_impl(stack, count);
+}
 
 void layout_manager_initialize_nested_layers() {
+    nested_layers.slot_mask = 0;
     nested_layers.layer_total = 0;
     original_layer = 0;
+    publish_layer_stack();
+}
+
+void layout_manager_create_nested_layers(uint8_t capacity) {
+    if (capacity > NESTED_LAYERS_MAX_CAPACITY) {
+        capacity = NESTED_LAYERS_MAX_CAPACITY;
+    }
+    if (capacity != nested_layers.capacity) {
+        if (nested_layers.layer != default_slots) {
+            monkeyboard_free(nested_layers.layer);
+        }
+        nested_layers.layer = capacity == MAX_NUM_NESTED_LAYERS ? default_slots : monkeyboard_malloc(sizeof(pipeline_tap_dance_layer_info_t) * capacity);
+        nested_layers.capacity = capacity;
+    }
+    layout_manager_initialize_nested_layers();
 }
 
 void layout_manager_add_layer(platform_keypos_t keypos, uint8_t press_id, uint8_t layer) {
     DEBUG_LAYOUT(">>>>>>>>>>>>>>>>>>> Adding layer %d for key at (%d, %d) with press ID %d", layer, keypos.row, keypos.col, press_id);
-    if (nested_layers.layer_total < MAX_NUM_NESTED_LAYERS) {
-        nested_layers.layer[nested_layers.layer_total].keypos = keypos;
-        nested_layers.layer[nested_layers.layer_total].press_id = press_id;
-        nested_layers.layer[nested_layers.layer_total].layer = layer;
+    if (nested_layers.layer_total < nested_layers.capacity) {
+        uint8_t slot = nested_layers.slot_mask == 0 ? 0 : highest_slot(nested_layers.slot_mask) + 1;
+        if (slot >= nested_layers.capacity) {
+            compact_slots();
+            slot = nested_layers.layer_total;
+        }
+        nested_layers.layer[slot].keypos = keypos;
+        nested_layers.layer[slot].press_id = press_id;
+        nested_layers.layer[slot].layer = layer;
+        nested_layers.slot_mask |= (1UL << slot);
         nested_layers.layer_total++;
+        owner_slot[press_id] = slot;
+        publish_layer_stack();
         platform_layout_set_layer(layer);
+        MONKEYBOARD_TIMELINE_EMIT_KEY(MONKEYBOARD_TIMELINE_LAYER_CHANGE, monkeyboard_get_time_32(), keypos, true, layer);
     }
 }
 
-void layout_manager_remove_layer_by_keypos(platform_keypos_t keypos) {
-    DEBUG_LAYOUT(">>>>>>>>>>>>>>>>>>> Removing layer for key at (%d, %d)", keypos.row, keypos.col);
-    for (uint8_t i = 0; i < nested_layers.layer_total; i++) {
-        if (platform_compare_keyposition(nested_layers.layer[i].keypos, keypos)) {
-            bool change_layer = false;
-            uint8_t layer_to_change;
-            if (nested_layers.layer_total == 1) {
-                change_layer = true;
-                layer_to_change = original_layer;
-            } else if (i > 0 && i == nested_layers.layer_total - 1) {
-                change_layer = true;
-                layer_to_change = nested_layers.layer[i - 1].layer;
-            }
-
-            // Shift remaining layers down
-            for (uint8_t j = i; j < nested_layers.layer_total - 1; j++) {
-                nested_layers.layer[j] = nested_layers.layer[j + 1];
-            }
-            nested_layers.layer_total--;
-            if (change_layer) {
-                platform_layout_set_layer(layer_to_change);
-            }
-            break;
-        }
+void layout_manager_remove_layer_by_press_id(uint8_t press_id) {
+    DEBUG_LAYOUT(">>>>>>>>>>>>>>>>>>> Removing layer for press ID %d", press_id);
+    uint8_t slot = owner_slot[press_id];
+    if (slot >= nested_layers.capacity || (nested_layers.slot_mask & (1UL << slot)) == 0 || nested_layers.layer[slot].press_id != press_id) {
+        return; // The press id has no layer
+    }
+    bool was_active = slot == highest_slot(nested_layers.slot_mask);
+    nested_layers.slot_mask &= ~(1UL << slot);
+    nested_layers.layer_total--;
+    publish_layer_stack();
+    // Removing a layer below the active one doesn't change the active layer
+    if (nested_layers.slot_mask == 0) {
+        platform_layout_set_layer(original_layer);
+        MONKEYBOARD_TIMELINE_EMIT_KEY(MONKEYBOARD_TIMELINE_LAYER_CHANGE, monkeyboard_get_time_32(), nested_layers.layer[slot].keypos, false, original_layer);
+    } else if (was_active) {
+        uint8_t active_layer = nested_layers.layer[highest_slot(nested_layers.slot_mask)].layer;
+        platform_layout_set_layer(active_layer);
+        MONKEYBOARD_TIMELINE_EMIT_KEY(MONKEYBOARD_TIMELINE_LAYER_CHANGE, monkeyboard_get_time_32(), nested_layers.layer[slot].keypos, false, active_layer);
     }
 }
 
 void layout_manager_set_absolute_layer(uint8_t layer) {
     original_layer = layer;
-    nested_layers.layer_total = 0; // Reset nested layers
+    nested_layers.slot_mask = 0; // Reset nested layers
+    nested_layers.layer_total = 0;
+    publish_layer_stack();
     platform_layout_set_layer(layer);
+    MONKEYBOARD_TIMELINE_EMIT(MONKEYBOARD_TIMELINE_LAYER_CHANGE, 0, 0, false, layer);
 }
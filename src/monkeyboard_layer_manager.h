@@ -3,20 +3,43 @@
 #include "platform_types.h"
 #include <stdint.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 typedef struct {
     platform_keypos_t keypos;
     uint8_t press_id;
     uint8_t layer;
 } pipeline_tap_dance_layer_info_t;
 
-#define MAX_NUM_NESTED_LAYERS 10 // Maximum number of events in the buffer
+#define MAX_NUM_NESTED_LAYERS 10 // Default number of slots
+#define NESTED_LAYERS_MAX_CAPACITY 32 // The slots must fit in the 32 bit slot mask
+
+#if MAX_NUM_NESTED_LAYERS > NESTED_LAYERS_MAX_CAPACITY
+#error "MAX_NUM_NESTED_LAYERS must fit in the 32 bit slot mask"
+#endif
 
+// The nested layers are stored on slots ordered by activation: a layer activated later always takes a higher slot.
+// The bit of a slot is set on slot_mask while the slot is in use, so the active layer is the one on the highest bit
+// and removing a layer only clears its bit. The slots are compacted only when the highest slot is in use.
+// The owner table gives the slot of the layer each press id activated, so the removal doesn't search the slots.
 typedef struct {
-    pipeline_tap_dance_layer_info_t layer[MAX_NUM_NESTED_LAYERS];
+    pipeline_tap_dance_layer_info_t* layer; // Owner of each slot
+    uint32_t slot_mask;
     uint8_t layer_total;
+    uint8_t capacity;
 } pipeline_tap_dance_nested_layers_t;
 
 void layout_manager_initialize_nested_layers(void);
+// Sets the number of slots (up to NESTED_LAYERS_MAX_CAPACITY) and initializes the nested layers. The default
+// capacity uses static slots, any other is allocated
+void layout_manager_create_nested_layers(uint8_t capacity);
 void layout_manager_add_layer(platform_keypos_t keypos, uint8_t press_id, uint8_t layer);
-void layout_manager_remove_layer_by_keypos(platform_keypos_t keypos);
+// Removes the layer activated by the press id
+void layout_manager_remove_layer_by_press_id(uint8_t press_id);
 void layout_manager_set_absolute_layer(uint8_t layer);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,106 @@
+#include "monkeyboard_memory.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_ALIGNMENT _Alignof(max_align_t)
+
+#if defined(MONKEYBOARD_STATIC_ARENA) && defined(MONKEYBOARD_STATIC_ARENA_SIZE)
+static _Alignas(max_align_t) uint8_t builtin_arena[MONKEYBOARD_STATIC_ARENA_SIZE];
+#define BUILTIN_ARENA builtin_arena
+#define BUILTIN_ARENA_SIZE MONKEYBOARD_STATIC_ARENA_SIZE
+#else
+#define BUILTIN_ARENA NULL
+#define BUILTIN_ARENA_SIZE 0
+#endif
+
+static uint8_t* arena = BUILTIN_ARENA;
+static size_t arena_size = BUILTIN_ARENA_SIZE;
+static size_t arena_used = 0;
+static size_t arena_high_water_mark = 0;
+
+static void default_exhausted_handler(size_t requested) {
+    abort();
+}
+
+static monkeyboard_memory_exhausted_handler_t exhausted_handler = default_exhausted_handler;
+
+void* monkeyboard_malloc(size_t size) {
+#if !defined(MONKEYBOARD_STATIC_ARENA)
+    if (arena == NULL) {
+        return malloc(size);
+    }
+#endif
+    // The alignment padding is computed on the address, the arena buffer might be less aligned than max_align_t
+    uintptr_t address = (uintptr_t)arena + arena_used;
+    size_t padding = (ARENA_ALIGNMENT - address % ARENA_ALIGNMENT) % ARENA_ALIGNMENT;
+    if (arena == NULL || size > arena_size - arena_used || padding > arena_size - arena_used - size) {
+        exhausted_handler(size);
+        return NULL;
+    }
+    void* ptr = arena + arena_used + padding;
+    arena_used += padding + size;
+    if (arena_used > arena_high_water_mark) {
+        arena_high_water_mark = arena_used;
+    }
+    return ptr;
+}
+
+// Arena allocations are only released all at once with monkeyboard_memory_reset_arena
+void monkeyboard_free(void* ptr) {
+#if !defined(MONKEYBOARD_STATIC_ARENA)
+    if (arena == NULL) {
+        free(ptr);
+    }
+#endif
+}
+
+void monkeyboard_memory_set_arena(void* buffer, size_t size) {
+    if (buffer == NULL) {
+        arena = BUILTIN_ARENA;
+        arena_size = BUILTIN_ARENA_SIZE;
+    } else {
+        arena = (uint8_t*)buffer;
+        arena_size = size;
+    }
+    arena_used = 0;
+    arena_high_water_mark = 0;
+}
+
+void monkeyboard_memory_reset_arena(void) {
+    arena_used = 0;
+}
+
+size_t monkeyboard_memory_arena_used(void) {
+    return arena_used;
+}
+
+size_t monkeyboard_memory_arena_high_water_mark(void) {
+    return arena_high_water_mark;
+}
+
+uint8_t monkeyboard_memory_grown_capacity(uint8_t capacity) {
+    if (capacity == 0) {
+        return 1;
+    }
+    return capacity >= UINT8_MAX / 2 ? UINT8_MAX : (uint8_t)(capacity * 2);
+}
+
+void* monkeyboard_memory_grow(void* storage, size_t used_size, size_t new_size, bool release) {
+    void* grown = monkeyboard_malloc(new_size);
+    if (grown == NULL) {
+        return NULL;
+    }
+    if (used_size > 0) {
+        memcpy(grown, storage, used_size);
+    }
+    if (release) {
+        monkeyboard_free(storage);
+    }
+    return grown;
+}
+
+void monkeyboard_memory_set_exhausted_handler(monkeyboard_memory_exhausted_handler_t handler) {
+    exhausted_handler = handler ? handler : default_exhausted_handler;
+}
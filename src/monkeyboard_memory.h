@@ -0,0 +1,61 @@
+// Memory allocation of the engine.
+//
+// Every object of the engine (buffers, executor, pipelines, layout, initializers) is allocated with
+// monkeyboard_malloc and lives as long as the firmware, so the allocations can come from a bump arena
+// provided by the caller instead of the heap:
+// - By default objects are allocated with malloc, until an arena is set with monkeyboard_memory_set_arena.
+// - With MONKEYBOARD_STATIC_ARENA defined malloc is never used. Every allocation comes from the arena, and
+//   MONKEYBOARD_STATIC_ARENA_SIZE (if defined) sets the size of a built-in arena used when none is set.
+//
+// When the arena is exhausted the exhausted handler is called (abort by default) and the allocation
+// returns NULL. The high-water mark reports the maximum number of arena bytes used, to size the arena.
+//
+// The arena has to be set before anything is initialized: objects allocated from one arena must not be
+// released after switching to another arena or back to malloc.
+//
+// The buffers of the engine (key events, presses, virtual events, deferred callbacks) get their capacity when they
+// are created. Buffers created as growable double their capacity when they are full, up to 255 elements. Growing
+// is only available on host builds: with MONKEYBOARD_STATIC_ARENA the capacities are fixed.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if !defined(MONKEYBOARD_STATIC_ARENA)
+#define MONKEYBOARD_GROWABLE_BUFFERS
+#endif
+
+typedef void (*monkeyboard_memory_exhausted_handler_t)(size_t requested);
+
+void* monkeyboard_malloc(size_t size);
+void monkeyboard_free(void* ptr);
+
+// Allocations are served from the buffer, aligned for any object type. A NULL buffer goes back to malloc
+// (or to the built-in arena with MONKEYBOARD_STATIC_ARENA)
+void monkeyboard_memory_set_arena(void* buffer, size_t size);
+// Releases every allocation of the arena at once. Every object allocated from it has to be created again
+void monkeyboard_memory_reset_arena(void);
+
+size_t monkeyboard_memory_arena_used(void);
+size_t monkeyboard_memory_arena_high_water_mark(void);
+
+// Capacity of a full growable buffer: the double of the current one, up to UINT8_MAX. Returns the same capacity
+// when the buffer can't grow any more
+uint8_t monkeyboard_memory_grown_capacity(uint8_t capacity);
+// Moves the first used_size bytes of storage to a new allocation of new_size bytes. The old storage is released
+// when release is true (it is false for storage allocated together with its buffer). Returns NULL when the new
+// storage can't be allocated, the old storage is kept
+void* monkeyboard_memory_grow(void* storage, size_t used_size, size_t new_size, bool release);
+
+// Called when the arena can't serve an allocation. NULL restores the default handler (abort)
+void monkeyboard_memory_set_exhausted_handler(monkeyboard_memory_exhausted_handler_t handler);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,38 @@
+#include "monkeyboard_output_action.h"
+#include "platform_interface.h"
+#include "platform_types.h"
+
+#if defined(MONKEYBOARD_EVENT_ORIGIN)
+static platform_event_origin_t current_origin;
+
+platform_event_origin_t monkeyboard_output_action_current_origin(void) {
+    return current_origin;
+}
+#endif
+
+// Executes the action on the platform
+void monkeyboard_output_action_execute(const monkeyboard_output_action_t* action) {
+#if defined(MONKEYBOARD_EVENT_ORIGIN)
+    current_origin = action->origin;
+#endif
+    switch (action->type) {
+        case MONKEYBOARD_OUTPUT_REGISTER:
+            platform_register_keycode(action->keycode);
+            break;
+        case MONKEYBOARD_OUTPUT_UNREGISTER:
+            platform_unregister_keycode(action->keycode);
+            break;
+        case MONKEYBOARD_OUTPUT_REPORT_ADD:
+            platform_add_key(action->keycode);
+            break;
+        case MONKEYBOARD_OUTPUT_REPORT_DEL:
+            platform_del_key(action->keycode);
+            break;
+        case MONKEYBOARD_OUTPUT_REPORT_SEND:
+            platform_send_report();
+            break;
+    }
+#if defined(MONKEYBOARD_EVENT_ORIGIN)
+    current_origin.press_id = 0;
+#endif
+}
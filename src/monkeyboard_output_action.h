@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "platform_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Output actions are the calls the executor makes on the platform once a key event has gone through the pipelines.
+// Recording them as data allows the output stage to be deferred (output queue) instead of being executed synchronously.
+typedef enum {
+    MONKEYBOARD_OUTPUT_REGISTER,    // platform_register_keycode
+    MONKEYBOARD_OUTPUT_UNREGISTER,  // platform_unregister_keycode
+    MONKEYBOARD_OUTPUT_REPORT_ADD,  // platform_add_key
+    MONKEYBOARD_OUTPUT_REPORT_DEL,  // platform_del_key
+    MONKEYBOARD_OUTPUT_REPORT_SEND  // platform_send_report
+} monkeyboard_output_action_type_t;
+
+typedef struct {
+    platform_keycode_t keycode; // Unused for MONKEYBOARD_OUTPUT_REPORT_SEND
+    uint8_t type;               // monkeyboard_output_action_type_t
+#if defined(MONKEYBOARD_EVENT_ORIGIN)
+    platform_event_origin_t origin; // Physical key event that caused the action
+#endif
+} monkeyboard_output_action_t;
+
+void monkeyboard_output_action_execute(const monkeyboard_output_action_t* action);
+
+#if defined(MONKEYBOARD_EVENT_ORIGIN)
+// Origin of the action being executed, so the platform can relate its output to the physical key event.
+// Only valid during the platform calls made by monkeyboard_output_action_execute
+platform_event_origin_t monkeyboard_output_action_current_origin(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,84 @@
+#include "monkeyboard_output_queue.h"
+#include "monkeyboard_output_action.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "monkeyboard_memory.h"
+
+#define OUTPUT_QUEUE_MASK (MONKEYBOARD_OUTPUT_QUEUE_MAX_ELEMENTS - 1)
+
+// The head is published with release semantics after the action is written, and read with acquire semantics by the consumer
+// (and the other way around for the tail), so the action slot is never read before it is completely written.
+#define OUTPUT_QUEUE_LOAD_ACQUIRE(index) __atomic_load_n(&(index), __ATOMIC_ACQUIRE)
+#define OUTPUT_QUEUE_LOAD_RELAXED(index) __atomic_load_n(&(index), __ATOMIC_RELAXED)
+#define OUTPUT_QUEUE_STORE_RELEASE(index, value) __atomic_store_n(&(index), (value), __ATOMIC_RELEASE)
+
+monkeyboard_output_queue_t* monkeyboard_output_queue_create(void) {
+    monkeyboard_output_queue_t* queue = (monkeyboard_output_queue_t*)monkeyboard_malloc(sizeof(monkeyboard_output_queue_t));
+    if (queue == NULL) {
+        return NULL;
+    }
+    queue->head = 0;
+    queue->tail = 0;
+    queue->dropped = 0;
+    return queue;
+}
+
+// Must not be called while the consumer is draining the queue
+void monkeyboard_output_queue_reset(monkeyboard_output_queue_t* queue) {
+    if (queue == NULL) {
+        return;
+    }
+    OUTPUT_QUEUE_STORE_RELEASE(queue->head, 0);
+    OUTPUT_QUEUE_STORE_RELEASE(queue->tail, 0);
+    queue->dropped = 0;
+}
+
+bool monkeyboard_output_queue_push(monkeyboard_output_queue_t* queue, const monkeyboard_output_action_t* action) {
+    if (queue == NULL) {
+        return false;
+    }
+    uint16_t head = OUTPUT_QUEUE_LOAD_RELAXED(queue->head);
+    uint16_t tail = OUTPUT_QUEUE_LOAD_ACQUIRE(queue->tail);
+    if ((uint16_t)(head - tail) >= MONKEYBOARD_OUTPUT_QUEUE_MAX_ELEMENTS) {
+        queue->dropped++;
+        return false;
+    }
+    queue->actions[head & OUTPUT_QUEUE_MASK] = *action;
+    OUTPUT_QUEUE_STORE_RELEASE(queue->head, (uint16_t)(head + 1));
+    return true;
+}
+
+bool monkeyboard_output_queue_pop(monkeyboard_output_queue_t* queue, monkeyboard_output_action_t* action) {
+    if (queue == NULL) {
+        return false;
+    }
+    uint16_t tail = OUTPUT_QUEUE_LOAD_RELAXED(queue->tail);
+    uint16_t head = OUTPUT_QUEUE_LOAD_ACQUIRE(queue->head);
+    if (head == tail) {
+        return false;
+    }
+    *action = queue->actions[tail & OUTPUT_QUEUE_MASK];
+    OUTPUT_QUEUE_STORE_RELEASE(queue->tail, (uint16_t)(tail + 1));
+    return true;
+}
+
+// Executes up to max_actions queued actions on the platform. Returns the number of actions executed
+uint16_t monkeyboard_output_queue_drain(monkeyboard_output_queue_t* queue, uint16_t max_actions) {
+    monkeyboard_output_action_t action;
+    uint16_t executed = 0;
+    while (executed < max_actions && monkeyboard_output_queue_pop(queue, &action)) {
+        monkeyboard_output_action_execute(&action);
+        executed++;
+    }
+    return executed;
+}
+
+uint16_t monkeyboard_output_queue_count(monkeyboard_output_queue_t* queue) {
+    if (queue == NULL) {
+        return 0;
+    }
+    uint16_t tail = OUTPUT_QUEUE_LOAD_ACQUIRE(queue->tail);
+    uint16_t head = OUTPUT_QUEUE_LOAD_ACQUIRE(queue->head);
+    return (uint16_t)(head - tail);
+}
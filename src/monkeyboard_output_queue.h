@@ -0,0 +1,64 @@
+// The output queue decouples the report emission from the key processing.
+// When an output queue is set on the pipeline executor, the output actions (register, unregister, add, del and send report)
+// are not executed on the platform but recorded into the queue, so a USB or BLE stall does not block the key processing.
+// The transport task drains the queue at its own pace.
+//
+// The queue is a lock-free single producer / single consumer ring:
+// - The producer (the pipeline executor) only writes the head.
+// - The consumer (the transport task) only writes the tail.
+// Both indexes run freely and are masked on access, so the capacity must be a power of two.
+//
+// When the queue is full the action is dropped and counted, the producer never waits for the consumer. The executor
+// keeps the last MONKEYBOARD_OUTPUT_QUEUE_RELEASE_RESERVE slots for the releases: a dropped press only loses a key,
+// a dropped release leaves it stuck on the host.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "monkeyboard_output_action.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Maximum number of actions that can be queued (must be a power of two)
+#ifndef MONKEYBOARD_OUTPUT_QUEUE_MAX_ELEMENTS
+#define MONKEYBOARD_OUTPUT_QUEUE_MAX_ELEMENTS 64
+#endif
+
+#if (MONKEYBOARD_OUTPUT_QUEUE_MAX_ELEMENTS & (MONKEYBOARD_OUTPUT_QUEUE_MAX_ELEMENTS - 1)) != 0
+#error "MONKEYBOARD_OUTPUT_QUEUE_MAX_ELEMENTS must be a power of two"
+#endif
+
+// Slots only used by the releases (unregister, report del and send report)
+#ifndef MONKEYBOARD_OUTPUT_QUEUE_RELEASE_RESERVE
+#define MONKEYBOARD_OUTPUT_QUEUE_RELEASE_RESERVE 8
+#endif
+
+#if MONKEYBOARD_OUTPUT_QUEUE_RELEASE_RESERVE >= MONKEYBOARD_OUTPUT_QUEUE_MAX_ELEMENTS
+#error "MONKEYBOARD_OUTPUT_QUEUE_RELEASE_RESERVE must leave room for the presses"
+#endif
+
+typedef struct {
+    monkeyboard_output_action_t actions[MONKEYBOARD_OUTPUT_QUEUE_MAX_ELEMENTS];
+    uint16_t head;     // Next position to write. Only written by the producer
+    uint16_t tail;     // Next position to read. Only written by the consumer
+    uint32_t dropped;  // Actions dropped because the queue was full. Only written by the producer
+} monkeyboard_output_queue_t;
+
+monkeyboard_output_queue_t* monkeyboard_output_queue_create(void);
+void monkeyboard_output_queue_reset(monkeyboard_output_queue_t* queue);
+
+// Producer side
+bool monkeyboard_output_queue_push(monkeyboard_output_queue_t* queue, const monkeyboard_output_action_t* action);
+
+// Consumer side
+bool monkeyboard_output_queue_pop(monkeyboard_output_queue_t* queue, monkeyboard_output_action_t* action);
+uint16_t monkeyboard_output_queue_drain(monkeyboard_output_queue_t* queue, uint16_t max_actions);
+
+uint16_t monkeyboard_output_queue_count(monkeyboard_output_queue_t* queue);
+
+#ifdef __cplusplus
+}
+#endif
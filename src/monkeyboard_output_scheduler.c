@@ -0,0 +1,146 @@
+#include "monkeyboard_output_scheduler.h"
+#include "monkeyboard_debug.h"
+#include "monkeyboard_output_action.h"
+#include "platform_interface.h"
+#include "platform_types.h"
+#include "monkeyboard_time_manager.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "monkeyboard_memory.h"
+
+#if defined(MONKEYBOARD_DEBUG)
+    #define PREFIX_DEBUG "SCHEDULER: "
+    #define DEBUG_SCHEDULER(...) DEBUG_PRINT_PREFIX(PREFIX_DEBUG, __VA_ARGS__)
+#else
+    #define DEBUG_SCHEDULER(...) ((void)0)
+#endif
+
+static void frame_deferred_exec_callback(void* data);
+
+monkeyboard_output_scheduler_t* monkeyboard_output_scheduler_create(uint8_t interval_ms, monkeyboard_output_sink_t sink) {
+    monkeyboard_output_scheduler_t* scheduler = (monkeyboard_output_scheduler_t*)monkeyboard_malloc(sizeof(monkeyboard_output_scheduler_t));
+    if (scheduler == NULL) {
+        return NULL;
+    }
+    scheduler->interval_ms = interval_ms;
+    scheduler->sink = sink != NULL ? sink : &monkeyboard_output_action_execute;
+    scheduler->is_callback_set = false;
+    monkeyboard_output_scheduler_reset(scheduler);
+    return scheduler;
+}
+
+// Discards the pending actions
+void monkeyboard_output_scheduler_reset(monkeyboard_output_scheduler_t* scheduler) {
+    if (scheduler == NULL) {
+        return;
+    }
+    if (scheduler->is_callback_set) {
+        platform_cancel_deferred_exec(scheduler->token);
+    }
+    scheduler->first = 0;
+    scheduler->count = 0;
+    scheduler->has_sent_frame = false;
+    scheduler->is_callback_set = false;
+    scheduler->token = 0;
+    scheduler->last_frame_time = 0;
+    scheduler->overruns = 0;
+}
+
+static bool produces_report(const monkeyboard_output_action_t* action) {
+    return action->type == MONKEYBOARD_OUTPUT_REPORT_SEND ||
+           action->type == MONKEYBOARD_OUTPUT_REGISTER ||
+           action->type == MONKEYBOARD_OUTPUT_UNREGISTER;
+}
+
+// Emits the actions of the oldest frame. Returns true if a report was produced
+static bool emit_frame(monkeyboard_output_scheduler_t* scheduler) {
+    bool report_produced = false;
+    while (scheduler->count > 0 && report_produced == false) {
+        monkeyboard_output_action_t* action = &scheduler->actions[scheduler->first];
+        report_produced = produces_report(action);
+        scheduler->sink(action);
+        scheduler->first = (uint8_t)((scheduler->first + 1) % MONKEYBOARD_OUTPUT_SCHEDULER_MAX_ELEMENTS);
+        scheduler->count--;
+    }
+    if (report_produced) {
+        scheduler->has_sent_frame = true;
+        scheduler->last_frame_time = monkeyboard_get_time_32();
+    }
+    return report_produced;
+}
+
+// Returns true if the pending actions contain a complete frame
+static bool has_complete_frame(monkeyboard_output_scheduler_t* scheduler) {
+    for (uint8_t i = 0; i < scheduler->count; i++) {
+        if (produces_report(&scheduler->actions[(scheduler->first + i) % MONKEYBOARD_OUTPUT_SCHEDULER_MAX_ELEMENTS])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint32_t time_to_next_frame(monkeyboard_output_scheduler_t* scheduler) {
+    if (scheduler->has_sent_frame == false) {
+        return 0;
+    }
+    platform_time_t elapsed = calculate_time_span(scheduler->last_frame_time, monkeyboard_get_time_32());
+    return elapsed >= scheduler->interval_ms ? 0 : scheduler->interval_ms - elapsed;
+}
+
+static void schedule_next_frame(monkeyboard_output_scheduler_t* scheduler) {
+    if (scheduler->is_callback_set || has_complete_frame(scheduler) == false) {
+        return;
+    }
+    uint32_t delay = time_to_next_frame(scheduler);
+    DEBUG_SCHEDULER("Scheduling next frame in %u ms, %u actions pending", delay, scheduler->count);
+    scheduler->token = platform_defer_exec(delay, frame_deferred_exec_callback, scheduler);
+    scheduler->is_callback_set = true;
+}
+
+static void frame_deferred_exec_callback(void* data) {
+    monkeyboard_output_scheduler_t* scheduler = (monkeyboard_output_scheduler_t*)data;
+    scheduler->is_callback_set = false;
+    emit_frame(scheduler);
+    schedule_next_frame(scheduler);
+}
+
+void monkeyboard_output_scheduler_push(monkeyboard_output_scheduler_t* scheduler, const monkeyboard_output_action_t* action) {
+    if (scheduler == NULL) {
+        return;
+    }
+    if (scheduler->count >= MONKEYBOARD_OUTPUT_SCHEDULER_MAX_ELEMENTS) {
+        // Keep the order: the oldest frame goes out before its time to make room for the new action
+        DEBUG_SCHEDULER("Scheduler full, emitting the oldest frame before its time");
+        scheduler->overruns++;
+        emit_frame(scheduler);
+    }
+    scheduler->actions[(scheduler->first + scheduler->count) % MONKEYBOARD_OUTPUT_SCHEDULER_MAX_ELEMENTS] = *action;
+    scheduler->count++;
+
+    if (produces_report(action) && scheduler->is_callback_set == false && time_to_next_frame(scheduler) == 0) {
+        // The scheduler is idle and the frame is complete: there is no reason to wait
+        emit_frame(scheduler);
+    }
+    schedule_next_frame(scheduler);
+}
+
+void monkeyboard_output_scheduler_flush(monkeyboard_output_scheduler_t* scheduler) {
+    if (scheduler == NULL) {
+        return;
+    }
+    if (scheduler->is_callback_set) {
+        platform_cancel_deferred_exec(scheduler->token);
+        scheduler->is_callback_set = false;
+    }
+    while (scheduler->count > 0) {
+        emit_frame(scheduler);
+    }
+}
+
+uint8_t monkeyboard_output_scheduler_count(monkeyboard_output_scheduler_t* scheduler) {
+    if (scheduler == NULL) {
+        return 0;
+    }
+    return scheduler->count;
+}
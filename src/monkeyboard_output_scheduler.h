@@ -0,0 +1,60 @@
+// The output scheduler paces the output actions so the host never receives more than one report per poll interval.
+// Some hosts drop events sent faster than the poll interval, which breaks long macros (e.g. pipeline_key_replacer).
+//
+// The actions are grouped in frames. A frame contains the actions up to and including the first action that produces
+// a report on the host:
+// - MONKEYBOARD_OUTPUT_REPORT_SEND, preceded by any number of MONKEYBOARD_OUTPUT_REPORT_ADD/DEL actions.
+// - MONKEYBOARD_OUTPUT_REGISTER or MONKEYBOARD_OUTPUT_UNREGISTER, which send their own report.
+// One frame is emitted per interval, in order, using platform_defer_exec to wait for the next frame.
+// When the scheduler is idle the first frame is emitted immediately, so a single key press has no added latency.
+//
+// If the scheduler is full, the oldest frame is emitted immediately: the order is always kept and no action is lost.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "monkeyboard_output_action.h"
+#include "platform_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Maximum number of actions waiting for their frame
+#ifndef MONKEYBOARD_OUTPUT_SCHEDULER_MAX_ELEMENTS
+#define MONKEYBOARD_OUTPUT_SCHEDULER_MAX_ELEMENTS 32
+#endif
+
+// Common poll intervals
+#define MONKEYBOARD_OUTPUT_SCHEDULER_INTERVAL_FULL_SPEED 1 // USB full speed (1000 Hz polling)
+#define MONKEYBOARD_OUTPUT_SCHEDULER_INTERVAL_LOW_SPEED 8  // USB low speed and most hosts default (125 Hz polling)
+
+typedef void (*monkeyboard_output_sink_t)(const monkeyboard_output_action_t* action);
+
+typedef struct {
+    monkeyboard_output_action_t actions[MONKEYBOARD_OUTPUT_SCHEDULER_MAX_ELEMENTS];
+    uint8_t first;                      // Position of the oldest action
+    uint8_t count;                      // Number of actions waiting
+    uint8_t interval_ms;                // Minimum time between frames
+    bool has_sent_frame;                // A frame was emitted, last_frame_time is valid
+    bool is_callback_set;               // The next frame is scheduled
+    platform_deferred_token token;      // Token of the scheduled frame
+    platform_time_t last_frame_time;    // Time when the last frame was emitted
+    uint32_t overruns;                  // Frames emitted before their time because the scheduler was full
+    monkeyboard_output_sink_t sink;     // Where the actions are emitted
+} monkeyboard_output_scheduler_t;
+
+monkeyboard_output_scheduler_t* monkeyboard_output_scheduler_create(uint8_t interval_ms, monkeyboard_output_sink_t sink);
+void monkeyboard_output_scheduler_reset(monkeyboard_output_scheduler_t* scheduler);
+
+void monkeyboard_output_scheduler_push(monkeyboard_output_scheduler_t* scheduler, const monkeyboard_output_action_t* action);
+
+// Emits every pending action immediately, ignoring the interval
+void monkeyboard_output_scheduler_flush(monkeyboard_output_scheduler_t* scheduler);
+
+uint8_t monkeyboard_output_scheduler_count(monkeyboard_output_scheduler_t* scheduler);
+
+#ifdef __cplusplus
+}
+#endif
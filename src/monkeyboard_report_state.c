@@ -0,0 +1,164 @@
+#include "monkeyboard_report_state.h"
+#include "monkeyboard_keycodes.h"
+#include "platform_types.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "monkeyboard_memory.h"
+#include <string.h>
+
+#define IS_MODIFIER_KEYCODE(keycode) ((keycode) >= PLATFORM_KC_LEFT_CTRL && (keycode) <= PLATFORM_KC_RIGHT_GUI)
+
+monkeyboard_report_state_t* monkeyboard_report_state_create(void) {
+    monkeyboard_report_state_t* state = (monkeyboard_report_state_t*)monkeyboard_malloc(sizeof(monkeyboard_report_state_t));
+    if (state == NULL) {
+        return NULL;
+    }
+    monkeyboard_report_state_reset(state);
+    return state;
+}
+
+void monkeyboard_report_state_reset(monkeyboard_report_state_t* state) {
+    if (state == NULL) {
+        return;
+    }
+    memset(state, 0, sizeof(monkeyboard_report_state_t));
+}
+
+bool monkeyboard_report_state_is_reportable(platform_keycode_t keycode) {
+    return keycode <= MODIFIED_KEYCODE_MAX;
+}
+
+// Returns the modifier bits of the keycode, including the modifier keycodes (KC_LCTL...KC_RGUI)
+static uint8_t get_mods(platform_keycode_t keycode) {
+    uint8_t mods = (uint8_t)(keycode >> 8);
+    uint8_t basic_keycode = (uint8_t)keycode;
+    if (IS_MODIFIER_KEYCODE(basic_keycode)) {
+        mods |= (uint8_t)(1 << (basic_keycode - PLATFORM_KC_LEFT_CTRL));
+    }
+    return mods;
+}
+
+// Returns the non modifier key of the keycode, or 0 if there is none
+static uint8_t get_key(platform_keycode_t keycode) {
+    uint8_t basic_keycode = (uint8_t)keycode;
+    if (IS_MODIFIER_KEYCODE(basic_keycode)) {
+        return 0;
+    }
+    return basic_keycode;
+}
+
+static bool add_mods(monkeyboard_report_state_t* state, uint8_t mods) {
+    uint8_t previous_mods = state->mods;
+    for (uint8_t i = 0; i < 8; i++) {
+        if ((mods & (1 << i)) && state->mod_count[i] < UINT8_MAX) {
+            state->mod_count[i]++;
+            state->mods |= (uint8_t)(1 << i);
+        }
+    }
+    return previous_mods != state->mods;
+}
+
+static bool del_mods(monkeyboard_report_state_t* state, uint8_t mods) {
+    uint8_t previous_mods = state->mods;
+    for (uint8_t i = 0; i < 8; i++) {
+        if ((mods & (1 << i)) && state->mod_count[i] > 0) {
+            state->mod_count[i]--;
+            if (state->mod_count[i] == 0) {
+                state->mods &= (uint8_t)~(1 << i);
+            }
+        }
+    }
+    return previous_mods != state->mods;
+}
+
+static bool add_basic_key(monkeyboard_report_state_t* state, uint8_t key) {
+    if (monkeyboard_report_state_has_key(state, key)) {
+        return false;
+    }
+    state->nkro[key >> 3] |= (uint8_t)(1 << (key & 7));
+    // Keys beyond the sixth one are only reported on the NKRO bitmap
+    for (uint8_t i = 0; i < MONKEYBOARD_REPORT_6KRO_KEYS; i++) {
+        if (state->keys[i] == 0) {
+            state->keys[i] = key;
+            break;
+        }
+    }
+    return true;
+}
+
+static bool is_on_6kro(monkeyboard_report_state_t* state, uint8_t key) {
+    for (uint8_t i = 0; i < MONKEYBOARD_REPORT_6KRO_KEYS; i++) {
+        if (state->keys[i] == key) return true;
+    }
+    return false;
+}
+
+// Moves the lowest key only reported on the NKRO bitmap to the free 6KRO slot, so a 6KRO host sees every key held
+// while at most six are held
+static void promote_nkro_key(monkeyboard_report_state_t* state, uint8_t slot) {
+    for (uint8_t byte = 0; byte < MONKEYBOARD_REPORT_NKRO_BYTES; byte++) {
+        if (state->nkro[byte] == 0) continue;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            uint8_t key = (uint8_t)(byte * 8 + bit);
+            if ((state->nkro[byte] & (1 << bit)) && !is_on_6kro(state, key)) {
+                state->keys[slot] = key;
+                return;
+            }
+        }
+    }
+}
+
+static bool del_basic_key(monkeyboard_report_state_t* state, uint8_t key) {
+    if (!monkeyboard_report_state_has_key(state, key)) {
+        return false;
+    }
+    state->nkro[key >> 3] &= (uint8_t)~(1 << (key & 7));
+    for (uint8_t i = 0; i < MONKEYBOARD_REPORT_6KRO_KEYS; i++) {
+        if (state->keys[i] == key) {
+            state->keys[i] = 0;
+            promote_nkro_key(state, i);
+            break;
+        }
+    }
+    return true;
+}
+
+bool monkeyboard_report_state_add(monkeyboard_report_state_t* state, platform_keycode_t keycode) {
+    if (state == NULL || !monkeyboard_report_state_is_reportable(keycode)) {
+        return false;
+    }
+    bool changed = add_mods(state, get_mods(keycode));
+    uint8_t key = get_key(keycode);
+    if (key != 0) {
+        changed = add_basic_key(state, key) || changed;
+    }
+    if (changed) state->dirty = true;
+    return changed;
+}
+
+bool monkeyboard_report_state_del(monkeyboard_report_state_t* state, platform_keycode_t keycode) {
+    if (state == NULL || !monkeyboard_report_state_is_reportable(keycode)) {
+        return false;
+    }
+    bool changed = del_mods(state, get_mods(keycode));
+    uint8_t key = get_key(keycode);
+    if (key != 0) {
+        changed = del_basic_key(state, key) || changed;
+    }
+    if (changed) state->dirty = true;
+    return changed;
+}
+
+bool monkeyboard_report_state_has_key(monkeyboard_report_state_t* state, uint8_t basic_keycode) {
+    return (state->nkro[basic_keycode >> 3] & (1 << (basic_keycode & 7))) != 0;
+}
+
+bool monkeyboard_report_state_take_dirty(monkeyboard_report_state_t* state) {
+    if (state == NULL) {
+        return false;
+    }
+    bool dirty = state->dirty;
+    state->dirty = false;
+    return dirty;
+}
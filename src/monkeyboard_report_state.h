@@ -0,0 +1,51 @@
+// The report state is a model of the HID keyboard report the host currently has.
+// Adding or removing a key only marks the report as dirty when the state really changes, so the
+// report is sent once per burst of changes instead of once per action.
+//
+// The state keeps:
+// - The modifier byte. Each modifier is reference counted, so a modifier shared by several keys
+//   (e.g. LCTL(KC_A) and LCTL(KC_B)) is only released when the last key holding it is released.
+// - A 6KRO array with the first six keys pressed (boot protocol report).
+// - An NKRO bitmap with every key pressed (one bit per basic keycode).
+//
+// Only basic and modified keycodes can be represented on a HID report. Unicode and custom keycodes
+// are not handled by the report state and have to be sent to the platform as they are.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "platform_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MONKEYBOARD_REPORT_6KRO_KEYS 6
+#define MONKEYBOARD_REPORT_NKRO_BYTES 32
+
+typedef struct {
+    uint8_t mods;                                   // HID modifier byte (MONKEEB_MOD_* bits)
+    uint8_t mod_count[8];                           // Number of keys holding each modifier
+    uint8_t keys[MONKEYBOARD_REPORT_6KRO_KEYS];     // 6KRO keys. 0 means empty slot
+    uint8_t nkro[MONKEYBOARD_REPORT_NKRO_BYTES];    // NKRO bitmap, one bit per basic keycode
+    bool dirty;                                     // The state changed since the last report was sent
+} monkeyboard_report_state_t;
+
+monkeyboard_report_state_t* monkeyboard_report_state_create(void);
+void monkeyboard_report_state_reset(monkeyboard_report_state_t* state);
+
+bool monkeyboard_report_state_is_reportable(platform_keycode_t keycode);
+
+// Returns true if the report changed
+bool monkeyboard_report_state_add(monkeyboard_report_state_t* state, platform_keycode_t keycode);
+bool monkeyboard_report_state_del(monkeyboard_report_state_t* state, platform_keycode_t keycode);
+
+bool monkeyboard_report_state_has_key(monkeyboard_report_state_t* state, uint8_t basic_keycode);
+
+// Returns true if a report has to be sent, and clears the dirty flag
+bool monkeyboard_report_state_take_dirty(monkeyboard_report_state_t* state);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,47 @@
+#include "monkeyboard_timeline.h"
+#include <stddef.h>
+#include <string.h>
+#include "platform_interface.h"
+
+#if defined(MONKEYBOARD_TIMELINE)
+static monkeyboard_timeline_sink_t timeline_sink = NULL;
+static void* timeline_user_data = NULL;
+
+void monkeyboard_timeline_set_sink(monkeyboard_timeline_sink_t sink, void* user_data) {
+    timeline_sink = sink;
+    timeline_user_data = user_data;
+}
+
+bool monkeyboard_timeline_is_enabled(void) {
+    return timeline_sink != NULL;
+}
+
+void monkeyboard_timeline_emit(const monkeyboard_timeline_event_t* event) {
+    if (timeline_sink != NULL) {
+        timeline_sink(event, timeline_user_data);
+    }
+}
+
+void monkeyboard_timeline_emit_now(monkeyboard_timeline_event_type_t type, uint8_t pipeline, platform_keycode_t keycode, bool pressed, uint32_t value) {
+    monkeyboard_timeline_event_t event;
+    memset(&event, 0, sizeof(event));
+    event.type = (uint8_t)type;
+    event.time = monkeyboard_get_time_32();
+    event.pipeline = pipeline;
+    event.keycode = keycode;
+    event.pressed = pressed;
+    event.value = value;
+    monkeyboard_timeline_emit(&event);
+}
+
+void monkeyboard_timeline_emit_key(monkeyboard_timeline_event_type_t type, platform_time_t time, platform_keypos_t keypos, bool pressed, uint32_t value) {
+    monkeyboard_timeline_event_t event;
+    memset(&event, 0, sizeof(event));
+    event.type = (uint8_t)type;
+    event.time = time;
+    event.keypos = keypos;
+    event.pressed = pressed;
+    event.value = value;
+    monkeyboard_timeline_emit(&event);
+}
+#endif
@@ -0,0 +1,69 @@
+// Timeline of what the engine does with the key events, to see on a timeline viewer why it waited: the physical
+// events, the captures of each pipeline, the timers, the layer changes, the virtual events and the output actions.
+// The events are handed to the sink set with monkeyboard_timeline_set_sink as they happen; the simulator exports them
+// as a Chrome trace (tests/chrome_trace_exporter.hpp) that opens on Perfetto or chrome://tracing.
+//
+// Only emitted with MONKEYBOARD_TIMELINE, enabled by default on the unit tests; without it the emitters compile out.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "platform_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(FRAMEWORK_UNIT_TEST) && !defined(MONKEYBOARD_NO_TIMELINE) && !defined(MONKEYBOARD_TIMELINE)
+    #define MONKEYBOARD_TIMELINE
+#endif
+
+typedef enum {
+    MONKEYBOARD_TIMELINE_PHYSICAL_EVENT, // keypos, pressed. Received by pipeline_process_key
+    MONKEYBOARD_TIMELINE_CAPTURE_START,  // pipeline. The pipeline holds back the key events
+    MONKEYBOARD_TIMELINE_CAPTURE_END,    // pipeline
+    MONKEYBOARD_TIMELINE_TIMER_SCHEDULE, // pipeline, value: delay in ms
+    MONKEYBOARD_TIMELINE_TIMER_FIRE,     // pipeline
+    MONKEYBOARD_TIMELINE_TIMER_CANCEL,   // pipeline
+    MONKEYBOARD_TIMELINE_LAYER_CHANGE,   // keypos and pressed of the key changing the layer (not set on absolute layers), value: active layer
+    MONKEYBOARD_TIMELINE_VIRTUAL_EVENT,  // keycode, pressed
+    MONKEYBOARD_TIMELINE_OUTPUT          // keycode, value: monkeyboard_output_action_type_t
+} monkeyboard_timeline_event_type_t;
+
+typedef struct {
+    uint8_t type; // monkeyboard_timeline_event_type_t
+    platform_time_t time;
+    uint8_t pipeline;
+    bool pressed;
+    platform_keypos_t keypos;
+    platform_keycode_t keycode;
+    uint32_t value;
+} monkeyboard_timeline_event_t;
+
+typedef void (*monkeyboard_timeline_sink_t)(const monkeyboard_timeline_event_t* event, void* user_data);
+
+#if defined(MONKEYBOARD_TIMELINE)
+// Sets the sink receiving the events. Set to NULL to stop the timeline
+void monkeyboard_timeline_set_sink(monkeyboard_timeline_sink_t sink, void* user_data);
+bool monkeyboard_timeline_is_enabled(void);
+void monkeyboard_timeline_emit(const monkeyboard_timeline_event_t* event);
+// Emits an event at the current platform time
+void monkeyboard_timeline_emit_now(monkeyboard_timeline_event_type_t type, uint8_t pipeline, platform_keycode_t keycode, bool pressed, uint32_t value);
+// Emits an event about a key position: the physical events and the layer changes
+void monkeyboard_timeline_emit_key(monkeyboard_timeline_event_type_t type, platform_time_t time, platform_keypos_t keypos, bool pressed, uint32_t value);
+
+    #define MONKEYBOARD_TIMELINE_EMIT(type, pipeline, keycode, pressed, value) do { \
+        if (monkeyboard_timeline_is_enabled()) monkeyboard_timeline_emit_now(type, (uint8_t)(pipeline), keycode, pressed, value); \
+    } while (0)
+    #define MONKEYBOARD_TIMELINE_EMIT_KEY(type, time, keypos, pressed, value) do { \
+        if (monkeyboard_timeline_is_enabled()) monkeyboard_timeline_emit_key(type, time, keypos, pressed, value); \
+    } while (0)
+#else
+    #define MONKEYBOARD_TIMELINE_EMIT(type, pipeline, keycode, pressed, value) ((void)0)
+    #define MONKEYBOARD_TIMELINE_EMIT_KEY(type, time, keypos, pressed, value) ((void)0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
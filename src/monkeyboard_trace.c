@@ -0,0 +1,156 @@
+#include "monkeyboard_trace.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "platform_types.h"
+
+static const uint8_t trace_magic[4] = { 'M', 'K', 'T', 'R' };
+
+static size_t write_varint(uint8_t* out, uint32_t value) {
+    size_t length = 0;
+    while (value >= 0x80) {
+        out[length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[length++] = (uint8_t)value;
+    return length;
+}
+
+static bool read_varint(monkeyboard_trace_reader_t* reader, uint32_t* value) {
+    uint32_t result = 0;
+    for (uint8_t shift = 0; shift < 35; shift += 7) {
+        if (reader->position >= reader->size) {
+            return false;
+        }
+        uint8_t byte = reader->data[reader->position++];
+        result |= (uint32_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint32_t key_index(platform_keypos_t keypos, uint8_t cols) {
+#if defined(AGNOSTIC_USE_1D_ARRAY)
+    (void)cols;
+    return keypos;
+#elif defined(AGNOSTIC_USE_2D_ARRAY)
+    return (uint32_t)keypos.row * cols + keypos.col;
+#endif
+}
+
+static platform_keypos_t key_position(uint32_t index, uint8_t cols) {
+    platform_keypos_t keypos;
+#if defined(AGNOSTIC_USE_1D_ARRAY)
+    (void)cols;
+    keypos = (platform_keypos_t)index;
+#elif defined(AGNOSTIC_USE_2D_ARRAY)
+    keypos.row = (uint8_t)(index / cols);
+    keypos.col = (uint8_t)(index % cols);
+#endif
+    return keypos;
+}
+
+size_t monkeyboard_trace_write_header(uint8_t* out, uint8_t cols, platform_time_t start_time) {
+    for (uint8_t i = 0; i < sizeof(trace_magic); i++) {
+        out[i] = trace_magic[i];
+    }
+    out[4] = MONKEYBOARD_TRACE_VERSION;
+    out[5] = cols;
+    out[6] = 0;
+    out[7] = 0;
+    for (uint8_t i = 0; i < 4; i++) {
+        out[8 + i] = (uint8_t)(start_time >> (8 * i));
+    }
+    return MONKEYBOARD_TRACE_HEADER_SIZE;
+}
+
+void monkeyboard_trace_encoder_init(monkeyboard_trace_encoder_t* encoder, uint8_t cols, platform_time_t start_time) {
+    encoder->last_time = start_time;
+    encoder->cols = cols;
+}
+
+size_t monkeyboard_trace_encode_event(monkeyboard_trace_encoder_t* encoder, abskeyevent_t event, uint8_t* out) {
+    // Wraps around with the time: the decoder adds the delta with the same wrap around
+    uint32_t delta = (uint32_t)(event.time - encoder->last_time);
+    encoder->last_time = event.time;
+    size_t length = write_varint(out, delta);
+    length += write_varint(out + length, (key_index(event.keypos, encoder->cols) << 1) | (event.pressed ? 1 : 0));
+    return length;
+}
+
+bool monkeyboard_trace_reader_init(monkeyboard_trace_reader_t* reader, const uint8_t* data, size_t size) {
+    if (data == NULL || size < MONKEYBOARD_TRACE_HEADER_SIZE) {
+        return false;
+    }
+    for (uint8_t i = 0; i < sizeof(trace_magic); i++) {
+        if (data[i] != trace_magic[i]) {
+            return false;
+        }
+    }
+    if (data[4] != MONKEYBOARD_TRACE_VERSION) {
+        return false;
+    }
+#if defined(AGNOSTIC_USE_2D_ARRAY)
+    if (data[5] == 0) {
+        return false;
+    }
+#endif
+    reader->data = data;
+    reader->size = size;
+    reader->position = MONKEYBOARD_TRACE_HEADER_SIZE;
+    reader->cols = data[5];
+    reader->last_time = (platform_time_t)data[8] | ((platform_time_t)data[9] << 8) | ((platform_time_t)data[10] << 16) | ((platform_time_t)data[11] << 24);
+    return true;
+}
+
+bool monkeyboard_trace_read_event(monkeyboard_trace_reader_t* reader, abskeyevent_t* event) {
+    size_t start = reader->position;
+    uint32_t delta;
+    uint32_t key;
+    if (!read_varint(reader, &delta) || !read_varint(reader, &key)) {
+        reader->position = start;
+        return false;
+    }
+    reader->last_time += delta;
+    event->time = reader->last_time;
+    event->keypos = key_position(key >> 1, reader->cols);
+    event->pressed = (key & 1) != 0;
+    return true;
+}
+
+bool monkeyboard_trace_recorder_init(monkeyboard_trace_recorder_t* recorder, uint8_t* buffer, size_t capacity, uint8_t cols, platform_time_t start_time, monkeyboard_trace_flush_t flush, void* flush_user_data) {
+    if (buffer == NULL || capacity < MONKEYBOARD_TRACE_HEADER_SIZE + MONKEYBOARD_TRACE_MAX_RECORD_SIZE) {
+        return false;
+    }
+    recorder->buffer = buffer;
+    recorder->capacity = capacity;
+    recorder->size = monkeyboard_trace_write_header(buffer, cols, start_time);
+    monkeyboard_trace_encoder_init(&recorder->encoder, cols, start_time);
+    recorder->flush = flush;
+    recorder->flush_user_data = flush_user_data;
+    recorder->recorded_events = 0;
+    recorder->dropped_events = 0;
+    return true;
+}
+
+void monkeyboard_trace_recorder_record(monkeyboard_trace_recorder_t* recorder, abskeyevent_t event) {
+    if (recorder->capacity - recorder->size < MONKEYBOARD_TRACE_MAX_RECORD_SIZE) {
+        if (recorder->flush == NULL) {
+            recorder->dropped_events++;
+            return;
+        }
+        monkeyboard_trace_recorder_flush(recorder);
+    }
+    recorder->size += monkeyboard_trace_encode_event(&recorder->encoder, event, recorder->buffer + recorder->size);
+    recorder->recorded_events++;
+}
+
+void monkeyboard_trace_recorder_flush(monkeyboard_trace_recorder_t* recorder) {
+    if (recorder->flush != NULL && recorder->size > 0) {
+        recorder->flush(recorder->buffer, recorder->size, recorder->flush_user_data);
+        recorder->size = 0;
+    }
+}
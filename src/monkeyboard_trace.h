@@ -0,0 +1,71 @@
+// Compact binary trace of the key events received by the executor, to replay real typing sessions on the host.
+//
+// Format (little endian):
+// - Header (MONKEYBOARD_TRACE_HEADER_SIZE bytes): "MKTR", version, columns of the layout (0 for 1D layouts),
+//   two reserved bytes and the time the recording started (uint32).
+// - One record per key event: the time elapsed since the previous event (since the start for the first one) and the
+//   key index shifted left once with the press bit, both as LEB128 varints. The key index is row * columns + col on
+//   2D layouts and the key position on 1D layouts.
+// A key tapped under 128ms on a board under 64 keys takes 2 bytes per event.
+//
+// The recorder writes the records into a caller-provided buffer. When the buffer is full it is handed to the flush
+// callback (e.g. to write it to a file on the host) and reused; without flush callback the next events are dropped.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "platform_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MONKEYBOARD_TRACE_VERSION 1
+#define MONKEYBOARD_TRACE_HEADER_SIZE 12
+#define MONKEYBOARD_TRACE_MAX_RECORD_SIZE 8 // 5 bytes for the time and 3 for the key index
+
+typedef struct {
+    platform_time_t last_time;
+    uint8_t cols;
+} monkeyboard_trace_encoder_t;
+
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    size_t position;
+    platform_time_t last_time;
+    uint8_t cols;
+} monkeyboard_trace_reader_t;
+
+typedef void (*monkeyboard_trace_flush_t)(const uint8_t* data, size_t size, void* user_data);
+
+typedef struct {
+    uint8_t* buffer;
+    size_t capacity;
+    size_t size; // Bytes written in the buffer since the last flush
+    monkeyboard_trace_encoder_t encoder;
+    monkeyboard_trace_flush_t flush; // Optional
+    void* flush_user_data;
+    uint32_t recorded_events;
+    uint32_t dropped_events; // Events that didn't fit in the buffer, without flush callback
+} monkeyboard_trace_recorder_t;
+
+// Encoding
+size_t monkeyboard_trace_write_header(uint8_t* out, uint8_t cols, platform_time_t start_time);
+void monkeyboard_trace_encoder_init(monkeyboard_trace_encoder_t* encoder, uint8_t cols, platform_time_t start_time);
+size_t monkeyboard_trace_encode_event(monkeyboard_trace_encoder_t* encoder, abskeyevent_t event, uint8_t* out); // Returns the bytes written
+
+// Decoding. The reader doesn't copy the data, it can read a memory mapped file
+bool monkeyboard_trace_reader_init(monkeyboard_trace_reader_t* reader, const uint8_t* data, size_t size); // False on an invalid header
+bool monkeyboard_trace_read_event(monkeyboard_trace_reader_t* reader, abskeyevent_t* event); // False at the end of the trace or on a truncated record
+
+// Recording. The buffer has to hold at least the header and one record
+bool monkeyboard_trace_recorder_init(monkeyboard_trace_recorder_t* recorder, uint8_t* buffer, size_t capacity, uint8_t cols, platform_time_t start_time, monkeyboard_trace_flush_t flush, void* flush_user_data);
+void monkeyboard_trace_recorder_record(monkeyboard_trace_recorder_t* recorder, abskeyevent_t event);
+void monkeyboard_trace_recorder_flush(monkeyboard_trace_recorder_t* recorder);
+
+#ifdef __cplusplus
+}
+#endif
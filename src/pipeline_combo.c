@@ -16,7 +16,7 @@
     #define DEBUG_COMBO_RAW(...) ((void)0)
 #endif
 
-#define g_interval_timeout 50
+#define g_interval_timeout PIPELINE_COMBO_INTERVAL_TIMEOUT_MS
 
 // Lookup structure
 typedef struct {
@@ -29,7 +29,7 @@ bool is_time_pending;
 platform_time_t next_callback_timestamp;
 
 // Execute combo actions
-static void process_key_translation(pipeline_combo_key_translation_t* translation, pipeline_physical_actions_t* actions) {
+static void process_key_translation(pipeline_combo_key_translation_t* translation, const pipeline_physical_actions_t* actions) {
         if (translation->action == COMBO_KEY_ACTION_NONE) {
         }
         else if (translation->action == COMBO_KEY_ACTION_REGISTER) {
@@ -390,7 +390,7 @@ static void reset_combos_not_selected(pipeline_combo_global_config_t* global_con
     }
 }
 
-static void activate_combos(pipeline_combo_global_config_t* config, pipeline_physical_actions_t* actions) {
+static void activate_combos(pipeline_combo_global_config_t* config, const pipeline_physical_actions_t* actions) {
     // Check combos with all keys pressed are candidates to activate once the staled combos have been reset
     // Combos with all keys pressed does not need to check for them to be stale. They are in a pending state depending on other combos that when stale can make them active even if the timespan has expired, because when they were set on all keys pressed state they were under the timespan.
     // The state "all keys pressed" means that the combo depends on other combos to activate
@@ -488,7 +488,7 @@ void print_combo_status(pipeline_combo_global_config_t* global_config) {
     #define DEBUG_STATE() ((void)0)
 #endif
 
-void pipeline_combo_callback_process_data(pipeline_physical_callback_params_t* params, pipeline_physical_actions_t* actions, pipeline_physical_return_actions_t* return_actions, pipeline_combo_global_config_t* config) {
+void pipeline_combo_callback_process_data(pipeline_physical_callback_params_t* params, const pipeline_physical_actions_t* actions, const pipeline_physical_return_actions_t* return_actions, pipeline_combo_global_config_t* config) {
 
     DEBUG_STATE();
     if (params->callback_type == PIPELINE_CALLBACK_KEY_EVENT) {
@@ -631,7 +631,7 @@ void pipeline_combo_callback_process_data(pipeline_physical_callback_params_t* p
     DEBUG_STATE();
 }
 
-void pipeline_combo_callback_process_data_executor(pipeline_physical_callback_params_t* params, pipeline_physical_actions_t* actions, pipeline_physical_return_actions_t* return_actions, void* config) {
+void pipeline_combo_callback_process_data_executor(pipeline_physical_callback_params_t* params, const pipeline_physical_actions_t* actions, const pipeline_physical_return_actions_t* return_actions, void* config) {
     pipeline_combo_callback_process_data(params, actions, return_actions, config);
 }
 
@@ -4,6 +4,11 @@
 #include "platform_types.h"
 #include <stddef.h>
 
+// Time the combo keys have to be pressed from the first one, in milliseconds
+#ifndef PIPELINE_COMBO_INTERVAL_TIMEOUT_MS
+#define PIPELINE_COMBO_INTERVAL_TIMEOUT_MS 50
+#endif
+
 typedef enum {
     COMBO_KEY_ACTION_NONE,
     COMBO_KEY_ACTION_TAP,
@@ -53,8 +58,8 @@ typedef struct {
     combo_activate_strategy_t strategy; // Combo activation strategy
 } pipeline_combo_global_config_t;
 
-void pipeline_combo_callback_process_data(pipeline_physical_callback_params_t* params, pipeline_physical_actions_t* actions, pipeline_physical_return_actions_t* return_actions, pipeline_combo_global_config_t* config);
-void pipeline_combo_callback_process_data_executor(pipeline_physical_callback_params_t* params, pipeline_physical_actions_t* actions, pipeline_physical_return_actions_t* return_actions, void* config);
+void pipeline_combo_callback_process_data(pipeline_physical_callback_params_t* params, const pipeline_physical_actions_t* actions, const pipeline_physical_return_actions_t* return_actions, pipeline_combo_global_config_t* config);
+void pipeline_combo_callback_process_data_executor(pipeline_physical_callback_params_t* params, const pipeline_physical_actions_t* actions, const pipeline_physical_return_actions_t* return_actions, void* config);
 void pipeline_combo_callback_reset(pipeline_combo_global_config_t* config);
 void pipeline_combo_callback_reset_executor(void* config);
 
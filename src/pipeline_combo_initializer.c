@@ -1,12 +1,13 @@
 #include "pipeline_combo_initializer.h"
 #include <stdint.h>
 #include <stdlib.h>
+#include "monkeyboard_memory.h"
 #include <string.h>
 #include "pipeline_combo.h"
 #include "platform_types.h"
 
 pipeline_combo_config_t* create_combo(uint8_t length, pipeline_combo_key_t** keys, pipeline_combo_key_translation_t key_on_press_combo, pipeline_combo_key_translation_t key_on_release_combo) {
-    pipeline_combo_config_t* combo = (pipeline_combo_config_t*)malloc(sizeof(*combo));
+    pipeline_combo_config_t* combo = (pipeline_combo_config_t*)monkeyboard_malloc(sizeof(*combo));
     if (!combo) return NULL;
 
     combo->keys_length = length;
@@ -20,7 +21,7 @@ pipeline_combo_config_t* create_combo(uint8_t length, pipeline_combo_key_t** key
 }
 
 pipeline_combo_key_t* create_combo_key(platform_keypos_t keypos, pipeline_combo_key_translation_t key_on_press, pipeline_combo_key_translation_t key_on_release) {
-    pipeline_combo_key_t* key = (pipeline_combo_key_t*)malloc(sizeof(*key));
+    pipeline_combo_key_t* key = (pipeline_combo_key_t*)monkeyboard_malloc(sizeof(*key));
     if (!key) return NULL;
 
     key->keypos = keypos;
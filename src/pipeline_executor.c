@@ -3,11 +3,20 @@
 #include <stdint.h>
 #include "key_virtual_buffer.h"
 #include <stdlib.h>
+#include "monkeyboard_memory.h"
 #include "key_event_buffer.h"
 #include "platform_interface.h"
 #include "platform_types.h"
 #include "monkeyboard_layer_manager.h"
 #include "monkeyboard_time_manager.h"
+#include "monkeyboard_output_action.h"
+#include "monkeyboard_output_queue.h"
+#include "monkeyboard_report_state.h"
+#include "monkeyboard_output_scheduler.h"
+#include "monkeyboard_trace.h"
+#include "monkeyboard_timeline.h"
+#include "monkeyboard_keycodes.h"
+#include <string.h>
 
 #if defined(MONKEYBOARD_DEBUG)
     #define PREFIX_DEBUG "EXECUTOR: "
@@ -45,54 +54,267 @@ static const char* timer_behavior_to_string(pipeline_executor_timer_behavior_t t
     #define DEBUG_RETURN_DATA() ((void)0)
 #endif
 
+#if defined(MONKEYBOARD_EXECUTOR_STATS)
+    #define EXECUTOR_STATS_INC(counter) (executor_stats->counter++)
+    #define EXECUTOR_STATS_HIGH_WATER(counter, value) do { if ((value) > executor_stats->counter) executor_stats->counter = (value); } while (0)
+    #define EXECUTOR_STATS_CALLBACK(counters, pipeline_index) do { if ((pipeline_index) < PIPELINE_EXECUTOR_STATS_MAX_PIPELINES) executor_stats->counters[pipeline_index]++; } while (0)
+    #define EXECUTOR_STATS_CAPTURE(was_capturing, is_capturing) do { \
+        if (!(was_capturing) && (is_capturing)) executor_stats->captures_started++; \
+        else if ((was_capturing) && !(is_capturing)) executor_stats->captures_ended++; \
+    } while (0)
+    #define EXECUTOR_STATS_REPLAY() do { executor_stats->replays++; pipeline_executor_state.replays_current_event++; } while (0)
+    #define EXECUTOR_STATS_BEGIN_EVENT() (pipeline_executor_state.replays_current_event = 0)
+    #define EXECUTOR_STATS_END_EVENT() EXECUTOR_STATS_HIGH_WATER(max_replays_per_event, pipeline_executor_state.replays_current_event)
+#else
+    #define EXECUTOR_STATS_INC(counter) ((void)0)
+    #define EXECUTOR_STATS_HIGH_WATER(counter, value) ((void)0)
+    #define EXECUTOR_STATS_CALLBACK(counters, pipeline_index) ((void)0)
+    #define EXECUTOR_STATS_CAPTURE(was_capturing, is_capturing) ((void)0)
+    #define EXECUTOR_STATS_REPLAY() ((void)0)
+    #define EXECUTOR_STATS_BEGIN_EVENT() ((void)0)
+    #define EXECUTOR_STATS_END_EVENT() ((void)0)
+#endif
+
+// Captures started or ended by a pipeline callback, on the timeline (MONKEYBOARD_TIMELINE)
+#define EXECUTOR_TIMELINE_CAPTURE(pipeline_index, was_capturing, is_capturing) do { \
+        if (!(was_capturing) && (is_capturing)) MONKEYBOARD_TIMELINE_EMIT(MONKEYBOARD_TIMELINE_CAPTURE_START, pipeline_index, 0, false, 0); \
+        else if ((was_capturing) && !(is_capturing)) MONKEYBOARD_TIMELINE_EMIT(MONKEYBOARD_TIMELINE_CAPTURE_END, pipeline_index, 0, false, 0); \
+    } while (0)
+
+#if defined(MONKEYBOARD_PIPELINE_PROFILING)
+    #define EXECUTOR_PROFILING_START() uint32_t profiling_start = platform_cycle_count()
+    #define EXECUTOR_PROFILING_END(profiles, pipeline_index) add_to_profile(executor_profiling->profiles, pipeline_index, platform_cycle_count() - profiling_start)
+#else
+    #define EXECUTOR_PROFILING_START() ((void)0)
+    #define EXECUTOR_PROFILING_END(profiles, pipeline_index) ((void)0)
+#endif
+
+#if defined(MONKEYBOARD_STATIC_PIPELINES)
+    // The header defines the pipeline lists (see pipeline_executor.h)
+    #ifndef MONKEYBOARD_STATIC_PIPELINES_HEADER
+        #define MONKEYBOARD_STATIC_PIPELINES_HEADER "monkeyboard_static_pipelines.h"
+    #endif
+    #include MONKEYBOARD_STATIC_PIPELINES_HEADER
+    // The action tables are constant, so the compiler (with LTO) can resolve and inline the actions called by the pipelines.
+    // The pipelines receive them through const pointers
+    #define PIPELINE_ACTIONS_STORAGE static const
+#else
+    #define PIPELINE_ACTIONS_STORAGE
+#endif
+
 pipeline_executor_state_t pipeline_executor_state;
 pipeline_executor_config_t *pipeline_executor_config;
-pipeline_physical_actions_t physical_actions;
-pipeline_virtual_actions_t virtual_actions;
-pipeline_physical_return_actions_t physical_return_actions;
+#if defined(MONKEYBOARD_EXECUTOR_STATS)
+// The callbacks name their state parameter pipeline_executor_state too
+static pipeline_executor_stats_t* const executor_stats = &pipeline_executor_state.stats;
+#endif
+#if defined(MONKEYBOARD_PIPELINE_PROFILING)
+static pipeline_executor_profiling_t* const executor_profiling = &pipeline_executor_state.profiling;
+
+static void add_to_profile(pipeline_executor_profile_t* profiles, uint8_t pipeline_index, uint32_t cycles) {
+    if (pipeline_index >= PIPELINE_EXECUTOR_PROFILING_MAX_PIPELINES) return;
+    pipeline_executor_profile_t* profile = &profiles[pipeline_index];
+    profile->calls++;
+    profile->total_cycles += cycles;
+    if (cycles < profile->min_cycles) profile->min_cycles = cycles;
+    if (cycles > profile->max_cycles) profile->max_cycles = cycles;
+}
+#endif
+
+static void process_virtual_event_buffer(void);
+
+// The virtual events and output actions produced from now on come from the key event (MONKEYBOARD_EVENT_ORIGIN)
+static void set_origin_from_event(const platform_key_event_t* event) {
+#if defined(MONKEYBOARD_EVENT_ORIGIN)
+    pipeline_executor_state.origin.time = event->time;
+    pipeline_executor_state.origin.press_id = event->press_id;
+#else
+    (void)event;
+#endif
+}
+
+// The pipelines act on the oldest buffered event: a pipeline holding back a key resolves it on a later event or on
+// its timeout, and the outputs it produces come from the event it held back
+static void set_origin_from_oldest_event(void) {
+    if (pipeline_executor_state.key_event_buffer->event_buffer_pos > 0) {
+        set_origin_from_event(&pipeline_executor_state.key_event_buffer->event_buffer[0]);
+    }
+}
+
+// Adds an event to the virtual event buffer. When the buffer is full, the events already on it go through the virtual
+// pipelines first, so the virtual stage streams long sequences instead of dropping events. The return data of the
+// physical pipeline being executed is kept
+static void add_virtual_event(platform_keycode_t keycode, bool is_press) {
+    platform_virtual_event_buffer_t* virtual_event_buffer = pipeline_executor_state.virtual_event_buffer;
+    bool added = is_press ? platform_virtual_event_add_press(virtual_event_buffer, keycode) : platform_virtual_event_add_release(virtual_event_buffer, keycode);
+    if (!added && virtual_event_buffer->press_buffer_pos > 0) {
+        capture_pipeline_t return_data = pipeline_executor_state.return_data;
+#if defined(MONKEYBOARD_EVENT_ORIGIN)
+        platform_event_origin_t origin = pipeline_executor_state.origin;
+#endif
+        process_virtual_event_buffer();
+        pipeline_executor_state.return_data = return_data;
+#if defined(MONKEYBOARD_EVENT_ORIGIN)
+        pipeline_executor_state.origin = origin;
+#endif
+        added = is_press ? platform_virtual_event_add_press(virtual_event_buffer, keycode) : platform_virtual_event_add_release(virtual_event_buffer, keycode);
+    }
+    if (!added) {
+        DEBUG_EXECUTOR("Error: Virtual event buffer can't hold keycode %u", keycode);
+        return;
+    }
+    EXECUTOR_STATS_HIGH_WATER(virtual_buffer_high_water, virtual_event_buffer->press_buffer_pos);
+    MONKEYBOARD_TIMELINE_EMIT(MONKEYBOARD_TIMELINE_VIRTUAL_EVENT, 0, keycode, is_press, 0);
+#if defined(MONKEYBOARD_EVENT_ORIGIN)
+    virtual_event_buffer->press_buffer[virtual_event_buffer->press_buffer_pos - 1].origin = pipeline_executor_state.origin;
+#endif
+}
 
 static void register_virtual_key(platform_keycode_t keycode) {
     pipeline_executor_state.return_data.processed = true; // Mark the key event as processed
-    platform_virtual_event_add_press(pipeline_executor_state.virtual_event_buffer, keycode);
+    add_virtual_event(keycode, true);
 }
 
 static void unregister_virtual_key(platform_keycode_t keycode) {
     pipeline_executor_state.return_data.processed = true; // Mark the key event as processed
-    platform_virtual_event_add_release(pipeline_executor_state.virtual_event_buffer, keycode);
+    add_virtual_event(keycode, false);
 }
 
 static void tap_virtual_key(platform_keycode_t keycode) {
     pipeline_executor_state.return_data.processed = true; // Mark the key event as processed
-    platform_virtual_event_add_press(pipeline_executor_state.virtual_event_buffer, keycode);
-    platform_virtual_event_add_release(pipeline_executor_state.virtual_event_buffer, keycode);
+    add_virtual_event(keycode, true);
+    add_virtual_event(keycode, false);
+}
+
+static bool is_release_output(uint8_t type) {
+    return type == MONKEYBOARD_OUTPUT_UNREGISTER || type == MONKEYBOARD_OUTPUT_REPORT_DEL || type == MONKEYBOARD_OUTPUT_REPORT_SEND;
+}
+
+// Executes the output action on the platform, or records it on the output queue when one is set. The presses leave
+// the last slots of the queue to the releases, so a full queue never leaves a key stuck on the host
+static void deliver_output(const monkeyboard_output_action_t* action) {
+    MONKEYBOARD_TIMELINE_EMIT(MONKEYBOARD_TIMELINE_OUTPUT, 0, action->keycode, false, action->type);
+    monkeyboard_output_queue_t* output_queue = pipeline_executor_state.output_queue;
+    if (output_queue != NULL) {
+        bool is_release = is_release_output(action->type);
+        uint16_t free_slots = MONKEYBOARD_OUTPUT_QUEUE_MAX_ELEMENTS - monkeyboard_output_queue_count(output_queue);
+        if (!is_release && free_slots <= MONKEYBOARD_OUTPUT_QUEUE_RELEASE_RESERVE) {
+            DEBUG_EXECUTOR("Error: Output queue is full, dropping press %d for keycode %u", action->type, action->keycode);
+            output_queue->dropped++;
+            pipeline_executor_state.overflow_stats.dropped_outputs++;
+        } else if (!monkeyboard_output_queue_push(output_queue, action)) {
+            DEBUG_EXECUTOR("Error: Output queue reserve is full, dropping release %d for keycode %u", action->type, action->keycode);
+            pipeline_executor_state.overflow_stats.dropped_releases++;
+        }
+        return;
+    }
+    monkeyboard_output_action_execute(action);
+}
+
+// Emits the output action, paced by the output scheduler when one is set
+static void emit_output(monkeyboard_output_action_type_t type, platform_keycode_t keycode) {
+    monkeyboard_output_action_t action;
+    action.keycode = keycode;
+    action.type = type;
+#if defined(MONKEYBOARD_EVENT_ORIGIN)
+    action.origin = pipeline_executor_state.origin;
+#endif
+    if (pipeline_executor_state.output_scheduler != NULL) {
+        monkeyboard_output_scheduler_push(pipeline_executor_state.output_scheduler, &action);
+        return;
+    }
+    deliver_output(&action);
+}
+
+// Applies the key to the report state and emits the changes on the report as basic keycodes, so the platform report
+// follows the report state (modifiers shared by several keys are only released with the last one).
+// Returns false if the keycode can't be represented on a report and has to be sent as it is.
+static bool apply_to_report_state(platform_keycode_t keycode, bool is_press) {
+    monkeyboard_report_state_t* report_state = pipeline_executor_state.report_state;
+    if (!monkeyboard_report_state_is_reportable(keycode)) {
+        return false;
+    }
+    uint8_t previous_mods = report_state->mods;
+    uint8_t key = (uint8_t)keycode;
+    bool had_key = monkeyboard_report_state_has_key(report_state, key);
+    bool changed = is_press ? monkeyboard_report_state_add(report_state, keycode) : monkeyboard_report_state_del(report_state, keycode);
+    if (!changed) {
+        DEBUG_EXECUTOR("Report unchanged for keycode %u", keycode);
+        return true;
+    }
+    uint8_t changed_mods = previous_mods ^ report_state->mods;
+    for (uint8_t i = 0; i < 8; i++) {
+        if (changed_mods & (1 << i)) {
+            emit_output((report_state->mods & (1 << i)) ? MONKEYBOARD_OUTPUT_REPORT_ADD : MONKEYBOARD_OUTPUT_REPORT_DEL, PLATFORM_KC_LEFT_CTRL + i);
+        }
+    }
+    bool has_key = monkeyboard_report_state_has_key(report_state, key);
+    if (had_key != has_key) {
+        emit_output(has_key ? MONKEYBOARD_OUTPUT_REPORT_ADD : MONKEYBOARD_OUTPUT_REPORT_DEL, key);
+    }
+    return true;
+}
+
+static void send_report_if_changed(void) {
+    if (monkeyboard_report_state_take_dirty(pipeline_executor_state.report_state)) {
+        emit_output(MONKEYBOARD_OUTPUT_REPORT_SEND, 0);
+    }
+}
+
+static void output_register(platform_keycode_t keycode) {
+    if (pipeline_executor_state.report_state != NULL && apply_to_report_state(keycode, true)) {
+        send_report_if_changed();
+        return;
+    }
+    emit_output(MONKEYBOARD_OUTPUT_REGISTER, keycode);
+}
+
+static void output_unregister(platform_keycode_t keycode) {
+    if (pipeline_executor_state.report_state != NULL && apply_to_report_state(keycode, false)) {
+        send_report_if_changed();
+        return;
+    }
+    emit_output(MONKEYBOARD_OUTPUT_UNREGISTER, keycode);
 }
 
 static void register_key(platform_keycode_t keycode) {
     pipeline_executor_state.return_data.processed = true; // Mark the key event as processed
-    platform_register_keycode(keycode);
+    output_register(keycode);
 }
 static void unregister_key(platform_keycode_t keycode) {
     pipeline_executor_state.return_data.processed = true; // Mark the key event as processed
-    platform_unregister_keycode(keycode);
+    output_unregister(keycode);
 }
 
 static void tap_key(platform_keycode_t keycode) {
     pipeline_executor_state.return_data.processed = true; // Mark the key event as processed
-    platform_register_keycode(keycode);
-    platform_unregister_keycode(keycode);
+    output_register(keycode);
+    output_unregister(keycode);
 }
 
 static void report_press(platform_keycode_t keycode) {
     pipeline_executor_state.return_data.processed = true; // Mark the key event as processed
-    platform_add_key(keycode);
+    if (pipeline_executor_state.report_state != NULL) {
+        if (apply_to_report_state(keycode, true)) return;
+        pipeline_executor_state.report_state->dirty = true; // The platform report changed outside the report state
+    }
+    emit_output(MONKEYBOARD_OUTPUT_REPORT_ADD, keycode);
 }
 static void report_release(platform_keycode_t keycode) {
     pipeline_executor_state.return_data.processed = true; // Mark the key event as processed
-    platform_del_key(keycode);
+    if (pipeline_executor_state.report_state != NULL) {
+        if (apply_to_report_state(keycode, false)) return;
+        pipeline_executor_state.report_state->dirty = true; // The platform report changed outside the report state
+    }
+    emit_output(MONKEYBOARD_OUTPUT_REPORT_DEL, keycode);
 }
 static void report_send(void) {
     pipeline_executor_state.return_data.processed = true; // Mark the key event as processed
-    platform_send_report();
+    if (pipeline_executor_state.report_state != NULL) {
+        send_report_if_changed();
+        return;
+    }
+    emit_output(MONKEYBOARD_OUTPUT_REPORT_SEND, 0);
 }
 
 static uint8_t get_physical_key_event_count(void) {
@@ -158,6 +380,11 @@ static void change_key_code(uint8_t pos, platform_keycode_t keycode) {
     }
 }
 
+static void change_key_codes_from_layer(uint8_t layer) {
+    pipeline_executor_state.return_data.processed = true; // Mark the key event as processed
+    platform_key_event_change_keycodes_from_layer(pipeline_executor_state.key_event_buffer, get_physical_key_event_count(), layer);
+}
+
 static void mark_as_processed(void) {
     pipeline_executor_state.return_data.processed = true; // Mark the key event as processed
 }
@@ -185,6 +412,91 @@ static void no_capture(void) {
     pipeline_executor_state.return_data.capture_key_events = false;
 }
 
+// Actions given to the pipelines. They are the same for the whole firmware, so they are filled at compile time
+PIPELINE_ACTIONS_STORAGE pipeline_physical_actions_t physical_actions = {
+    .register_key_fn = &register_virtual_key,
+    .unregister_key_fn = &unregister_virtual_key,
+    .tap_key_fn = &tap_virtual_key,
+    .get_physical_key_event_count_fn = &get_physical_key_event_count,
+    .get_physical_key_event_fn = &get_physical_key_event,
+    .remove_physical_press_fn = &remove_physical_press,
+    .remove_physical_release_fn = &remove_physical_release,
+    .remove_physical_tap_fn = &remove_physical_tap,
+    .change_key_code_fn = &change_key_code,
+    .change_key_codes_from_layer_fn = &change_key_codes_from_layer,
+    .mark_as_processed_fn = &mark_as_processed
+};
+
+PIPELINE_ACTIONS_STORAGE pipeline_virtual_actions_t virtual_actions = {
+    .register_key_fn = &register_key,
+    .unregister_key_fn = &unregister_key,
+    .tap_key_fn = &tap_key,
+    .report_press_fn = &report_press,
+    .report_release_fn = &report_release,
+    .report_send_fn = &report_send,
+    .get_virtual_key_event_count_fn = &get_virtual_key_event_count,
+    .get_virtual_key_event_fn = &get_virtual_key_event,
+    .mark_as_processed_fn = &mark_as_processed
+};
+
+PIPELINE_ACTIONS_STORAGE pipeline_physical_return_actions_t physical_return_actions = {
+    .key_capture_fn = &end_with_capture_next_keys,
+    .no_capture_fn = &no_capture
+};
+
+// Calls the pipeline at the position. With MONKEYBOARD_STATIC_PIPELINES the callbacks are the ones of the static
+// pipeline list, called directly, and only the data registered with pipeline_executor_add_*_pipeline is used
+static void call_physical_pipeline(uint8_t pipeline_index, pipeline_physical_callback_params_t* callback_params) {
+    physical_pipeline_t* pipeline = pipeline_executor_config->physical_pipelines[pipeline_index];
+#if defined(MONKEYBOARD_STATIC_PIPELINES)
+    uint8_t position = 0;
+    #define CALL_PHYSICAL_PIPELINE(callback, callback_reset) \
+        if (pipeline_index == position++) { \
+            callback(callback_params, &physical_actions, &physical_return_actions, pipeline->data); \
+            return; \
+        }
+    MONKEYBOARD_STATIC_PHYSICAL_PIPELINES(CALL_PHYSICAL_PIPELINE)
+    #undef CALL_PHYSICAL_PIPELINE
+    (void)position;
+#else
+    pipeline->callback(callback_params, &physical_actions, &physical_return_actions, pipeline->data);
+#endif
+}
+
+static void call_virtual_pipeline(uint8_t pipeline_index, pipeline_virtual_callback_params_t* callback_params) {
+    virtual_pipeline_t* pipeline = pipeline_executor_config->virtual_pipelines[pipeline_index];
+#if defined(MONKEYBOARD_STATIC_PIPELINES)
+    uint8_t position = 0;
+    #define CALL_VIRTUAL_PIPELINE(callback, callback_reset) \
+        if (pipeline_index == position++) { \
+            callback(callback_params, &virtual_actions, pipeline->data); \
+            return; \
+        }
+    MONKEYBOARD_STATIC_VIRTUAL_PIPELINES(CALL_VIRTUAL_PIPELINE)
+    #undef CALL_VIRTUAL_PIPELINE
+    (void)position;
+#else
+    pipeline->callback(callback_params, &virtual_actions, pipeline->data);
+#endif
+}
+
+static void reset_physical_pipeline(uint8_t pipeline_index) {
+    physical_pipeline_t* pipeline = pipeline_executor_config->physical_pipelines[pipeline_index];
+#if defined(MONKEYBOARD_STATIC_PIPELINES)
+    uint8_t position = 0;
+    #define RESET_PHYSICAL_PIPELINE(callback, callback_reset) \
+        if (pipeline_index == position++) { \
+            callback_reset(pipeline->data); \
+            return; \
+        }
+    MONKEYBOARD_STATIC_PHYSICAL_PIPELINES(RESET_PHYSICAL_PIPELINE)
+    #undef RESET_PHYSICAL_PIPELINE
+    (void)position;
+#else
+    pipeline->callback_reset(pipeline->data);
+#endif
+}
+
 static void reset_physical_return_data(capture_pipeline_t* return_data) {
     return_data->processed = false; // Reset processed state
     return_data->timer_behavior = PIPELINE_EXECUTOR_TIMEOUT_NONE;
@@ -198,23 +510,35 @@ static void reset_virtual_return_data(capture_pipeline_t* return_data) {
 
 static void physical_event_triggered(pipeline_executor_state_t* pipeline_executor_state, uint8_t pipeline_index, platform_key_event_t* key_event, bool is_capturing_keys, platform_time_t timespan) {
     reset_physical_return_data(&pipeline_executor_state->return_data);
+    set_origin_from_oldest_event();
 
     pipeline_physical_callback_params_t callback_params;
     callback_params.callback_type = PIPELINE_CALLBACK_KEY_EVENT;
     callback_params.key_event = key_event;
     callback_params.is_capturing_keys = is_capturing_keys;
     callback_params.timespan = timespan;
-    pipeline_executor_config->physical_pipelines[pipeline_index]->callback(&callback_params, &physical_actions, &physical_return_actions, pipeline_executor_config->physical_pipelines[pipeline_index]->data);
+    EXECUTOR_PROFILING_START();
+    call_physical_pipeline(pipeline_index, &callback_params);
+    EXECUTOR_PROFILING_END(physical_key_events, pipeline_index);
+    EXECUTOR_STATS_CALLBACK(physical_callbacks, pipeline_index);
+    EXECUTOR_STATS_CAPTURE(is_capturing_keys, pipeline_executor_state->return_data.capture_key_events);
+    EXECUTOR_TIMELINE_CAPTURE(pipeline_index, is_capturing_keys, pipeline_executor_state->return_data.capture_key_events);
 }
 
 static void physical_event_triggered_with_timer(pipeline_executor_state_t* pipeline_executor_state, uint8_t pipeline_index, bool is_capturing_keys, platform_time_t timespan) {
     reset_physical_return_data(&pipeline_executor_state->return_data);
+    set_origin_from_oldest_event();
 
     pipeline_physical_callback_params_t callback_params;
     callback_params.callback_type = PIPELINE_CALLBACK_TIMER;
     callback_params.is_capturing_keys = is_capturing_keys;
     callback_params.timespan = timespan;
-    pipeline_executor_config->physical_pipelines[pipeline_index]->callback(&callback_params, &physical_actions, &physical_return_actions, pipeline_executor_config->physical_pipelines[pipeline_index]->data);
+    EXECUTOR_PROFILING_START();
+    call_physical_pipeline(pipeline_index, &callback_params);
+    EXECUTOR_PROFILING_END(physical_timers, pipeline_index);
+    EXECUTOR_STATS_CALLBACK(physical_callbacks, pipeline_index);
+    EXECUTOR_STATS_CAPTURE(is_capturing_keys, pipeline_executor_state->return_data.capture_key_events);
+    EXECUTOR_TIMELINE_CAPTURE(pipeline_index, is_capturing_keys, pipeline_executor_state->return_data.capture_key_events);
 }
 
 static void virtual_event_triggered(pipeline_executor_state_t* pipeline_executor_state, uint8_t pipeline_index, platform_virtual_buffer_virtual_event_t* key_event) {
@@ -222,7 +546,10 @@ static void virtual_event_triggered(pipeline_executor_state_t* pipeline_executor
 
     pipeline_virtual_callback_params_t callback_params;
     callback_params.key_event = key_event;
-    pipeline_executor_config->virtual_pipelines[pipeline_index]->callback(&callback_params, &virtual_actions, pipeline_executor_config->virtual_pipelines[pipeline_index]->data);
+    EXECUTOR_PROFILING_START();
+    call_virtual_pipeline(pipeline_index, &callback_params);
+    EXECUTOR_PROFILING_END(virtual_key_events, pipeline_index);
+    EXECUTOR_STATS_CALLBACK(virtual_callbacks, pipeline_index);
 }
 
 static void process_virtual_event_buffer(void) {
@@ -231,6 +558,9 @@ static void process_virtual_event_buffer(void) {
     // Process the virtual pipelines
     for (size_t pos = 0; pos < pipeline_executor_state.virtual_event_buffer->press_buffer_pos; pos++) {
         bool processed = false;
+#if defined(MONKEYBOARD_EVENT_ORIGIN)
+        pipeline_executor_state.origin = pipeline_executor_state.virtual_event_buffer->press_buffer[pos].origin;
+#endif
         for (size_t i = 0; i < pipeline_executor_config->virtual_pipelines_length; i++) {
             virtual_event_triggered(&pipeline_executor_state, i, &pipeline_executor_state.virtual_event_buffer->press_buffer[pos]);
             last_execution = pipeline_executor_state.return_data;
@@ -239,9 +569,9 @@ static void process_virtual_event_buffer(void) {
         }
         if (processed == false) {
             if (pipeline_executor_state.virtual_event_buffer->press_buffer[pos].is_press) {
-                platform_register_keycode(pipeline_executor_state.virtual_event_buffer->press_buffer[pos].keycode);
+                output_register(pipeline_executor_state.virtual_event_buffer->press_buffer[pos].keycode);
             } else {
-                platform_unregister_keycode(pipeline_executor_state.virtual_event_buffer->press_buffer[pos].keycode);
+                output_unregister(pipeline_executor_state.virtual_event_buffer->press_buffer[pos].keycode);
             }
         }
     }
@@ -256,11 +586,8 @@ static void move_to_virtual_buffer(uint8_t position) {
             event->is_press,
             event->press_id,
             event->time);
-    if (event->is_press) {
-        platform_virtual_event_add_press(pipeline_executor_state.virtual_event_buffer, event->keycode);
-    } else {
-        platform_virtual_event_add_release(pipeline_executor_state.virtual_event_buffer, event->keycode);
-    }
+    set_origin_from_event(event);
+    add_virtual_event(event->keycode, event->is_press);
     internal_platform_key_event_remove_event(pipeline_executor_state.key_event_buffer, 0);
     // pipeline_executor_state.event_length--;
 }
@@ -332,6 +659,7 @@ static capture_pipeline_t process_key_pool(capture_pipeline_t last_execution, si
                 if (last_execution.capture_key_events == true && pipeline_executor_state.event_length - 1 < pipeline_executor_state.key_event_buffer->event_buffer_pos) {
                     // Replay the key event
                     last_execution = process_event(key_event, i, true);
+                    EXECUTOR_STATS_REPLAY();
                 }
                 pipeline_executor_state.event_length++;
                 previous_time_stamp = key_event->time;
@@ -363,17 +691,34 @@ static capture_pipeline_t process_key_pool(capture_pipeline_t last_execution, si
     return last_execution;
 }
 
-// Executes the middleware when the timer callback is triggered
-static void physical_event_deferred_exec_callback(void *cb_arg) {
-    (void)cb_arg; // Unused parameter
+static void physical_event_deferred_exec_callback(void *cb_arg);
 
-    DEBUG_EXECUTOR("=== TIMER ===");
+static void schedule_deferred_exec(platform_time_t delay) {
+    DEBUG_EXECUTOR("Scheduling deferred execution callback for time %u", delay);
+    pipeline_executor_state.deferred_exec_callback_token = platform_defer_exec(delay, physical_event_deferred_exec_callback, NULL);
+    pipeline_executor_state.is_callback_set = true; // Set the callback set flag
+    EXECUTOR_STATS_INC(timers_scheduled);
+    MONKEYBOARD_TIMELINE_EMIT(MONKEYBOARD_TIMELINE_TIMER_SCHEDULE, pipeline_executor_state.physical_pipeline_index, 0, false, delay);
+}
 
+static void cancel_deferred_exec(void) {
+    if (pipeline_executor_state.is_callback_set) {
+        DEBUG_EXECUTOR("Cancelling deferred execution callback");
+        platform_cancel_deferred_exec(pipeline_executor_state.deferred_exec_callback_token);
+        pipeline_executor_state.is_callback_set = false; // Reset the callback set flag
+        EXECUTOR_STATS_INC(timers_cancelled);
+        MONKEYBOARD_TIMELINE_EMIT(MONKEYBOARD_TIMELINE_TIMER_CANCEL, pipeline_executor_state.physical_pipeline_index, 0, false, 0);
+    }
+}
+
+// Runs the timer of the capturing pipeline at the given time, as if its timeout fired, and processes the events
+// released by the pipeline
+static void resolve_capture(platform_time_t time) {
     capture_pipeline_t last_execution = pipeline_executor_state.return_data;
 
     uint8_t pipeline_index = pipeline_executor_state.physical_pipeline_index;
 
-    physical_event_triggered_with_timer(&pipeline_executor_state, pipeline_index, last_execution.capture_key_events, monkeyboard_get_time_32());
+    physical_event_triggered_with_timer(&pipeline_executor_state, pipeline_index, last_execution.capture_key_events, time);
     last_execution = pipeline_executor_state.return_data;
 
     bool pipeline_capturing_key_events = last_execution.capture_key_events;
@@ -397,9 +742,7 @@ static void physical_event_deferred_exec_callback(void *cb_arg) {
     // last_execution = pipeline_executor_state.return_data;
 
     if (last_execution.timer_behavior == PIPELINE_EXECUTOR_TIMEOUT_NEW) {
-        DEBUG_EXECUTOR("Scheduling deferred execution callback for time %u", last_execution.callback_time);
-        pipeline_executor_state.deferred_exec_callback_token = platform_defer_exec(last_execution.callback_time, physical_event_deferred_exec_callback, NULL);
-        pipeline_executor_state.is_callback_set = true; // Set the callback set flag
+        schedule_deferred_exec(last_execution.callback_time);
     }
 
     // Process the virtual pipelines
@@ -413,6 +756,18 @@ static void physical_event_deferred_exec_callback(void *cb_arg) {
     DEBUG_PRINT_NL();
 }
 
+// Executes the middleware when the timer callback is triggered
+static void physical_event_deferred_exec_callback(void *cb_arg) {
+    (void)cb_arg; // Unused parameter
+
+    DEBUG_EXECUTOR("=== TIMER ===");
+    EXECUTOR_STATS_INC(timer_fires);
+    MONKEYBOARD_TIMELINE_EMIT(MONKEYBOARD_TIMELINE_TIMER_FIRE, pipeline_executor_state.physical_pipeline_index, 0, false, 0);
+    EXECUTOR_STATS_BEGIN_EVENT();
+    resolve_capture(monkeyboard_get_time_32());
+    EXECUTOR_STATS_END_EVENT();
+}
+
 static void process_key(void) {
     // Get the last execution state and the current key event
     capture_pipeline_t last_execution = pipeline_executor_state.return_data;
@@ -435,7 +790,9 @@ static void process_key(void) {
             if (found_previous_press == false){
                 DEBUG_EXECUTOR("Skipping release for press_id %d", key_event->press_id);
                 ignore_key_event = true;
-                platform_virtual_event_add_release(pipeline_executor_state.virtual_event_buffer, key_event->keycode);
+                EXECUTOR_STATS_INC(events_bypassed);
+                set_origin_from_event(key_event);
+                add_virtual_event(key_event->keycode, false);
                 platform_key_event_remove_physical_release_by_press_id(pipeline_executor_state.key_event_buffer, key_event->press_id);
                 //pipeline_executor_state.event_length--;
             }
@@ -454,17 +811,15 @@ static void process_key(void) {
             last_execution = process_key_pool(last_execution, 0);
         }
 
+        bool timer_was_set = pipeline_executor_state.is_callback_set;
         if (last_execution.timer_behavior == PIPELINE_EXECUTOR_TIMEOUT_NONE || last_execution.timer_behavior == PIPELINE_EXECUTOR_TIMEOUT_NEW) {
-            if (pipeline_executor_state.is_callback_set) {
-                DEBUG_EXECUTOR("Cancelling deferred execution callback");
-                platform_cancel_deferred_exec(pipeline_executor_state.deferred_exec_callback_token);
-                pipeline_executor_state.is_callback_set = false; // Reset the callback set flag
-            }
+            cancel_deferred_exec();
         }
         if (last_execution.timer_behavior == PIPELINE_EXECUTOR_TIMEOUT_NEW) {
-            DEBUG_EXECUTOR("Scheduling deferred execution callback for time %u", pipeline_executor_state.return_data.callback_time);
-            pipeline_executor_state.deferred_exec_callback_token = platform_defer_exec(pipeline_executor_state.return_data.callback_time, physical_event_deferred_exec_callback, NULL);
-            pipeline_executor_state.is_callback_set = true; // Set the callback set flag
+            schedule_deferred_exec(pipeline_executor_state.return_data.callback_time);
+            if (timer_was_set) {
+                EXECUTOR_STATS_INC(timers_rescheduled);
+            }
         }
     }
 
@@ -472,9 +827,9 @@ static void process_key(void) {
     process_virtual_event_buffer();
 }
 
-static void pipeline_executor_create_state(platform_key_event_buffer_t* event_buffer) {
+static void pipeline_executor_create_state(platform_key_event_buffer_t* event_buffer, const pipeline_executor_capacities_t* capacities) {
     pipeline_executor_state.key_event_buffer = event_buffer;
-    pipeline_executor_state.virtual_event_buffer = platform_virtual_event_create();
+    pipeline_executor_state.virtual_event_buffer = platform_virtual_event_create_with_capacity(capacities->virtual_events, capacities->growable);
     pipeline_executor_state.return_data.processed = false;
     pipeline_executor_state.return_data.timer_behavior = PIPELINE_EXECUTOR_TIMEOUT_NONE;
     pipeline_executor_state.return_data.callback_time = 0;
@@ -482,8 +837,24 @@ static void pipeline_executor_create_state(platform_key_event_buffer_t* event_bu
     pipeline_executor_state.physical_pipeline_index = 0; // Initialize the pipeline index
     pipeline_executor_state.deferred_exec_callback_token = 0; // Initialize the deferred execution callback token
     pipeline_executor_state.is_callback_set = false; // Initialize the callback set flag
+    pipeline_executor_state.output_queue = NULL; // Output actions are executed synchronously by default
+    pipeline_executor_state.report_state = NULL; // Reports are sent as requested by the pipelines by default
+    pipeline_executor_state.output_scheduler = NULL; // Output actions are not paced by default
+    pipeline_executor_state.trace_recorder = NULL; // Key events are not recorded by default
+#if defined(MONKEYBOARD_EVENT_ORIGIN)
+    pipeline_executor_state.origin.press_id = 0;
+#endif
+    pipeline_executor_state.overflow_policy = PIPELINE_EXECUTOR_OVERFLOW_RESET;
+    pipeline_executor_reset_overflow_stats();
+#if defined(MONKEYBOARD_EXECUTOR_STATS)
+    memset(&pipeline_executor_state.stats, 0, sizeof(pipeline_executor_stats_t));
+    pipeline_executor_state.replays_current_event = 0;
+#endif
+#if defined(MONKEYBOARD_PIPELINE_PROFILING)
+    pipeline_executor_reset_profiling();
+#endif
 
-    layout_manager_initialize_nested_layers();
+    layout_manager_create_nested_layers(capacities->nested_layers);
 }
 
 /**
@@ -492,6 +863,14 @@ static void pipeline_executor_create_state(platform_key_event_buffer_t* event_bu
  * This function should be called to reinitialize the pipeline executor to a clean state.
  */
 void pipeline_executor_reset_state(void) {
+    // The capture and the timer end with the reset, reported before the index of their pipeline is cleared
+    if (pipeline_executor_state.return_data.capture_key_events) {
+        EXECUTOR_STATS_INC(captures_ended);
+        MONKEYBOARD_TIMELINE_EMIT(MONKEYBOARD_TIMELINE_CAPTURE_END, pipeline_executor_state.physical_pipeline_index, 0, false, 0);
+    }
+    if (pipeline_executor_state.is_callback_set > 0) {
+        MONKEYBOARD_TIMELINE_EMIT(MONKEYBOARD_TIMELINE_TIMER_CANCEL, pipeline_executor_state.physical_pipeline_index, 0, false, 0);
+    }
     platform_key_event_reset(pipeline_executor_state.key_event_buffer);
     platform_virtual_event_reset(pipeline_executor_state.virtual_event_buffer);
     pipeline_executor_state.return_data.processed = false;
@@ -501,54 +880,113 @@ void pipeline_executor_reset_state(void) {
     pipeline_executor_state.physical_pipeline_index = 0; // Reset the pipeline index
     pipeline_executor_state.deferred_exec_callback_token = 0; // Reset the deferred execution callback token
     for (uint8_t i = 0; i < pipeline_executor_config->physical_pipelines_length; i++) {
-        physical_pipeline_t* pipeline = pipeline_executor_config->physical_pipelines[i];
-        if (pipeline) {
-            pipeline->callback_reset(pipeline->data);
+        if (pipeline_executor_config->physical_pipelines[i]) {
+            reset_physical_pipeline(i);
         }
     }
     if (pipeline_executor_state.is_callback_set > 0) {
         platform_cancel_deferred_exec(pipeline_executor_state.deferred_exec_callback_token);
     }
     pipeline_executor_state.is_callback_set = false; // Reset the callback set flag
+    // The output queue is not reset: the actions already queued belong to events that were completely processed
+}
 
+// Sets the output queue where the output actions are recorded instead of being executed on the platform.
+// The transport task is responsible for draining the queue. Set to NULL to execute the output actions synchronously.
+void pipeline_executor_set_output_queue(monkeyboard_output_queue_t* output_queue) {
+    pipeline_executor_state.output_queue = output_queue;
 }
 
-void pipeline_executor_create_config_with_event_buffer(platform_key_event_buffer_t* event_buffer, uint8_t physical_pipeline_count, uint8_t virtual_pipeline_count) {
+// Sets the report state used to build the HID report. When set, the register and report actions are applied to the
+// report state and a report is only sent when the state changes. Set to NULL to send the actions as they are.
+void pipeline_executor_set_report_state(monkeyboard_report_state_t* report_state) {
+    pipeline_executor_state.report_state = report_state;
+}
+
+// Sets the output scheduler used to pace the output actions to the host poll interval. The scheduler emits the actions
+// through the executor, so they still go to the output queue when one is set. Set to NULL to emit the actions immediately.
+void pipeline_executor_set_output_scheduler(monkeyboard_output_scheduler_t* output_scheduler) {
+    if (output_scheduler != NULL) {
+        output_scheduler->sink = &deliver_output;
+    }
+    pipeline_executor_state.output_scheduler = output_scheduler;
+}
+
+void pipeline_executor_set_trace_recorder(monkeyboard_trace_recorder_t* trace_recorder) {
+    pipeline_executor_state.trace_recorder = trace_recorder;
+}
+
+static void pipeline_executor_create_config_internal(platform_key_event_buffer_t* event_buffer, const pipeline_executor_capacities_t* capacities, uint8_t physical_pipeline_count, uint8_t virtual_pipeline_count) {
     DEBUG_PRINT_NL();
-    pipeline_executor_create_state(event_buffer);
-    pipeline_executor_config = malloc(sizeof(pipeline_executor_config_t));
+    pipeline_executor_create_state(event_buffer, capacities);
+    pipeline_executor_config = monkeyboard_malloc(sizeof(pipeline_executor_config_t));
     pipeline_executor_config->physical_pipelines_length = physical_pipeline_count;
     pipeline_executor_config->virtual_pipelines_length = virtual_pipeline_count;
-    pipeline_executor_config->physical_pipelines = malloc(sizeof(physical_pipeline_t*) * physical_pipeline_count);
-    pipeline_executor_config->virtual_pipelines = malloc(sizeof(virtual_pipeline_t*) * virtual_pipeline_count);
-
-    physical_actions.register_key_fn = &register_virtual_key;
-    physical_actions.unregister_key_fn = &unregister_virtual_key;
-    physical_actions.tap_key_fn = &tap_virtual_key;
-    physical_actions.get_physical_key_event_count_fn = &get_physical_key_event_count;
-    physical_actions.get_physical_key_event_fn = &get_physical_key_event;
-    physical_actions.remove_physical_press_fn = &remove_physical_press;
-    physical_actions.remove_physical_release_fn = &remove_physical_release;
-    physical_actions.remove_physical_tap_fn = &remove_physical_tap;
-    physical_actions.change_key_code_fn = &change_key_code;
-    physical_actions.mark_as_processed_fn = &mark_as_processed;
-
-    virtual_actions.register_key_fn = &register_key;
-    virtual_actions.unregister_key_fn = &unregister_key;
-    virtual_actions.tap_key_fn = &tap_key;
-    virtual_actions.report_press_fn = &report_press;
-    virtual_actions.report_release_fn = &report_release;
-    virtual_actions.report_send_fn = &report_send;
-    virtual_actions.get_virtual_key_event_count_fn = &get_virtual_key_event_count;
-    virtual_actions.get_virtual_key_event_fn = &get_virtual_key_event;
-    virtual_actions.mark_as_processed_fn = &mark_as_processed;
-
-    physical_return_actions.key_capture_fn = &end_with_capture_next_keys;
-    physical_return_actions.no_capture_fn = &no_capture;
+    pipeline_executor_config->physical_pipelines = monkeyboard_malloc(sizeof(physical_pipeline_t*) * physical_pipeline_count);
+    pipeline_executor_config->virtual_pipelines = monkeyboard_malloc(sizeof(virtual_pipeline_t*) * virtual_pipeline_count);
+}
+
+// Sets how a key event is handled when the event buffer is full. The default policy resets the executor
+void pipeline_executor_set_overflow_policy(pipeline_executor_overflow_policy_t overflow_policy) {
+    pipeline_executor_state.overflow_policy = overflow_policy;
+}
+
+const pipeline_executor_overflow_stats_t* pipeline_executor_get_overflow_stats(void) {
+    return &pipeline_executor_state.overflow_stats;
+}
+
+void pipeline_executor_reset_overflow_stats(void) {
+    memset(&pipeline_executor_state.overflow_stats, 0, sizeof(pipeline_executor_overflow_stats_t));
+}
+
+#if defined(MONKEYBOARD_EXECUTOR_STATS)
+const pipeline_executor_stats_t* pipeline_executor_get_stats(void) {
+    return &pipeline_executor_state.stats;
+}
+
+// The overflow resets are part of the stats, so they go back to zero too
+void pipeline_executor_reset_stats(void) {
+    memset(&pipeline_executor_state.stats, 0, sizeof(pipeline_executor_stats_t));
+    pipeline_executor_state.replays_current_event = 0;
+    pipeline_executor_reset_overflow_stats();
+}
+#endif
+
+#if defined(MONKEYBOARD_PIPELINE_PROFILING)
+const pipeline_executor_profiling_t* pipeline_executor_get_profiling(void) {
+    return &pipeline_executor_state.profiling;
+}
+
+static void reset_profiles(pipeline_executor_profile_t* profiles) {
+    for (uint8_t i = 0; i < PIPELINE_EXECUTOR_PROFILING_MAX_PIPELINES; i++) {
+        profiles[i].calls = 0;
+        profiles[i].min_cycles = UINT32_MAX;
+        profiles[i].max_cycles = 0;
+        profiles[i].total_cycles = 0;
+    }
+}
+
+void pipeline_executor_reset_profiling(void) {
+    reset_profiles(pipeline_executor_state.profiling.physical_key_events);
+    reset_profiles(pipeline_executor_state.profiling.physical_timers);
+    reset_profiles(pipeline_executor_state.profiling.virtual_key_events);
+}
+#endif
+
+// The other buffers of the executor get the default capacities
+void pipeline_executor_create_config_with_event_buffer(platform_key_event_buffer_t* event_buffer, uint8_t physical_pipeline_count, uint8_t virtual_pipeline_count) {
+    pipeline_executor_capacities_t capacities = PIPELINE_EXECUTOR_DEFAULT_CAPACITIES;
+    pipeline_executor_create_config_internal(event_buffer, &capacities, physical_pipeline_count, virtual_pipeline_count);
 }
 
 void pipeline_executor_create_config(uint8_t physical_pipeline_count, uint8_t virtual_pipeline_count) {
-    pipeline_executor_create_config_with_event_buffer(platform_key_event_create(), physical_pipeline_count, virtual_pipeline_count);
+    pipeline_executor_capacities_t capacities = PIPELINE_EXECUTOR_DEFAULT_CAPACITIES;
+    pipeline_executor_create_config_with_capacities(&capacities, physical_pipeline_count, virtual_pipeline_count);
+}
+
+void pipeline_executor_create_config_with_capacities(const pipeline_executor_capacities_t* capacities, uint8_t physical_pipeline_count, uint8_t virtual_pipeline_count) {
+    platform_key_event_buffer_t* event_buffer = platform_key_event_create_with_capacity(capacities->key_events, capacities->key_presses, capacities->growable);
+    pipeline_executor_create_config_internal(event_buffer, capacities, physical_pipeline_count, virtual_pipeline_count);
 }
 
 void pipeline_executor_add_physical_pipeline(uint8_t pipeline_position, pipeline_physical_callback callback, pipeline_callback_reset callback_reset, void* user_data) {
@@ -557,7 +995,7 @@ void pipeline_executor_add_physical_pipeline(uint8_t pipeline_position, pipeline
         return;
     }
     physical_pipeline_t* pipeline;
-    pipeline = malloc(sizeof(physical_pipeline_t));
+    pipeline = monkeyboard_malloc(sizeof(physical_pipeline_t));
     pipeline->callback = callback;
     pipeline->callback_reset = callback_reset;
     pipeline->data = user_data;
@@ -571,7 +1009,7 @@ void pipeline_executor_add_virtual_pipeline(uint8_t pipeline_position, pipeline_
         return;
     }
     virtual_pipeline_t* pipeline;
-    pipeline = malloc(sizeof(virtual_pipeline_t));
+    pipeline = monkeyboard_malloc(sizeof(virtual_pipeline_t));
     pipeline->callback = callback;
     pipeline->callback_reset = callback_reset;
     pipeline->data = user_data;
@@ -579,15 +1017,12 @@ void pipeline_executor_add_virtual_pipeline(uint8_t pipeline_position, pipeline_
     pipeline_executor_config->virtual_pipelines[pipeline_position] = pipeline;
 }
 
-void pipeline_process_key(abskeyevent_t abskeyevent) {
-    DEBUG_PRINT("=== ITERATION ===");
-
-    bool buffer_full = false;
+// Adds the key event to the event buffer. The keycode of a press is read from the current layer
+static bool add_physical_event(abskeyevent_t abskeyevent, bool* buffer_full) {
     bool event_added = false;
     if (abskeyevent.pressed) {
-        uint8_t layer = platform_layout_get_current_layer();
-        platform_keycode_t keycode = platform_layout_get_keycode_from_layer(layer, abskeyevent.keypos);
-        uint8_t press_id = platform_key_event_add_physical_press(pipeline_executor_state.key_event_buffer, abskeyevent.time, abskeyevent.keypos, keycode, &buffer_full);
+        platform_keycode_t keycode = platform_layout_get_keycode(abskeyevent.keypos);
+        uint8_t press_id = platform_key_event_add_physical_press(pipeline_executor_state.key_event_buffer, abskeyevent.time, abskeyevent.keypos, keycode, buffer_full);
         if (press_id > 0) {
             event_added = true;
         }
@@ -597,7 +1032,7 @@ void pipeline_process_key(abskeyevent_t abskeyevent) {
         //     DEBUG_BUFFERS(PREFIX_DEBUG);
         // #endif
     } else {
-        if (platform_key_event_add_physical_release(pipeline_executor_state.key_event_buffer, abskeyevent.time, abskeyevent.keypos, &buffer_full)) {
+        if (platform_key_event_add_physical_release(pipeline_executor_state.key_event_buffer, abskeyevent.time, abskeyevent.keypos, buffer_full)) {
             event_added = true;
         }
         // #ifdef MONKEYBOARD_DEBUG
@@ -607,10 +1042,89 @@ void pipeline_process_key(abskeyevent_t abskeyevent) {
         // #endif
     }
 
+    return event_added;
+}
+
+// Sends the oldest event to the virtual stage. The capturing pipeline loses the first event it captured, so it is
+// reset and the remaining events are replayed through every physical pipeline
+static void flush_oldest_event(void) {
+    if (pipeline_executor_state.return_data.capture_key_events) {
+        cancel_deferred_exec();
+        reset_physical_pipeline(pipeline_executor_state.physical_pipeline_index);
+        reset_physical_return_data(&pipeline_executor_state.return_data);
+        EXECUTOR_STATS_INC(captures_ended);
+        MONKEYBOARD_TIMELINE_EMIT(MONKEYBOARD_TIMELINE_CAPTURE_END, pipeline_executor_state.physical_pipeline_index, 0, false, 0);
+    }
+    move_to_virtual_buffer(0);
+    pipeline_executor_state.overflow_stats.flushed_events++;
+    EXECUTOR_STATS_INC(events_bypassed);
+    process_virtual_event_buffer();
+
+    pipeline_executor_state.event_length = 1;
+    capture_pipeline_t last_execution = process_key_pool(pipeline_executor_state.return_data, 0);
+    if (last_execution.timer_behavior == PIPELINE_EXECUTOR_TIMEOUT_NEW) {
+        schedule_deferred_exec(last_execution.callback_time);
+    }
+    process_virtual_event_buffer();
+}
+
+// Frees space on the full event buffer following the overflow policy.
+// Returns false if the executor was reset instead
+static bool make_room_on_overflow(platform_time_t time) {
+    platform_key_event_buffer_t* event_buffer = pipeline_executor_state.key_event_buffer;
+    switch (pipeline_executor_state.overflow_policy) {
+        case PIPELINE_EXECUTOR_OVERFLOW_FORCE_RESOLVE:
+            if (pipeline_executor_state.return_data.capture_key_events) {
+                DEBUG_EXECUTOR("Event buffer full, firing the timeout of pipeline %zu", pipeline_executor_state.physical_pipeline_index);
+                cancel_deferred_exec();
+                resolve_capture(time);
+                pipeline_executor_state.overflow_stats.forced_resolutions++;
+            }
+            // The pipeline can keep capturing after its timeout
+            while (event_buffer->event_buffer_pos > 0 && event_buffer->event_buffer_pos >= event_buffer->capacity) {
+                flush_oldest_event();
+            }
+            return true;
+        case PIPELINE_EXECUTOR_OVERFLOW_FLUSH_OLDEST:
+            DEBUG_EXECUTOR("Event buffer full, flushing the oldest event");
+            if (event_buffer->event_buffer_pos > 0) {
+                flush_oldest_event();
+            }
+            return true;
+        case PIPELINE_EXECUTOR_OVERFLOW_RESET:
+        default:
+            return false;
+    }
+}
+
+void pipeline_process_key(abskeyevent_t abskeyevent) {
+    DEBUG_PRINT("=== ITERATION ===");
+
+    if (pipeline_executor_state.trace_recorder != NULL) {
+        monkeyboard_trace_recorder_record(pipeline_executor_state.trace_recorder, abskeyevent);
+    }
+    MONKEYBOARD_TIMELINE_EMIT_KEY(MONKEYBOARD_TIMELINE_PHYSICAL_EVENT, abskeyevent.time, abskeyevent.keypos, abskeyevent.pressed, 0);
+
+    EXECUTOR_STATS_BEGIN_EVENT();
+    bool buffer_full = false;
+    bool event_added = add_physical_event(abskeyevent, &buffer_full);
+    if (!event_added && buffer_full) {
+        pipeline_executor_state.overflow_stats.overflows++;
+        if (make_room_on_overflow(abskeyevent.time)) {
+            buffer_full = false;
+            event_added = add_physical_event(abskeyevent, &buffer_full);
+        }
+    }
+
     if (event_added) {
+        EXECUTOR_STATS_INC(events_ingested);
+        EXECUTOR_STATS_HIGH_WATER(event_buffer_high_water, pipeline_executor_state.key_event_buffer->event_buffer_pos);
         process_key();
+        EXECUTOR_STATS_END_EVENT();
     } else if (buffer_full) {
         DEBUG_EXECUTOR("Error: Key event buffer is full, cannot add event");
+        pipeline_executor_state.overflow_stats.resets++;
+        pipeline_executor_state.overflow_stats.dropped_events += pipeline_executor_state.key_event_buffer->event_buffer_pos + 1;
         // Reset the global state
         pipeline_executor_reset_state();
         return;
@@ -4,6 +4,12 @@
 #include <stdint.h>
 #include "key_event_buffer.h"
 #include "key_virtual_buffer.h"
+#include "key_press_buffer.h"
+#include "monkeyboard_layer_manager.h"
+#include "monkeyboard_output_queue.h"
+#include "monkeyboard_report_state.h"
+#include "monkeyboard_output_scheduler.h"
+#include "monkeyboard_trace.h"
 #include "platform_types.h"
 
 #ifdef __cplusplus
@@ -53,6 +59,7 @@ typedef void (*key_buffer_remove_physical_press)(uint8_t press_id);
 typedef void (*key_buffer_remove_physical_release)(uint8_t press_id);
 typedef void (*key_buffer_remove_physical_tap)(uint8_t press_id);
 typedef void (*key_buffer_change_key_code)(uint8_t pos, platform_keycode_t keycode);
+typedef void (*key_buffer_change_key_codes_from_layer)(uint8_t layer);
 typedef void (*key_buffer_mark_as_processed)(void);
 
 typedef struct {
@@ -65,6 +72,7 @@ typedef struct {
     key_buffer_remove_physical_release remove_physical_release_fn;
     key_buffer_remove_physical_tap remove_physical_tap_fn;
     key_buffer_change_key_code change_key_code_fn;
+    key_buffer_change_key_codes_from_layer change_key_codes_from_layer_fn; // Resolves every event of the pipeline again from the layer
     key_buffer_mark_as_processed mark_as_processed_fn;
 } pipeline_physical_actions_t;
 
@@ -89,8 +97,8 @@ typedef struct {
     pipeline_executor_return_no_capture no_capture_fn;
 } pipeline_physical_return_actions_t;
 
-typedef void (*pipeline_physical_callback)(pipeline_physical_callback_params_t*, pipeline_physical_actions_t*, pipeline_physical_return_actions_t*, void*);
-typedef void (*pipeline_virtual_callback)(pipeline_virtual_callback_params_t*, pipeline_virtual_actions_t*, void*);
+typedef void (*pipeline_physical_callback)(pipeline_physical_callback_params_t*, const pipeline_physical_actions_t*, const pipeline_physical_return_actions_t*, void*);
+typedef void (*pipeline_virtual_callback)(pipeline_virtual_callback_params_t*, const pipeline_virtual_actions_t*, void*);
 typedef void (*pipeline_callback_reset)(void*);
 
 typedef struct {
@@ -105,6 +113,81 @@ typedef struct {
     void* data;
 } virtual_pipeline_t;
 
+// What the executor does when a key event arrives and the event buffer is full
+typedef enum {
+    PIPELINE_EXECUTOR_OVERFLOW_RESET, // Resets every buffer and pipeline. The buffered events and the new one are lost
+    PIPELINE_EXECUTOR_OVERFLOW_FORCE_RESOLVE, // Fires the timeout of the capturing pipeline, then flushes the oldest events if it keeps capturing
+    PIPELINE_EXECUTOR_OVERFLOW_FLUSH_OLDEST // Sends the oldest events to the virtual stage without going through the physical pipelines
+} pipeline_executor_overflow_policy_t;
+
+typedef struct {
+    uint32_t overflows; // Key events that found the event buffer full
+    uint32_t forced_resolutions; // Timeouts fired early to free the event buffer
+    uint32_t flushed_events; // Events sent to the virtual stage without going through the physical pipelines
+    uint32_t resets; // Executor resets due to a full event buffer
+    uint32_t dropped_events; // Events lost by the resets
+    uint32_t dropped_outputs; // Presses dropped by a full output queue, the releases use its reserve
+    uint32_t dropped_releases; // Releases dropped by the output queue, with its reserve full too
+} pipeline_executor_overflow_stats_t;
+
+// Executor statistics, to see what the executor does with the key events. Only collected with
+// MONKEYBOARD_EXECUTOR_STATS, enabled by default on the unit tests; without it the counters compile out.
+// The event buffer overflows are counted on pipeline_executor_overflow_stats_t, always collected and also cleared by
+// pipeline_executor_reset_stats
+#if defined(FRAMEWORK_UNIT_TEST) && !defined(MONKEYBOARD_NO_EXECUTOR_STATS) && !defined(MONKEYBOARD_EXECUTOR_STATS)
+    #define MONKEYBOARD_EXECUTOR_STATS
+#endif
+
+#if defined(MONKEYBOARD_EXECUTOR_STATS)
+// Pipelines with their own callback counters, the callbacks of the pipelines after them are not counted
+#ifndef PIPELINE_EXECUTOR_STATS_MAX_PIPELINES
+#define PIPELINE_EXECUTOR_STATS_MAX_PIPELINES 8
+#endif
+
+typedef struct {
+    uint32_t events_ingested; // Key events added to the event buffer
+    uint32_t events_bypassed; // Key events sent to the virtual stage without going through the physical pipelines
+    uint32_t physical_callbacks[PIPELINE_EXECUTOR_STATS_MAX_PIPELINES]; // Key event and timer callbacks, per pipeline
+    uint32_t virtual_callbacks[PIPELINE_EXECUTOR_STATS_MAX_PIPELINES];
+    uint32_t replays; // Captured key events replayed to a pipeline in process_key_pool
+    uint32_t max_replays_per_event; // Most replays caused by a single key event or timer
+    uint32_t captures_started;
+    uint32_t captures_ended;
+    uint32_t timer_fires; // Deferred timer callbacks executed
+    uint32_t timers_scheduled;
+    uint32_t timers_cancelled;
+    uint32_t timers_rescheduled; // Timers cancelled and scheduled again while processing the same key event
+    uint8_t event_buffer_high_water; // Most key events waiting on the event buffer
+    uint8_t virtual_buffer_high_water; // Most virtual events waiting on the virtual event buffer
+} pipeline_executor_stats_t;
+#endif
+
+// Pipeline profiling: cycles spent on each pipeline callback, read with platform_cycle_count. Only collected with
+// MONKEYBOARD_PIPELINE_PROFILING, enabled by default on the unit tests
+#if defined(FRAMEWORK_UNIT_TEST) && !defined(MONKEYBOARD_NO_PIPELINE_PROFILING) && !defined(MONKEYBOARD_PIPELINE_PROFILING)
+    #define MONKEYBOARD_PIPELINE_PROFILING
+#endif
+
+#if defined(MONKEYBOARD_PIPELINE_PROFILING)
+// Pipelines with their own profile, the pipelines after them are not profiled
+#ifndef PIPELINE_EXECUTOR_PROFILING_MAX_PIPELINES
+#define PIPELINE_EXECUTOR_PROFILING_MAX_PIPELINES 8
+#endif
+
+typedef struct {
+    uint32_t calls;
+    uint32_t min_cycles; // UINT32_MAX without calls
+    uint32_t max_cycles;
+    uint64_t total_cycles;
+} pipeline_executor_profile_t;
+
+typedef struct {
+    pipeline_executor_profile_t physical_key_events[PIPELINE_EXECUTOR_PROFILING_MAX_PIPELINES]; // PIPELINE_CALLBACK_KEY_EVENT
+    pipeline_executor_profile_t physical_timers[PIPELINE_EXECUTOR_PROFILING_MAX_PIPELINES]; // PIPELINE_CALLBACK_TIMER
+    pipeline_executor_profile_t virtual_key_events[PIPELINE_EXECUTOR_PROFILING_MAX_PIPELINES];
+} pipeline_executor_profiling_t;
+#endif
+
 typedef struct {
     platform_key_event_buffer_t *key_event_buffer;
     platform_virtual_event_buffer_t *virtual_event_buffer;
@@ -113,8 +196,37 @@ typedef struct {
     uint8_t event_length; // Length of the key event buffer. This length is used when the event buffer has to be replayed for the next pipeline
     platform_deferred_token deferred_exec_callback_token;
     bool is_callback_set; // Indicates if a callback is set for deferred execution
+    monkeyboard_output_queue_t* output_queue; // Optional. When set, the output actions are queued instead of executed
+    monkeyboard_report_state_t* report_state; // Optional. When set, reports are only sent when the report changes
+    monkeyboard_output_scheduler_t* output_scheduler; // Optional. When set, the output actions are paced to the host poll interval
+    monkeyboard_trace_recorder_t* trace_recorder; // Optional. When set, every key event is recorded before it is processed
+    pipeline_executor_overflow_policy_t overflow_policy;
+    pipeline_executor_overflow_stats_t overflow_stats;
+#if defined(MONKEYBOARD_EXECUTOR_STATS)
+    pipeline_executor_stats_t stats;
+    uint32_t replays_current_event; // Replays of the key event or timer being processed
+#endif
+#if defined(MONKEYBOARD_PIPELINE_PROFILING)
+    pipeline_executor_profiling_t profiling;
+#endif
+#if defined(MONKEYBOARD_EVENT_ORIGIN)
+    platform_event_origin_t origin; // Origin of the virtual events and output actions being produced
+#endif
 } pipeline_executor_state_t;
 
+// Capacities of the buffers of the executor, set when the config is created. Growable buffers double their capacity
+// when full on host builds (see monkeyboard_memory.h), the nested layers are limited to NESTED_LAYERS_MAX_CAPACITY
+typedef struct {
+    uint8_t key_events; // Physical key events waiting to be processed by the pipelines
+    uint8_t key_presses; // Keys held at the same time
+    uint8_t virtual_events; // Virtual key events produced while processing a physical key event
+    uint8_t nested_layers; // Layers activated by keys at the same time
+    bool growable;
+} pipeline_executor_capacities_t;
+
+// Positional, so it can be used from C++ too
+#define PIPELINE_EXECUTOR_DEFAULT_CAPACITIES { PLATFORM_KEY_EVENT_MAX_ELEMENTS, PLATFORM_KEY_BUFFER_MAX_ELEMENTS, PLATFORM_KEY_VIRTUAL_BUFFER_MAX_ELEMENTS, MAX_NUM_NESTED_LAYERS, false }
+
 typedef struct {
     size_t physical_pipelines_length;
     size_t virtual_pipelines_length;
@@ -124,11 +236,44 @@ typedef struct {
 
 extern pipeline_executor_config_t *pipeline_executor_config;
 
+// Static pipelines
+//
+// By default the pipelines are registered at runtime and called through their callback pointers. With
+// MONKEYBOARD_STATIC_PIPELINES defined, the pipeline list is fixed at build time: the executor includes
+// MONKEYBOARD_STATIC_PIPELINES_HEADER (default "monkeyboard_static_pipelines.h"), which defines both lists in
+// pipeline order (line continuations omitted):
+//
+//   #define MONKEYBOARD_STATIC_PHYSICAL_PIPELINES(PIPELINE)
+//       PIPELINE(pipeline_combo_callback_process_data_executor, pipeline_combo_callback_reset_executor)
+//       PIPELINE(pipeline_tap_dance_callback_process_data_executor, pipeline_tap_dance_callback_reset_executor)
+//   #define MONKEYBOARD_STATIC_VIRTUAL_PIPELINES(PIPELINE)
+//       PIPELINE(pipeline_oneshot_modifier_callback_process_data_executor, pipeline_oneshot_modifier_callback_reset_executor)
+//
+// The pipelines are called directly and the action tables are constant, so with link time optimization the
+// actions (register_key_fn, get_physical_key_event_fn...) are inlined into the pipelines. The pipelines are still
+// added with pipeline_executor_add_*_pipeline, at the same positions, to give them their data.
+
 void pipeline_executor_reset_state(void);
 void pipeline_executor_create_config_with_event_buffer(platform_key_event_buffer_t* event_buffer, uint8_t physical_pipeline_count, uint8_t virtual_pipeline_count);
 void pipeline_executor_create_config(uint8_t physical_pipeline_count, uint8_t virtual_pipeline_count);
+void pipeline_executor_create_config_with_capacities(const pipeline_executor_capacities_t* capacities, uint8_t physical_pipeline_count, uint8_t virtual_pipeline_count);
 void pipeline_executor_add_physical_pipeline(uint8_t pipeline_position, pipeline_physical_callback callback, pipeline_callback_reset callback_reset, void* user_data);
 void pipeline_executor_add_virtual_pipeline(uint8_t pipeline_position, pipeline_virtual_callback callback, pipeline_callback_reset callback_reset, void* user_data);
+void pipeline_executor_set_output_queue(monkeyboard_output_queue_t* output_queue);
+void pipeline_executor_set_report_state(monkeyboard_report_state_t* report_state);
+void pipeline_executor_set_output_scheduler(monkeyboard_output_scheduler_t* output_scheduler);
+void pipeline_executor_set_trace_recorder(monkeyboard_trace_recorder_t* trace_recorder);
+void pipeline_executor_set_overflow_policy(pipeline_executor_overflow_policy_t overflow_policy);
+const pipeline_executor_overflow_stats_t* pipeline_executor_get_overflow_stats(void);
+void pipeline_executor_reset_overflow_stats(void);
+#if defined(MONKEYBOARD_EXECUTOR_STATS)
+const pipeline_executor_stats_t* pipeline_executor_get_stats(void);
+void pipeline_executor_reset_stats(void);
+#endif
+#if defined(MONKEYBOARD_PIPELINE_PROFILING)
+const pipeline_executor_profiling_t* pipeline_executor_get_profiling(void);
+void pipeline_executor_reset_profiling(void);
+#endif
 
 void pipeline_process_key(abskeyevent_t abskeyevent);
 
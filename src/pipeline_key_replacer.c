@@ -5,7 +5,7 @@
 #include <stdint.h>
 
 
-void pipeline_key_replacer_callback_process_data(pipeline_virtual_callback_params_t* params, pipeline_virtual_actions_t* actions, pipeline_key_replacer_global_config_t* config) {
+void pipeline_key_replacer_callback_process_data(pipeline_virtual_callback_params_t* params, const pipeline_virtual_actions_t* actions, pipeline_key_replacer_global_config_t* config) {
     //platform_log_debug("pipeline_key_replacer_callback || up: %u || press: %u", params->up, params->callback_type);
     platform_virtual_buffer_virtual_event_t* key_event = params->key_event;
 
@@ -40,7 +40,7 @@ void pipeline_key_replacer_callback_process_data(pipeline_virtual_callback_param
     }
 }
 
-void pipeline_key_replacer_callback_process_data_executor(pipeline_virtual_callback_params_t* params, pipeline_virtual_actions_t* actions, void* config) {
+void pipeline_key_replacer_callback_process_data_executor(pipeline_virtual_callback_params_t* params, const pipeline_virtual_actions_t* actions, void* config) {
     pipeline_key_replacer_callback_process_data(params, actions, config);
 }
 
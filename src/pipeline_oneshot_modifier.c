@@ -1,6 +1,7 @@
 #include "pipeline_oneshot_modifier.h"
 #include <stdint.h>
 #include <stdlib.h>
+#include "monkeyboard_memory.h"
 #include "key_virtual_buffer.h"
 #include "monkeyboard_keycodes.h"
 #include "pipeline_executor.h"
@@ -8,12 +9,12 @@
 uint8_t modifier_state = 0;
 
 pipeline_oneshot_modifier_global_status_t* pipeline_oneshot_modifier_global_state_create(void) {
-    pipeline_oneshot_modifier_global_status_t* global_status = malloc(sizeof(pipeline_oneshot_modifier_global_status_t));
+    pipeline_oneshot_modifier_global_status_t* global_status = monkeyboard_malloc(sizeof(pipeline_oneshot_modifier_global_status_t));
     global_status->modifiers = 0;
     return global_status;
 }
 
-void pipeline_oneshot_modifier_callback_process_data(pipeline_virtual_callback_params_t* params, pipeline_virtual_actions_t* actions, pipeline_oneshot_modifier_global_t* config) {
+void pipeline_oneshot_modifier_callback_process_data(pipeline_virtual_callback_params_t* params, const pipeline_virtual_actions_t* actions, pipeline_oneshot_modifier_global_t* config) {
     platform_virtual_buffer_virtual_event_t* key_event = params->key_event;
 
     // platform_log_debug("pipeline_oneshot_modifier_callback || up: %u || press: %u", params->up, params->callback_type);
@@ -88,7 +89,7 @@ void pipeline_oneshot_modifier_callback_process_data(pipeline_virtual_callback_p
     }
 }
 
-void pipeline_oneshot_modifier_callback_process_data_executor(pipeline_virtual_callback_params_t* params, pipeline_virtual_actions_t* actions, void* config) {
+void pipeline_oneshot_modifier_callback_process_data_executor(pipeline_virtual_callback_params_t* params, const pipeline_virtual_actions_t* actions, void* config) {
     pipeline_oneshot_modifier_callback_process_data(params, actions, config);
 }
 
@@ -25,8 +25,8 @@ typedef struct {
 } pipeline_oneshot_modifier_global_t;
 
 pipeline_oneshot_modifier_global_status_t* pipeline_oneshot_modifier_global_state_create(void);
-void pipeline_oneshot_modifier_callback_process_data(pipeline_virtual_callback_params_t* params, pipeline_virtual_actions_t* actions, pipeline_oneshot_modifier_global_t* config);
-void pipeline_oneshot_modifier_callback_process_data_executor(pipeline_virtual_callback_params_t* params, pipeline_virtual_actions_t* actions, void* config);
+void pipeline_oneshot_modifier_callback_process_data(pipeline_virtual_callback_params_t* params, const pipeline_virtual_actions_t* actions, pipeline_oneshot_modifier_global_t* config);
+void pipeline_oneshot_modifier_callback_process_data_executor(pipeline_virtual_callback_params_t* params, const pipeline_virtual_actions_t* actions, void* config);
 void pipeline_oneshot_modifier_callback_reset(pipeline_oneshot_modifier_global_t* config);
 void pipeline_oneshot_modifier_callback_reset_executor(void* config);
 
@@ -2,6 +2,7 @@
 #include "pipeline_tap_dance.h"
 #include <stdint.h>
 #include <stdlib.h>
+#include "monkeyboard_memory.h"
 #include <string.h>
 #include "key_event_buffer.h"
 #include "pipeline_executor.h"
@@ -26,15 +27,8 @@ typedef enum {
     CAPTURE_KEYS_AND_TIMEOUT
 } capture_state_t;
 
-static void update_layer(uint8_t layer, pipeline_physical_actions_t* actions) {
-    uint8_t buffer_length = actions->get_physical_key_event_count_fn();
-    for (uint8_t i = 0; i < buffer_length; i++) {
-        platform_key_event_t* event = actions->get_physical_key_event_fn(i);
-        if (event != NULL) {
-            platform_keycode_t keycode = platform_layout_get_keycode_from_layer(layer, event->keypos);
-            actions->change_key_code_fn(i, keycode);
-        }
-    }
+static void update_layer(uint8_t layer, const pipeline_physical_actions_t* actions) {
+    actions->change_key_codes_from_layer_fn(layer);
 }
 
 // Helper functions to find actions by tap count and type
@@ -77,8 +71,8 @@ void reset_behaviour_state(pipeline_tap_dance_behaviour_status_t *status) {
 
 static void handle_interrupting_key(pipeline_tap_dance_behaviour_config_t *config,
                              pipeline_tap_dance_behaviour_status_t *status,
-                             pipeline_physical_actions_t* actions,
-                             pipeline_physical_return_actions_t* return_actions,
+                             const pipeline_physical_actions_t* actions,
+                             const pipeline_physical_return_actions_t* return_actions,
                              platform_key_event_t* last_key_event) {
 
     DEBUG_TAP_DANCE("-- Interrupting Key Event: %d, state: %d", last_key_event->keycode, status->state);
@@ -160,8 +154,8 @@ static void handle_interrupting_key(pipeline_tap_dance_behaviour_config_t *confi
 
 static void generic_key_press_handler(pipeline_tap_dance_behaviour_config_t *config,
                                pipeline_tap_dance_behaviour_status_t *status,
-                               pipeline_physical_actions_t* actions,
-                               pipeline_physical_return_actions_t* return_actions,
+                               const pipeline_physical_actions_t* actions,
+                               const pipeline_physical_return_actions_t* return_actions,
                                platform_key_event_t* last_key_event) {
     DEBUG_TAP_DANCE("Generic Key Press Handler: %d", last_key_event->keycode);
     status->tap_count++;
@@ -194,8 +188,8 @@ static void generic_key_press_handler(pipeline_tap_dance_behaviour_config_t *con
 
 static void generic_key_release_when_not_holding_handler(pipeline_tap_dance_behaviour_config_t *config,
                                                  pipeline_tap_dance_behaviour_status_t *status,
-                                                 pipeline_physical_actions_t* actions,
-                                                 pipeline_physical_return_actions_t* return_actions,
+                                                 const pipeline_physical_actions_t* actions,
+                                                 const pipeline_physical_return_actions_t* return_actions,
                                                  platform_key_event_t* last_key_event) {
     DEBUG_TAP_DANCE("Generic Key Release Handler (Not Holding): %d", last_key_event->keycode);
     if (has_subsequent_actions(config, status->tap_count)) {
@@ -229,8 +223,8 @@ static void generic_key_release_when_not_holding_handler(pipeline_tap_dance_beha
 
 static void generic_key_release_when_holding_handler(pipeline_tap_dance_behaviour_config_t *config,
                                               pipeline_tap_dance_behaviour_status_t *status,
-                                              pipeline_physical_actions_t* actions,
-                                              pipeline_physical_return_actions_t* return_actions,
+                                              const pipeline_physical_actions_t* actions,
+                                              const pipeline_physical_return_actions_t* return_actions,
                                               platform_key_event_t* last_key_event) {
     DEBUG_TAP_DANCE("Generic Key Release Handler (Holding): %d", last_key_event->keycode);
 
@@ -241,19 +235,19 @@ static void generic_key_release_when_holding_handler(pipeline_tap_dance_behaviou
     }
 
     if (hold_action->hold_strategy == TAP_DANCE_HOLD_PREFERRED) {
-        layout_manager_remove_layer_by_keypos(status->trigger_keypos);
+        layout_manager_remove_layer_by_press_id(last_key_event->press_id);
         actions->remove_physical_release_fn(last_key_event->press_id);
         reset_behaviour_state(status);
         return_actions->no_capture_fn();
         return;
     } else if (hold_action->hold_strategy == TAP_DANCE_TAP_PREFERRED) {
-        layout_manager_remove_layer_by_keypos(status->trigger_keypos);
+        layout_manager_remove_layer_by_press_id(last_key_event->press_id);
         actions->remove_physical_release_fn(last_key_event->press_id);
         reset_behaviour_state(status);
         return_actions->no_capture_fn();
         return;
     } else if (hold_action->hold_strategy == TAP_DANCE_BALANCED) {
-        layout_manager_remove_layer_by_keypos(status->trigger_keypos);
+        layout_manager_remove_layer_by_press_id(last_key_event->press_id);
         actions->remove_physical_release_fn(last_key_event->press_id);
         reset_behaviour_state(status);
         return_actions->no_capture_fn();
@@ -263,8 +257,8 @@ static void generic_key_release_when_holding_handler(pipeline_tap_dance_behaviou
 
 static void handle_key_press(pipeline_tap_dance_behaviour_config_t *config,
                      pipeline_tap_dance_behaviour_status_t *status,
-                     pipeline_physical_actions_t* actions,
-                     pipeline_physical_return_actions_t* return_actions,
+                     const pipeline_physical_actions_t* actions,
+                     const pipeline_physical_return_actions_t* return_actions,
                      platform_key_event_t* last_key_event) {
 
     DEBUG_TAP_DANCE("-- Main Key press: %d, state: %d", last_key_event->keycode, status->state);
@@ -302,8 +296,8 @@ static void handle_key_press(pipeline_tap_dance_behaviour_config_t *config,
 
 static void handle_key_release(pipeline_tap_dance_behaviour_config_t *config,
                         pipeline_tap_dance_behaviour_status_t *status,
-                        pipeline_physical_actions_t* actions,
-                        pipeline_physical_return_actions_t* return_actions,
+                        const pipeline_physical_actions_t* actions,
+                        const pipeline_physical_return_actions_t* return_actions,
                         platform_key_event_t* last_key_event) {
 
     DEBUG_TAP_DANCE("-- Main Key release: %d, state: %d", last_key_event->keycode, status->state);
@@ -332,8 +326,8 @@ static void handle_key_release(pipeline_tap_dance_behaviour_config_t *config,
 
 static void handle_timeout(pipeline_tap_dance_behaviour_config_t *config,
                     pipeline_tap_dance_behaviour_status_t *status,
-                    pipeline_physical_actions_t* actions,
-                    pipeline_physical_return_actions_t* return_actions) {
+                    const pipeline_physical_actions_t* actions,
+                    const pipeline_physical_return_actions_t* return_actions) {
 
     DEBUG_TAP_DANCE("-- Timer callback");
 
@@ -405,7 +399,7 @@ static void handle_timeout(pipeline_tap_dance_behaviour_config_t *config,
 }
 
 void pipeline_tap_dance_global_state_create(void) {
-    global_status = (pipeline_tap_dance_global_status_t*)malloc(sizeof(pipeline_tap_dance_global_status_t));
+    global_status = (pipeline_tap_dance_global_status_t*)monkeyboard_malloc(sizeof(pipeline_tap_dance_global_status_t));
     global_status->last_behaviour = 0;
 }
 
@@ -464,7 +458,7 @@ void print_tap_dance_status(pipeline_tap_dance_global_config_t* global_config) {
     #define DEBUG_STATE() ((void)0)
 #endif
 
-static void pipeline_tap_dance_process(pipeline_physical_callback_params_t* params, pipeline_physical_actions_t* actions, pipeline_physical_return_actions_t* return_actions, pipeline_tap_dance_global_config_t* global_config) {
+static void pipeline_tap_dance_process(pipeline_physical_callback_params_t* params, const pipeline_physical_actions_t* actions, const pipeline_physical_return_actions_t* return_actions, pipeline_tap_dance_global_config_t* global_config) {
     platform_key_event_t* last_key_event = params->key_event;
 
     if (params->callback_type == PIPELINE_CALLBACK_KEY_EVENT) {
@@ -529,7 +523,7 @@ static void pipeline_tap_dance_process(pipeline_physical_callback_params_t* para
     DEBUG_STATE();
 }
 
-void pipeline_tap_dance_callback_process_data(pipeline_physical_callback_params_t* params, pipeline_physical_actions_t* actions, pipeline_physical_return_actions_t* return_actions, pipeline_tap_dance_global_config_t* config) {
+void pipeline_tap_dance_callback_process_data(pipeline_physical_callback_params_t* params, const pipeline_physical_actions_t* actions, const pipeline_physical_return_actions_t* return_actions, pipeline_tap_dance_global_config_t* config) {
     if (config == NULL) {
         DEBUG_PRINT_ERROR("Tap Dance: Global config is NULL");
         return;
@@ -537,7 +531,7 @@ void pipeline_tap_dance_callback_process_data(pipeline_physical_callback_params_
     pipeline_tap_dance_process(params, actions, return_actions, config);
 }
 
-void pipeline_tap_dance_callback_process_data_executor(pipeline_physical_callback_params_t* params, pipeline_physical_actions_t* actions, pipeline_physical_return_actions_t* return_actions, void* config) {
+void pipeline_tap_dance_callback_process_data_executor(pipeline_physical_callback_params_t* params, const pipeline_physical_actions_t* actions, const pipeline_physical_return_actions_t* return_actions, void* config) {
     pipeline_tap_dance_callback_process_data(params, actions, return_actions, config);
 }
 
@@ -1,12 +1,13 @@
 #include "pipeline_tap_dance_initializer.h"
 #include <stdint.h>
 #include <stdlib.h>
+#include "monkeyboard_memory.h"
 #include <string.h>
 #include "pipeline_tap_dance.h"
 #include "platform_types.h"
 
 pipeline_tap_dance_behaviour_status_t* pipeline_tap_dance_behaviour_state_create(void) {
-    pipeline_tap_dance_behaviour_status_t* behaviour_status = (pipeline_tap_dance_behaviour_status_t*)malloc(sizeof(pipeline_tap_dance_behaviour_status_t));
+    pipeline_tap_dance_behaviour_status_t* behaviour_status = (pipeline_tap_dance_behaviour_status_t*)monkeyboard_malloc(sizeof(pipeline_tap_dance_behaviour_status_t));
     //behaviour_status->key_buffer = platform_key_event_create(); // Initialize the key buffer for this tap dance sequence
     reset_behaviour_state(behaviour_status);
     return behaviour_status;
@@ -18,7 +19,7 @@ pipeline_tap_dance_action_config_t* createbehaviouraction_tap(uint8_t tap_count,
         .action = TDCL_TAP_KEY_SENDKEY,
         .keycode = keycode
     };
-    pipeline_tap_dance_action_config_t* allocation = (pipeline_tap_dance_action_config_t*)malloc(sizeof behaviouraction);
+    pipeline_tap_dance_action_config_t* allocation = (pipeline_tap_dance_action_config_t*)monkeyboard_malloc(sizeof behaviouraction);
     memcpy(allocation, &behaviouraction, sizeof behaviouraction);
     return allocation;
 }
@@ -30,7 +31,7 @@ pipeline_tap_dance_action_config_t* createbehaviouraction_hold(uint8_t tap_count
         .layer = layer,
         .hold_strategy = hold_strategy
     };
-    pipeline_tap_dance_action_config_t* allocation = (pipeline_tap_dance_action_config_t*)malloc(sizeof behaviouraction);
+    pipeline_tap_dance_action_config_t* allocation = (pipeline_tap_dance_action_config_t*)monkeyboard_malloc(sizeof behaviouraction);
     memcpy(allocation, &behaviouraction, sizeof behaviouraction);
     return allocation;
 }
@@ -42,9 +43,9 @@ pipeline_tap_dance_behaviour_t* createbehaviour(platform_keycode_t keycodemodifi
         .hold_timeout = g_hold_timeout,
         .tap_timeout = g_tap_timeout
     };
-    pipeline_tap_dance_behaviour_config_t* allocationuserdata = (pipeline_tap_dance_behaviour_config_t*)malloc(sizeof(pipeline_tap_dance_behaviour_config_t));
+    pipeline_tap_dance_behaviour_config_t* allocationuserdata = (pipeline_tap_dance_behaviour_config_t*)monkeyboard_malloc(sizeof(pipeline_tap_dance_behaviour_config_t));
     memcpy(allocationuserdata, &userdata, sizeof userdata);
-    allocationuserdata->actions = (pipeline_tap_dance_action_config_t**)malloc(actionslength * sizeof(pipeline_tap_dance_action_config_t*));
+    allocationuserdata->actions = (pipeline_tap_dance_action_config_t**)monkeyboard_malloc(actionslength * sizeof(pipeline_tap_dance_action_config_t*));
     for (size_t i = 0; i < actionslength; i++)
     {
         allocationuserdata->actions[i] = actions[i];
@@ -53,7 +54,7 @@ pipeline_tap_dance_behaviour_t* createbehaviour(platform_keycode_t keycodemodifi
         .status = pipeline_tap_dance_behaviour_state_create(),
         .config = allocationuserdata
     };
-    pipeline_tap_dance_behaviour_t* allocation = (pipeline_tap_dance_behaviour_t*)malloc(sizeof behaviour);
+    pipeline_tap_dance_behaviour_t* allocation = (pipeline_tap_dance_behaviour_t*)monkeyboard_malloc(sizeof behaviour);
     memcpy(allocation, &behaviour, sizeof behaviour);
     return allocation;
 }
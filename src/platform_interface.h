@@ -25,9 +25,11 @@ bool platform_compare_keyposition(platform_keypos_t key1, platform_keypos_t key2
 #if defined(AGNOSTIC_USE_1D_ARRAY)
 void platform_layout_init_custom_1D_keymap(void* layers, uint8_t num_layers, uint16_t numkeys, get_keycode_from_layer_def get_keycode_from_layer_fn);
 void platform_layout_init_1D_keymap(const platform_keycode_t keymap[][MATRIX_ROWS][MATRIX_COLS], uint8_t num_layers);
+void platform_layout_init_compact_1D_keymap(const platform_compact_keycode_t **layers, uint8_t num_layers, uint16_t num_keys, const platform_keycode_t* extended_keycodes, uint16_t extended_count);
 #elif defined(AGNOSTIC_USE_2D_ARRAY)
 void platform_layout_init_custom_2D_keymap(void* layers, uint8_t num_layers, uint8_t rows, uint8_t cols, get_keycode_from_layer_def get_keycode_from_layer_fn);
 void platform_layout_init_2D_keymap(const platform_keycode_t* keymap_array, uint8_t num_layers, uint8_t rows, uint8_t cols);
+void platform_layout_init_compact_2D_keymap(const platform_compact_keycode_t* keymap_array, uint8_t num_layers, uint8_t rows, uint8_t cols, const platform_keycode_t* extended_keycodes, uint16_t extended_count);
 #endif
 #if defined(FRAMEWORK_QMK)
 #include "info_config.h"
@@ -49,6 +51,9 @@ bool platform_cancel_deferred_exec(platform_deferred_token token);
 // Timer
 platform_time_t monkeyboard_get_time_32(void);
 
+// Free running cycle counter, only needed with MONKEYBOARD_PIPELINE_PROFILING (DWT->CYCCNT on Cortex-M). It can wrap
+uint32_t platform_cycle_count(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,19 +1,50 @@
 #include "platform_layout.h"
 #include <stdint.h>
 #include <stdlib.h>
+#include "monkeyboard_memory.h"
 #include <sys/types.h>
 #include "platform_types.h"
+#include "monkeyboard_keycodes.h"
 
 static custom_layout_t* manager = NULL;
 static uint8_t keymap_rows = 0;
 static uint8_t keymap_cols = 0;
 static uint16_t keymap_num_keys = 0;
 
+// Keycodes of the current layer, one per key. Built when the layout is initialized and rebuilt when the layer changes,
+// so resolving a key press is a single array load instead of a call through get_keycode_from_layer_fn.
+// Custom layouts changing their keycodes at runtime have to set the layer again to refresh it.
+static platform_keycode_t* resolved_keymap = NULL;
+static bool resolved_keymap_stale = false;
+
+// Active layers, from the newest to the oldest, ending with the base layer. Transparent keys fall through them
+#define MAX_LAYER_STACK_SIZE 32
+static uint8_t layer_stack[MAX_LAYER_STACK_SIZE] = {0};
+static uint8_t layer_stack_size = 1;
+
+static void rebuild_resolved_keymap(void);
+
+// Compact keymap (see platform_layout_init_compact_*_keymap)
+static const platform_keycode_t* compact_extended_keycodes = NULL;
+static uint16_t compact_extended_count = 0;
+
+// Expands a compact keymap entry to its keycode
+static inline platform_keycode_t expand_compact_keycode(platform_compact_keycode_t compact_keycode) {
+    if (compact_keycode < PLATFORM_COMPACT_EXTENDED_MIN) {
+        return compact_keycode;
+    }
+    uint16_t index = compact_keycode - PLATFORM_COMPACT_EXTENDED_MIN;
+    if (index >= compact_extended_count) {
+        return PLATFORM_KC_NO;
+    }
+    return compact_extended_keycodes[index];
+}
+
 #if defined (AGNOSTIC_USE_1D_ARRAY)
 
 void platform_layout_init_custom_1D_keymap_impl(void* layers, uint8_t num_layers, uint16_t num_keys, get_keycode_from_layer_def get_keycode_from_layer_fn) {
     // Allocate the manager structure
-    manager = (custom_layout_t*) malloc(sizeof(custom_layout_t));
+    manager = (custom_layout_t*) monkeyboard_malloc(sizeof(custom_layout_t));
     if (!manager) {
         return;
     }
@@ -24,7 +55,7 @@ void platform_layout_init_custom_1D_keymap_impl(void* layers, uint8_t num_layers
     manager->current_layer = 0; // Initialize to the first layer
 
     // Allocate array of pointers to layouts
-    manager->layouts = (platform_keycode_t **)malloc(sizeof(platform_keycode_t*) * num_layers);
+    manager->layouts = (platform_keycode_t **)monkeyboard_malloc(sizeof(platform_keycode_t*) * num_layers);
     if (!manager->layouts) {
         return;
     }
@@ -39,6 +70,8 @@ void platform_layout_init_custom_1D_keymap_impl(void* layers, uint8_t num_layers
     keymap_rows = 1; // For 1D array, we consider it as a single row
     keymap_cols = num_keys; // All keys in a single row
     keymap_num_keys = num_keys;
+
+    rebuild_resolved_keymap();
 }
 
 static platform_keycode_t platform_layout_get_keycode_from_layer_internal(uint8_t layer, platform_keypos_t position) {
@@ -52,11 +85,24 @@ void platform_layout_init_1d_keymap_impl(platform_keycode_t **layers, uint8_t nu
     platform_layout_init_custom_1D_keymap_impl((void*)layers, num_layers, num_keys, platform_layout_get_keycode_from_layer_internal);
 }
 
+static platform_keycode_t platform_layout_get_compact_keycode_from_layer_internal(uint8_t layer, platform_keypos_t position) {
+    if (!manager || layer >= manager->num_layers || position >= manager->num_positions) {
+        return 0;
+    }
+    return expand_compact_keycode(((const platform_compact_keycode_t* const*)manager->layouts)[layer][position]);
+}
+
+void platform_layout_init_compact_1d_keymap_impl(const platform_compact_keycode_t **layers, uint8_t num_layers, uint16_t num_keys, const platform_keycode_t* extended_keycodes, uint16_t extended_count) {
+    compact_extended_keycodes = extended_keycodes;
+    compact_extended_count = extended_count;
+    platform_layout_init_custom_1D_keymap_impl((void*)layers, num_layers, num_keys, platform_layout_get_compact_keycode_from_layer_internal);
+}
+
 #elif defined (AGNOSTIC_USE_2D_ARRAY)
 
 void platform_layout_init_custom_2D_keymap_impl(void* layers, uint8_t num_layers, uint8_t rows, uint8_t cols, get_keycode_from_layer_def get_keycode_from_layer_fn) {
     // Allocate the manager structure
-    manager = (custom_layout_t*) malloc(sizeof(custom_layout_t));
+    manager = (custom_layout_t*) monkeyboard_malloc(sizeof(custom_layout_t));
     if (!manager) {
         return;
     }
@@ -75,6 +121,8 @@ void platform_layout_init_custom_2D_keymap_impl(void* layers, uint8_t num_layers
     keymap_rows = rows;
     keymap_cols = cols;
     keymap_num_keys = rows * cols;
+
+    rebuild_resolved_keymap();
 }
 
 static platform_keycode_t platform_layout_get_keycode_from_layer_internal(uint8_t layer, platform_keypos_t position) {
@@ -91,6 +139,22 @@ void platform_layout_init_2d_keymap_impl(const platform_keycode_t* layers, uint8
     platform_layout_init_custom_2D_keymap_impl((void*)layers, num_layers, rows, cols, platform_layout_get_keycode_from_layer_internal);
 }
 
+static platform_keycode_t platform_layout_get_compact_keycode_from_layer_internal(uint8_t layer, platform_keypos_t position) {
+    if (!manager || layer >= manager->num_layers || position.row >= keymap_rows || position.col >= keymap_cols) {
+        return 0;
+    }
+
+    uint32_t layer_size = keymap_rows * keymap_cols;
+    uint32_t offset = layer * layer_size + position.row * keymap_cols + position.col;
+    return expand_compact_keycode(((const platform_compact_keycode_t*)manager->layouts)[offset]);
+}
+
+void platform_layout_init_compact_2d_keymap_impl(const platform_compact_keycode_t* layers, uint8_t num_layers, uint8_t rows, uint8_t cols, const platform_keycode_t* extended_keycodes, uint16_t extended_count) {
+    compact_extended_keycodes = extended_keycodes;
+    compact_extended_count = extended_count;
+    platform_layout_init_custom_2D_keymap_impl((void*)layers, num_layers, rows, cols, platform_layout_get_compact_keycode_from_layer_internal);
+}
+
 #endif
 
 #if defined(FRAMEWORK_QMK)
@@ -107,6 +171,52 @@ void platform_layout_init_zmk_keymap_impl(platform_keycode_t **layers, uint8_t n
 
 #endif
 
+// Returns the keycode of the key on the layer. Transparent keys fall through the layers below it on the layer stack.
+// A layer not on the stack is considered to be above it (e.g. a layer that is about to be activated)
+static platform_keycode_t resolve_keycode(uint8_t layer, platform_keypos_t position) {
+    platform_keycode_t keycode = manager->get_keycode_from_layer_fn(layer, position);
+    if (keycode != PLATFORM_KC_TRANSPARENT) {
+        return keycode;
+    }
+    uint8_t i = 0;
+    while (i < layer_stack_size && layer_stack[i] != layer) i++;
+    i = (i < layer_stack_size) ? i + 1 : 0;
+    for (; i < layer_stack_size; i++) {
+        keycode = manager->get_keycode_from_layer_fn(layer_stack[i], position);
+        if (keycode != PLATFORM_KC_TRANSPARENT) {
+            return keycode;
+        }
+    }
+    return PLATFORM_KC_NO; // Transparent down to the base layer
+}
+
+// Resolves every key of the current layer
+static void update_resolved_keymap(void) {
+    resolved_keymap_stale = false;
+    if (!resolved_keymap) {
+        return;
+    }
+    platform_keypos_t position;
+#if defined(AGNOSTIC_USE_1D_ARRAY)
+    for (position = 0; position < keymap_num_keys; position++) {
+        resolved_keymap[position] = resolve_keycode(manager->current_layer, position);
+    }
+#elif defined(AGNOSTIC_USE_2D_ARRAY)
+    for (position.row = 0; position.row < keymap_rows; position.row++) {
+        for (position.col = 0; position.col < keymap_cols; position.col++) {
+            resolved_keymap[position.row * keymap_cols + position.col] = resolve_keycode(manager->current_layer, position);
+        }
+    }
+#endif
+}
+
+static void rebuild_resolved_keymap(void) {
+    monkeyboard_free(resolved_keymap);
+    resolved_keymap = (platform_keycode_t*)monkeyboard_malloc(sizeof(platform_keycode_t) * keymap_num_keys);
+    // If the allocation fails the keys are resolved through get_keycode_from_layer_fn
+    update_resolved_keymap();
+}
+
 bool platform_layout_is_valid_layer_impl(uint8_t layer) {
     if (!manager) {
         return false; // No layout initialized
@@ -118,7 +228,11 @@ void platform_layout_set_layer_impl(uint8_t layer) {
     if (!manager || layer >= manager->num_layers) {
         return; // Invalid layer, do nothing
     }
+    if (manager->current_layer == layer && !resolved_keymap_stale) {
+        return;
+    }
     manager->current_layer = layer; // Update the manager's current layer
+    update_resolved_keymap();
 }
 
 uint8_t platform_layout_get_current_layer_impl(void) {
@@ -129,9 +243,31 @@ uint8_t platform_layout_get_current_layer_impl(void) {
 }
 
 platform_keycode_t platform_layout_get_keycode_from_layer_impl(uint8_t layer, platform_keypos_t position) {
-    return manager->get_keycode_from_layer_fn(layer, position);
+    return resolve_keycode(layer, position);
+}
+
+// Sets the active layers used to resolve the transparent keys, from the newest to the oldest, ending with the base layer.
+// The resolved keymap is rebuilt on the next layer change or key lookup
+void platform_layout_set_layer_stack_impl(const uint8_t* layers, uint8_t count) {
+    if (count > MAX_LAYER_STACK_SIZE) count = MAX_LAYER_STACK_SIZE;
+    for (uint8_t i = 0; i < count; i++) {
+        layer_stack[i] = layers[i];
+    }
+    layer_stack_size = count;
+    resolved_keymap_stale = true;
 }
 
 platform_keycode_t platform_layout_get_keycode_impl(platform_keypos_t position) {
-    return platform_layout_get_keycode_from_layer_impl(manager->current_layer, position);
+    if (resolved_keymap_stale) {
+        update_resolved_keymap();
+    }
+    if (resolved_keymap) {
+#if defined(AGNOSTIC_USE_1D_ARRAY)
+        if (position < keymap_num_keys) return resolved_keymap[position];
+#elif defined(AGNOSTIC_USE_2D_ARRAY)
+        if (position.row < keymap_rows && position.col < keymap_cols) return resolved_keymap[position.row * keymap_cols + position.col];
+#endif
+        return 0;
+    }
+    return resolve_keycode(manager->current_layer, position);
 }
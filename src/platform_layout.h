@@ -11,9 +11,11 @@ extern "C" {
 #if defined(AGNOSTIC_USE_1D_ARRAY)
 void platform_layout_init_custom_1D_keymap_impl(void* layers, uint8_t num_layers, uint16_t num_keys, get_keycode_from_layer_def get_keycode_from_layer_fn);
 void platform_layout_init_1d_keymap_impl(platform_keycode_t **layers, uint8_t num_layers, uint16_t num_keys);
+void platform_layout_init_compact_1d_keymap_impl(const platform_compact_keycode_t **layers, uint8_t num_layers, uint16_t num_keys, const platform_keycode_t* extended_keycodes, uint16_t extended_count);
 #elif defined(AGNOSTIC_USE_2D_ARRAY)
 void platform_layout_init_custom_2D_keymap_impl(void* layers, uint8_t num_layers, uint8_t rows, uint8_t cols, get_keycode_from_layer_def get_keycode_from_layer_fn);
 void platform_layout_init_2d_keymap_impl(const platform_keycode_t* layers, uint8_t num_layers, uint8_t rows, uint8_t cols);
+void platform_layout_init_compact_2d_keymap_impl(const platform_compact_keycode_t* layers, uint8_t num_layers, uint8_t rows, uint8_t cols, const platform_keycode_t* extended_keycodes, uint16_t extended_count);
 #endif
 #if defined(FRAMEWORK_QMK)
 #include "info_config.h"
@@ -27,6 +29,7 @@ void platform_layout_set_layer_impl(uint8_t layer);
 uint8_t platform_layout_get_current_layer_impl(void);
 platform_keycode_t platform_layout_get_keycode_from_layer_impl(uint8_t layer, platform_keypos_t);
 platform_keycode_t platform_layout_get_keycode_impl(platform_keypos_t position);
+void platform_layout_set_layer_stack_impl(const uint8_t* layers, uint8_t count);
 
 #ifdef __cplusplus
 }
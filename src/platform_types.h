@@ -12,6 +12,9 @@ extern "C" {
 // Platform-specific type definitions
 typedef uint32_t platform_keycode_t;
 
+// Compact keymap entry (see platform_layout_init_compact_*_keymap)
+typedef uint16_t platform_compact_keycode_t;
+
 // Platform-agnostic deferred execution token
 typedef uint32_t platform_deferred_token;
 
@@ -49,6 +52,18 @@ typedef struct {
     platform_time_t time;
 } abskeyevent_t;
 
+// Origin of a virtual event or an output: the physical key event that caused it, identified by its press id and the
+// time it was received. press_id 0 means no origin (press ids start at 1).
+// The origin is only carried with MONKEYBOARD_EVENT_ORIGIN, enabled by default on the unit tests to measure the
+// latency added by the pipelines
+#if defined(FRAMEWORK_UNIT_TEST) && !defined(MONKEYBOARD_NO_EVENT_ORIGIN) && !defined(MONKEYBOARD_EVENT_ORIGIN)
+    #define MONKEYBOARD_EVENT_ORIGIN
+#endif
+typedef struct {
+    platform_time_t time;
+    uint8_t press_id;
+} platform_event_origin_t;
+
 // Internal structure to manage layouts and layers
 typedef platform_keycode_t (*get_keycode_from_layer_def)(uint8_t layer, platform_keypos_t position);
 typedef struct {
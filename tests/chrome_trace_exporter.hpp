@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "monkeyboard_output_action.h"
+#include "monkeyboard_timeline.h"
+}
+
+// Exports the timeline of the engine (monkeyboard_timeline.h) in the Chrome Trace Event format, to open on Perfetto
+// (ui.perfetto.dev) or chrome://tracing. Every millisecond of platform time is a millisecond on the trace.
+//
+// Tracks:
+// - "physical": the key events received, as instants, and the keys held, from the press to the release
+// - "pipeline N": the captures of the pipeline, from the callback that starts capturing to the one that ends it
+// - "timer": each timer, from its schedule to its fire or cancel, named after the pipeline that owns it
+// - "virtual", "output": the virtual events and the output actions, as instants
+// - "layer": the active layer, as a counter
+//
+// Usage: monkeyboard_timeline_set_sink(&ChromeTraceExporter::sink, &exporter), run the session, then write(path).
+class ChromeTraceExporter {
+public:
+    static void sink(const monkeyboard_timeline_event_t* event, void* user_data) {
+        static_cast<ChromeTraceExporter*>(user_data)->add(*event);
+    }
+
+    void add(const monkeyboard_timeline_event_t& event) {
+        events_.push_back(event);
+    }
+
+    const std::vector<monkeyboard_timeline_event_t>& events() const { return events_; }
+
+    std::string json() const {
+        std::vector<std::string> records;
+        records.push_back(thread_name(TRACK_PHYSICAL, "physical"));
+        records.push_back(thread_name(TRACK_TIMER, "timer"));
+        records.push_back(thread_name(TRACK_VIRTUAL, "virtual"));
+        records.push_back(thread_name(TRACK_OUTPUT, "output"));
+
+        std::vector<bool> pipeline_named;
+        std::vector<key_hold_t> held_keys;
+        bool timer_pending = false;
+        for (const monkeyboard_timeline_event_t& event : events_) {
+            uint64_t ts = microseconds(event.time);
+            switch (event.type) {
+                case MONKEYBOARD_TIMELINE_PHYSICAL_EVENT: {
+                    std::string key = key_name(event.keypos);
+                    records.push_back(instant(TRACK_PHYSICAL, (event.pressed ? "press " : "release ") + key, ts, "\"key\":\"" + key + "\""));
+                    if (event.pressed) {
+                        key_hold_t hold;
+                        hold.keypos = event.keypos;
+                        hold.time = ts;
+                        held_keys.push_back(hold);
+                        break;
+                    }
+                    for (size_t i = 0; i < held_keys.size(); i++) {
+                        if (key_name(held_keys[i].keypos) == key) {
+                            // Async slices, the holds of several keys overlap
+                            records.push_back(async(ASYNC_BEGIN, "hold " + key, held_keys[i].time));
+                            records.push_back(async(ASYNC_END, "hold " + key, ts));
+                            held_keys.erase(held_keys.begin() + static_cast<std::ptrdiff_t>(i));
+                            break;
+                        }
+                    }
+                    break;
+                }
+                case MONKEYBOARD_TIMELINE_CAPTURE_START:
+                case MONKEYBOARD_TIMELINE_CAPTURE_END: {
+                    if (pipeline_named.size() <= event.pipeline) pipeline_named.resize(event.pipeline + 1, false);
+                    if (!pipeline_named[event.pipeline]) {
+                        records.push_back(thread_name(TRACK_PIPELINES + event.pipeline, "pipeline " + std::to_string(event.pipeline)));
+                        pipeline_named[event.pipeline] = true;
+                    }
+                    bool start = event.type == MONKEYBOARD_TIMELINE_CAPTURE_START;
+                    records.push_back(record("capture", start ? "B" : "E", TRACK_PIPELINES + event.pipeline, ts, ""));
+                    break;
+                }
+                case MONKEYBOARD_TIMELINE_TIMER_SCHEDULE:
+                    // A single timer is pending at a time, a new one replaces it
+                    if (timer_pending) records.push_back(record("", "E", TRACK_TIMER, ts, "\"end\":\"replaced\""));
+                    records.push_back(record("timer pipeline " + std::to_string(event.pipeline), "B", TRACK_TIMER, ts, "\"delay_ms\":" + std::to_string(event.value)));
+                    timer_pending = true;
+                    break;
+                case MONKEYBOARD_TIMELINE_TIMER_FIRE:
+                case MONKEYBOARD_TIMELINE_TIMER_CANCEL:
+                    if (!timer_pending) break;
+                    records.push_back(record("", "E", TRACK_TIMER, ts, std::string("\"end\":\"") + (event.type == MONKEYBOARD_TIMELINE_TIMER_FIRE ? "fired" : "cancelled") + "\""));
+                    timer_pending = false;
+                    break;
+                case MONKEYBOARD_TIMELINE_LAYER_CHANGE:
+                    records.push_back(record("layer", "C", TRACK_PHYSICAL, ts, "\"layer\":" + std::to_string(event.value)));
+                    break;
+                case MONKEYBOARD_TIMELINE_VIRTUAL_EVENT:
+                    records.push_back(instant(TRACK_VIRTUAL, (event.pressed ? "press " : "release ") + std::to_string(event.keycode), ts, "\"keycode\":" + std::to_string(event.keycode)));
+                    break;
+                case MONKEYBOARD_TIMELINE_OUTPUT:
+                    records.push_back(instant(TRACK_OUTPUT, std::string(output_name(event.value)) + " " + std::to_string(event.keycode), ts, "\"keycode\":" + std::to_string(event.keycode)));
+                    break;
+            }
+        }
+
+        std::string text = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        for (size_t i = 0; i < records.size(); i++) {
+            text += records[i] + (i + 1 < records.size() ? ",\n" : "\n");
+        }
+        return text + "]}\n";
+    }
+
+    bool write(const char* path) const {
+        FILE* file = std::fopen(path, "wb");
+        if (file == nullptr) return false;
+        std::string text = json();
+        bool written = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+        return std::fclose(file) == 0 && written;
+    }
+
+private:
+    static constexpr int TRACK_PHYSICAL = 1;
+    static constexpr int TRACK_TIMER = 2;
+    static constexpr int TRACK_VIRTUAL = 3;
+    static constexpr int TRACK_OUTPUT = 4;
+    static constexpr int TRACK_PIPELINES = 10; // Pipeline N on TRACK_PIPELINES + N
+    static constexpr const char* ASYNC_BEGIN = "b";
+    static constexpr const char* ASYNC_END = "e";
+
+    struct key_hold_t {
+        platform_keypos_t keypos;
+        uint64_t time;
+    };
+
+    std::vector<monkeyboard_timeline_event_t> events_;
+
+    static uint64_t microseconds(platform_time_t time) {
+        return static_cast<uint64_t>(time) * 1000;
+    }
+
+    static std::string key_name(platform_keypos_t keypos) {
+        return std::to_string(keypos.row) + "," + std::to_string(keypos.col);
+    }
+
+    static const char* output_name(uint32_t type) {
+        switch (type) {
+            case MONKEYBOARD_OUTPUT_REGISTER: return "register";
+            case MONKEYBOARD_OUTPUT_UNREGISTER: return "unregister";
+            case MONKEYBOARD_OUTPUT_REPORT_ADD: return "report add";
+            case MONKEYBOARD_OUTPUT_REPORT_DEL: return "report del";
+            case MONKEYBOARD_OUTPUT_REPORT_SEND: return "report send";
+            default: return "unknown";
+        }
+    }
+
+    static std::string record(const std::string& name, const char* phase, int track, uint64_t ts, const std::string& args) {
+        return "{\"name\":\"" + name + "\",\"ph\":\"" + phase + "\",\"pid\":1,\"tid\":" + std::to_string(track) +
+               ",\"ts\":" + std::to_string(ts) + ",\"args\":{" + args + "}}";
+    }
+
+    static std::string instant(int track, const std::string& name, uint64_t ts, const std::string& args) {
+        return "{\"name\":\"" + name + "\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":" + std::to_string(track) +
+               ",\"ts\":" + std::to_string(ts) + ",\"args\":{" + args + "}}";
+    }
+
+    static std::string async(const char* phase, const std::string& name, uint64_t ts) {
+        return "{\"name\":\"" + name + "\",\"cat\":\"keys\",\"ph\":\"" + phase + "\",\"id\":\"" + name + "\",\"pid\":1,\"tid\":" +
+               std::to_string(TRACK_PHYSICAL) + ",\"ts\":" + std::to_string(ts) + ",\"args\":{}}";
+    }
+
+    static std::string thread_name(int track, const std::string& name) {
+        return "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(track) + ",\"args\":{\"name\":\"" + name + "\"}}";
+    }
+};
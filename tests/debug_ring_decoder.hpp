@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Host decoder of the binary debug log (see monkeyboard_debug_ring.h). The words drained from the ring are widened to
+// 64 bits, so dumps of 32-bit firmware decode the same way. resolve_string gives the string at an address of the
+// firmware: the format strings and the %s arguments. In the same process (the simulator) the address is the string;
+// for a firmware dump it's read from the .rodata of its ELF image (resolve_in_image). An address the resolver
+// doesn't know, such as a string on the stack of the firmware, is shown as <outside the image 0x...>.
+class DebugRingDecoder {
+public:
+    // Sets the string at the address, false when the address isn't a string of the image
+    typedef std::function<bool(uint64_t address, std::string* string)> resolve_string_t;
+
+    explicit DebugRingDecoder(resolve_string_t resolve_string = &resolve_in_process)
+        : resolve_string_(resolve_string) {}
+
+    static bool resolve_in_process(uint64_t address, std::string* string) {
+        const char* text = reinterpret_cast<const char*>(static_cast<uintptr_t>(address));
+        *string = text != nullptr ? std::string(text) : std::string("(null)");
+        return true;
+    }
+
+    // Resolver for the strings of an image section (.rodata) loaded at the base address. The string has to end
+    // inside the section
+    static resolve_string_t resolve_in_image(uint64_t base, std::vector<char> section) {
+        return [base, section](uint64_t address, std::string* string) {
+            if (address < base || address - base >= section.size()) return false;
+            std::vector<char>::const_iterator start = section.begin() + static_cast<std::ptrdiff_t>(address - base);
+            std::vector<char>::const_iterator end = std::find(start, section.end(), '\0');
+            if (end == section.end()) return false;
+            *string = std::string(start, end);
+            return true;
+        };
+    }
+
+    // Decodes the whole records of words, in order. A truncated record at the end is ignored
+    std::string decode(const std::vector<uint64_t>& words) const {
+        std::string text;
+        size_t position = 0;
+        while (position + 2 <= words.size()) {
+            uint64_t format = words[position];
+            size_t arg_count = static_cast<size_t>(words[position + 1]);
+            if (position + 2 + arg_count > words.size()) break;
+            std::vector<uint64_t> args(words.begin() + static_cast<std::ptrdiff_t>(position + 2), words.begin() + static_cast<std::ptrdiff_t>(position + 2 + arg_count));
+            text += format_record(resolve(format), args);
+            position += 2 + arg_count;
+        }
+        return text;
+    }
+
+private:
+    resolve_string_t resolve_string_;
+
+    std::string resolve(uint64_t address) const {
+        std::string string;
+        if (resolve_string_(address, &string)) return string;
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), "<outside the image 0x%llx>", static_cast<unsigned long long>(address));
+        return buffer;
+    }
+
+    // printf conversion of one argument: flags, width and precision are kept, the length is applied to the word
+    std::string format_argument(const std::string& flags, const std::string& length, char conversion, uint64_t word) const {
+        char buffer[64];
+        std::string spec = "%" + flags;
+        switch (conversion) {
+            case 'd':
+            case 'i': {
+                long long value = static_cast<long long>(static_cast<int64_t>(word));
+                if (length == "hh") value = static_cast<signed char>(word);
+                else if (length == "h") value = static_cast<short>(word);
+                else if (length.empty()) value = static_cast<int>(word);
+                std::snprintf(buffer, sizeof(buffer), (spec + "lld").c_str(), value);
+                return buffer;
+            }
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o': {
+                unsigned long long value = word;
+                if (length == "hh") value = static_cast<unsigned char>(word);
+                else if (length == "h") value = static_cast<unsigned short>(word);
+                else if (length.empty()) value = static_cast<unsigned int>(word);
+                std::snprintf(buffer, sizeof(buffer), (spec + "ll" + conversion).c_str(), value);
+                return buffer;
+            }
+            case 'c':
+                std::snprintf(buffer, sizeof(buffer), (spec + "c").c_str(), static_cast<int>(word));
+                return buffer;
+            case 'p':
+                std::snprintf(buffer, sizeof(buffer), "0x%llx", static_cast<unsigned long long>(word));
+                return buffer;
+            case 's': {
+                std::string value = resolve(word);
+                std::vector<char> text(value.size() + 64);
+                std::snprintf(text.data(), text.size(), (spec + "s").c_str(), value.c_str());
+                return text.data();
+            }
+        }
+        return "%" + flags + length + conversion;
+    }
+
+    std::string format_record(const std::string& format, const std::vector<uint64_t>& args) const {
+        std::string text;
+        size_t arg = 0;
+        for (size_t i = 0; i < format.size(); i++) {
+            if (format[i] != '%') {
+                text += format[i];
+                continue;
+            }
+            if (i + 1 < format.size() && format[i + 1] == '%') {
+                text += '%';
+                i++;
+                continue;
+            }
+            size_t start = ++i;
+            while (i < format.size() && std::string("-+ #0123456789.").find(format[i]) != std::string::npos) i++;
+            std::string flags = format.substr(start, i - start);
+            size_t length_start = i;
+            while (i < format.size() && std::string("hlzjt").find(format[i]) != std::string::npos) i++;
+            std::string length = format.substr(length_start, i - length_start);
+            if (i >= format.size()) break;
+            text += arg < args.size() ? format_argument(flags, length, format[i], args[arg++]) : std::string("?");
+        }
+        return text;
+    }
+};
@@ -2,9 +2,15 @@
 #include "../src/platform_layout.h"
 #include "gtest/gtest.h"
 #include "monkeyboard_deferred_callbacks.h"
+#include "monkeyboard_output_action.h"
 #include "platform_types.h"
 #include "platform_mock.hpp"
 #include <stdlib.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include <algorithm>
 #include <stdio.h>
 #include <cstdint>
 #include <sstream>
@@ -25,6 +31,9 @@ static void add_key_event(platform_keycode_t keycode, bool pressed) {
     event.type = pressed ? event_type_t::KEY_PRESS : event_type_t::KEY_RELEASE;
     event.keycode = keycode;
     event.time = g_mock_state.timer; // Use current timer for the event
+#if defined(MONKEYBOARD_EVENT_ORIGIN)
+    event.origin = monkeyboard_output_action_current_origin();
+#endif
     g_mock_state.events.push_back(event);
 }
 
@@ -33,6 +42,9 @@ static void add_report_event(platform_keycode_t keycode, bool pressed) {
     event.type = pressed ? event_type_t::REPORT_PRESS : event_type_t::REPORT_RELEASE;
     event.keycode = keycode;
     event.time = g_mock_state.timer; // Use current timer for the event
+#if defined(MONKEYBOARD_EVENT_ORIGIN)
+    event.origin = monkeyboard_output_action_current_origin();
+#endif
     g_mock_state.events.push_back(event);
 }
 
@@ -40,13 +52,16 @@ static void add_report_send(void) {
     event_t event;
     event.type = event_type_t::REPORT_SEND;
     event.time = g_mock_state.timer; // Use current timer for the event
+#if defined(MONKEYBOARD_EVENT_ORIGIN)
+    event.origin = monkeyboard_output_action_current_origin();
+#endif
     g_mock_state.events.push_back(event);
 }
 
 // Mock implementation of platform interface for testing
 
 // MockPlatformState method implementations
-MockPlatformState::MockPlatformState() : timer(0) {}
+MockPlatformState::MockPlatformState() : timer(0), manual_cycles(false), cycles(0) {}
 
 void MockPlatformState::set_timer(platform_time_t time) {
     execute_deferred_executions();
@@ -66,10 +81,37 @@ void MockPlatformState::advance_timer(platform_time_t ms) {
 
 void MockPlatformState::reset() {
     timer = 0;
+    manual_cycles = false;
+    cycles = 0;
 
     events.clear();
 }
 
+#if defined(MONKEYBOARD_EVENT_ORIGIN)
+LatencyReport MockPlatformState::added_latency() const {
+    LatencyReport report;
+    std::vector<platform_time_t> latencies;
+    for (const event_t& event : events) {
+        if ((event.type == event_type_t::KEY_PRESS || event.type == event_type_t::REPORT_PRESS) && event.origin.press_id != 0) {
+            latencies.push_back(event.time - event.origin.time);
+        }
+    }
+    if (latencies.empty()) {
+        return report;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    for (platform_time_t latency : latencies) {
+        report.histogram[latency]++;
+    }
+    // Nearest rank percentiles
+    report.count = latencies.size();
+    report.p50 = latencies[(latencies.size() * 50 + 99) / 100 - 1];
+    report.p99 = latencies[(latencies.size() * 99 + 99) / 100 - 1];
+    report.max = latencies.back();
+    return report;
+}
+#endif
+
 // New comparison methods with Google Test integration
 
 // Helper function to format an event into a compact string
@@ -294,10 +336,16 @@ void platform_layout_init_zmk_keymap(platform_keycode_t **layers, uint8_t num_la
 void platform_layout_init_1d_keymap(platform_keycode_t **layers, uint8_t num_layers, uint16_t num_keys) {
     platform_layout_init_1d_keymap_impl(layers, num_layers, num_keys);
 }
+void platform_layout_init_compact_1D_keymap(const platform_compact_keycode_t **layers, uint8_t num_layers, uint16_t num_keys, const platform_keycode_t* extended_keycodes, uint16_t extended_count) {
+    platform_layout_init_compact_1d_keymap_impl(layers, num_layers, num_keys, extended_keycodes, extended_count);
+}
 #elif defined(AGNOSTIC_USE_2D_ARRAY)
 void platform_layout_init_2D_keymap(const platform_keycode_t* layers, uint8_t num_layers, uint8_t rows, uint8_t cols) {
     platform_layout_init_2d_keymap_impl(layers,  num_layers, rows, cols);
 }
+void platform_layout_init_compact_2D_keymap(const platform_compact_keycode_t* layers, uint8_t num_layers, uint8_t rows, uint8_t cols, const platform_keycode_t* extended_keycodes, uint16_t extended_count) {
+    platform_layout_init_compact_2d_keymap_impl(layers, num_layers, rows, cols, extended_keycodes, extended_count);
+}
 #endif
 
 bool platform_layout_is_valid_layer(uint8_t layer) {
@@ -340,6 +388,17 @@ platform_time_t monkeyboard_get_time_32(void) {
     return g_mock_state.timer;
 }
 
+uint32_t platform_cycle_count(void) {
+    if (g_mock_state.manual_cycles) return g_mock_state.cycles;
+#if defined(__x86_64__) || defined(__i386__)
+    return (uint32_t)__rdtsc();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)((uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec);
+#endif
+}
+
 // Helper functions for creating tap dance event sequences
 event_t td_press(platform_keycode_t keycode, platform_time_t time) {
     event_t event;
@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <map>
 #include <vector>
 #include "gtest/gtest.h"
 #include "platform_types.h"
@@ -24,6 +25,7 @@ struct event_t {
         uint8_t layer;               // For layer events
     };
     platform_time_t time; // Time gap from previous event (0 = ignore time in comparison)
+    platform_event_origin_t origin = {0, 0}; // Physical key event that caused the output (not compared)
 
     bool operator==(const event_t& other) const {
         if (type != other.type) return false;
@@ -43,9 +45,23 @@ struct event_t {
     }
 };
 
+// Latency added by the pipelines to each keystroke: time from the physical key event to the key press output it
+// caused, for the outputs with an origin (see MONKEYBOARD_EVENT_ORIGIN)
+struct LatencyReport {
+    size_t count = 0;
+    platform_time_t p50 = 0;
+    platform_time_t p99 = 0;
+    platform_time_t max = 0;
+    std::map<platform_time_t, size_t> histogram; // Added latency in ms -> key presses
+};
+
 // MockPlatformState class
 struct MockPlatformState {
     platform_time_t timer;
+    // platform_cycle_count reads the host cycle counter (the monotonic clock in nanoseconds where there's none).
+    // With manual_cycles it reads cycles instead, advanced only by the tests to get deterministic costs
+    bool manual_cycles;
+    uint32_t cycles;
     std::vector<event_t> events;
 
     // Constructor and method declarations
@@ -54,6 +70,9 @@ struct MockPlatformState {
     void set_timer(platform_time_t time);
     void advance_timer(platform_time_t ms);
     void reset();
+#if defined(MONKEYBOARD_EVENT_ORIGIN)
+    LatencyReport added_latency() const;
+#endif
 
     // New comparison methods with Google Test integration
     ::testing::AssertionResult event_actions_match_absolute(const std::vector<event_t>& expected) const;
@@ -0,0 +1,98 @@
+#include <cstdint>
+#include <vector>
+#include "gtest/gtest.h"
+#include "platform_interface.h"
+#include "platform_mock.hpp"
+#include "platform_types.h"
+#include "test_scenario.hpp"
+
+extern "C" {
+#include "key_event_buffer.h"
+#include "key_virtual_buffer.h"
+#include "monkeyboard_deferred_callbacks.h"
+#include "monkeyboard_layer_manager.h"
+}
+
+class BufferCapacities : public ::testing::Test {
+protected:
+    void TearDown() override {
+        deferred_callbacks_create(MAX_DEFERRED_CALLBACKS, false);
+    }
+
+    static platform_keypos_t keypos(uint8_t col) {
+        platform_keypos_t position;
+        position.row = 0;
+        position.col = col;
+        return position;
+    }
+
+    static void noop_callback(void* context) {}
+};
+
+// A buffer created with a capacity is full at that capacity, unless it is growable
+TEST_F(BufferCapacities, FixedBuffersAreFullAtTheirCapacity) {
+    platform_key_event_buffer_t* event_buffer = platform_key_event_create_with_capacity(4, 4, false);
+    platform_virtual_event_buffer_t* virtual_buffer = platform_virtual_event_create_with_capacity(3, false);
+
+    bool buffer_full = false;
+    for (uint8_t i = 0; i < 4; i++) {
+        EXPECT_NE(platform_key_event_add_physical_press(event_buffer, i, keypos(i), 100 + i, &buffer_full), 0);
+    }
+    EXPECT_EQ(platform_key_event_add_physical_press(event_buffer, 4, keypos(4), 104, &buffer_full), 0);
+    for (uint8_t i = 0; i < 3; i++) {
+        EXPECT_TRUE(platform_virtual_event_add_press(virtual_buffer, 200 + i));
+    }
+    EXPECT_FALSE(platform_virtual_event_add_release(virtual_buffer, 200));
+
+    EXPECT_EQ(event_buffer->capacity, 4);
+    EXPECT_EQ(virtual_buffer->capacity, 3);
+}
+
+// Growable buffers keep every event in order when they grow past their initial capacity
+TEST_F(BufferCapacities, GrowableBuffersKeepTheEventsInOrder) {
+    platform_key_event_buffer_t* event_buffer = platform_key_event_create_with_capacity(2, 2, true);
+
+    bool buffer_full = false;
+    for (uint8_t i = 0; i < 40; i++) {
+        EXPECT_NE(platform_key_event_add_physical_press(event_buffer, i, keypos(i), 100 + i, &buffer_full), 0);
+    }
+    EXPECT_FALSE(buffer_full);
+    ASSERT_EQ(event_buffer->event_buffer_pos, 40);
+    EXPECT_GE(event_buffer->capacity, 40);
+    EXPECT_GE(event_buffer->key_press_buffer->capacity, 40);
+    for (uint8_t i = 0; i < 40; i++) {
+        EXPECT_EQ(event_buffer->event_buffer[i].keycode, 100u + i);
+        EXPECT_EQ(event_buffer->event_buffer[i].time, i);
+    }
+}
+
+// A growable deferred callback queue accepts more callbacks than its initial capacity
+TEST_F(BufferCapacities, GrowableDeferredCallbacks) {
+    deferred_callbacks_create(2, true);
+    for (uint32_t i = 0; i < 20; i++) {
+        EXPECT_NE(schedule_deferred_callback(10 + i, noop_callback, nullptr), DEFERRED_INVALID_TOKEN);
+    }
+    EXPECT_EQ(get_pending_callback_count(), 20);
+
+    deferred_callbacks_create(2, false);
+    EXPECT_NE(schedule_deferred_callback(10, noop_callback, nullptr), DEFERRED_INVALID_TOKEN);
+    EXPECT_NE(schedule_deferred_callback(10, noop_callback, nullptr), DEFERRED_INVALID_TOKEN);
+    EXPECT_EQ(schedule_deferred_callback(10, noop_callback, nullptr), DEFERRED_INVALID_TOKEN);
+}
+
+// The executor creates the nested layers with the capacity of its config
+TEST_F(BufferCapacities, NestedLayersUseTheExecutorCapacity) {
+    std::vector<std::vector<std::vector<platform_keycode_t>>> keymap = {{{ 3000, 3001 }}};
+    TestScenario scenario(keymap);
+    scenario.build();
+    pipeline_executor_capacities_t capacities = PIPELINE_EXECUTOR_DEFAULT_CAPACITIES;
+    capacities.nested_layers = 20;
+    pipeline_executor_create_config_with_capacities(&capacities, 0, 0);
+
+    for (uint8_t i = 0; i < 24; i++) {
+        layout_manager_add_layer(keypos(i), i + 1, 1 + (i % 3));
+    }
+
+    EXPECT_EQ(g_mock_state.events.size(), 20u);
+    layout_manager_create_nested_layers(MAX_NUM_NESTED_LAYERS);
+}
@@ -0,0 +1,82 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include "keyboard_simulator.hpp"
+#include "gtest/gtest.h"
+#include "platform_interface.h"
+#include "platform_mock.hpp"
+#include "platform_types.h"
+#include "test_scenario.hpp"
+
+extern "C" {
+#include "monkeyboard_keycodes.h"
+#include "pipeline_executor.h"
+}
+
+class CompactKeymap : public ::testing::Test {
+protected:
+    static platform_keypos_t keypos(uint8_t row, uint8_t col) {
+        platform_keypos_t position;
+        position.row = row;
+        position.col = col;
+        return position;
+    }
+};
+
+// Basic and modified keycodes are stored as they are, unicode and custom keycodes through the extended table
+TEST_F(CompactKeymap, EntriesExpandToTheirKeycodes) {
+    const platform_keycode_t UNICODE_KEY = UNICODE_KEYCODE_MIN + 0x263A;
+    const platform_keycode_t CUSTOM_KEY = CUSTOM_KEYCODE_MIN + 42;
+
+    static const platform_keycode_t extended_keycodes[] = { UNICODE_KEY, CUSTOM_KEY };
+    static const platform_compact_keycode_t compact_keymap[2][1][4] = {{
+        { 0x04, MONKEEB_LCTL(0x05), PLATFORM_COMPACT_EXTENDED(0), PLATFORM_COMPACT_EXTENDED(1) }
+    }, {
+        { PLATFORM_KC_TRANSPARENT, PLATFORM_COMPACT_EXTENDED(1), 0x06, PLATFORM_COMPACT_EXTENDED(2) }
+    }};
+
+    std::vector<std::vector<std::vector<platform_keycode_t>>> keymap = {{{ 0, 0, 0, 0 }}};
+    TestScenario scenario(keymap);
+    scenario.build();
+    platform_layout_init_compact_2D_keymap(&compact_keymap[0][0][0], 2, 1, 4, extended_keycodes, 2);
+
+    EXPECT_EQ(platform_layout_get_keycode_from_layer(0, keypos(0, 0)), 0x04u);
+    EXPECT_EQ(platform_layout_get_keycode_from_layer(0, keypos(0, 1)), (platform_keycode_t)MONKEEB_LCTL(0x05));
+    EXPECT_EQ(platform_layout_get_keycode_from_layer(0, keypos(0, 2)), UNICODE_KEY);
+    EXPECT_EQ(platform_layout_get_keycode_from_layer(0, keypos(0, 3)), CUSTOM_KEY);
+
+    // Extended entries out of the table resolve to no key
+    EXPECT_EQ(platform_layout_get_keycode_from_layer(1, keypos(0, 3)), (platform_keycode_t)PLATFORM_KC_NO);
+    // Transparent entries still fall through to the base layer
+    EXPECT_EQ(platform_layout_get_keycode_from_layer(1, keypos(0, 0)), 0x04u);
+}
+
+// Key presses on a compact keymap produce the expanded keycodes
+TEST_F(CompactKeymap, KeyPressesUseExpandedKeycodes) {
+    const platform_keycode_t CUSTOM_KEY = CUSTOM_KEYCODE_MIN + 7;
+
+    static const platform_keycode_t extended_keycodes[] = { CUSTOM_KEY };
+    static const platform_compact_keycode_t compact_keymap[1][1][2] = {{
+        { 0x04, PLATFORM_COMPACT_EXTENDED(0) }
+    }};
+
+    std::vector<std::vector<std::vector<platform_keycode_t>>> keymap = {{{ 0, 0 }}};
+    TestScenario scenario(keymap);
+    scenario.build();
+    platform_layout_init_compact_2D_keymap(&compact_keymap[0][0][0], 1, 1, 2, extended_keycodes, 1);
+
+    abskeyevent_t event;
+    event.keypos = keypos(0, 1);
+    event.pressed = true;
+    event.time = 0;
+    pipeline_process_key(event);
+    event.pressed = false;
+    pipeline_process_key(event);
+
+    std::vector<event_t> expected_events = {
+        td_press(CUSTOM_KEY, 0),
+        td_release(CUSTOM_KEY, 0)
+    };
+    EXPECT_TRUE(g_mock_state.event_actions_match_relative(expected_events));
+}
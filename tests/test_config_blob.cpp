@@ -0,0 +1,223 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "gtest/gtest.h"
+#include "platform_interface.h"
+#include "platform_mock.hpp"
+#include "platform_types.h"
+#include "keyboard_simulator.hpp"
+#include "test_scenario.hpp"
+#include "combo_test_helpers.hpp"
+#include "tap_dance_test_helpers.hpp"
+#include "oneshot_test_helpers.hpp"
+#include "key_replacer_test_helpers.hpp"
+
+extern "C" {
+#include "monkeyboard_config_blob.h"
+#include "monkeyboard_config_packer.h"
+#include "monkeyboard_keycodes.h"
+#include "pipeline_executor.h"
+}
+
+class ConfigBlob : public ::testing::Test {
+protected:
+    // Packs the sources on a 4 bytes aligned buffer
+    static std::vector<uint32_t> pack(const monkeyboard_config_packer_sources_t& sources, size_t* blob_size) {
+        *blob_size = monkeyboard_config_pack(&sources, NULL, 0);
+        std::vector<uint32_t> blob((*blob_size + 3) / 4);
+        EXPECT_EQ(monkeyboard_config_pack(&sources, blob.data(), blob.size() * 4), *blob_size);
+        return blob;
+    }
+
+    static std::vector<void*> load(const std::vector<uint32_t>& blob, size_t blob_size, monkeyboard_config_blob_pipelines_t* pipelines) {
+        size_t ram_size = 0;
+        EXPECT_EQ(monkeyboard_config_blob_required_ram(blob.data(), blob_size, &ram_size), MONKEYBOARD_CONFIG_BLOB_OK);
+        std::vector<void*> ram((ram_size + sizeof(void*) - 1) / sizeof(void*));
+        EXPECT_EQ(monkeyboard_config_blob_load(blob.data(), blob_size, ram.data(), ram_size, pipelines), MONKEYBOARD_CONFIG_BLOB_OK);
+        return ram;
+    }
+};
+
+// Every pipeline configuration is rebuilt as it was packed
+TEST_F(ConfigBlob, RoundTripRestoresPipelineConfigs) {
+    std::vector<std::vector<std::vector<platform_keycode_t>>> keymap = {{{ 3000, 3001, 3002 }}};
+    TestScenario scenario(keymap);
+    scenario.build();
+
+    pipeline_combo_global_config_t* combos = ComboConfigBuilder()
+        .with_strategy(COMBO_STRATEGY_DISCARD_WHEN_ALL_PRESSED_IN_COMMON)
+        .add_simple_combo({{0, 0}, {0, 1}}, 3100)
+        .add_simple_combo({{0, 1}, {0, 2}}, 3101)
+        .build();
+    pipeline_tap_dance_global_config_t* tap_dance = TapDanceConfigBuilder()
+        .add_tap_hold(3000, {{1, 3200}, {2, 3201}}, {{1, 1}}, 180, 220, TAP_DANCE_BALANCED)
+        .build();
+    pipeline_oneshot_modifier_global_t* oneshot = OneShotConfigBuilder()
+        .add_modifiers(3002, {MONKEEB_MOD_LCTL, MONKEEB_MOD_LSFT})
+        .build();
+    pipeline_key_replacer_global_config_t* key_replacer = KeyReplacerConfigBuilder()
+        .add_replacement(3001, {3300, 3301}, {3302})
+        .build();
+
+    monkeyboard_config_packer_sources_t sources = {};
+    sources.combos = combos;
+    sources.tap_dance = tap_dance;
+    sources.oneshot = oneshot->config;
+    sources.key_replacer = key_replacer;
+    size_t blob_size = 0;
+    std::vector<uint32_t> blob = pack(sources, &blob_size);
+    monkeyboard_config_blob_pipelines_t loaded;
+    std::vector<void*> ram = load(blob, blob_size, &loaded);
+
+    ASSERT_NE(loaded.combos, nullptr);
+    EXPECT_EQ(loaded.combos->strategy, combos->strategy);
+    ASSERT_EQ(loaded.combos->length, combos->length);
+    for (size_t i = 0; i < combos->length; i++) {
+        pipeline_combo_config_t* expected = combos->combos[i];
+        pipeline_combo_config_t* actual = loaded.combos->combos[i];
+        EXPECT_EQ(actual->key_on_press_combo.action, expected->key_on_press_combo.action);
+        EXPECT_EQ(actual->key_on_press_combo.key, expected->key_on_press_combo.key);
+        EXPECT_EQ(actual->key_on_release_combo.action, expected->key_on_release_combo.action);
+        EXPECT_EQ(actual->combo_status, COMBO_IDLE);
+        ASSERT_EQ(actual->keys_length, expected->keys_length);
+        for (size_t j = 0; j < expected->keys_length; j++) {
+            EXPECT_TRUE(platform_compare_keyposition(actual->keys[j]->keypos, expected->keys[j]->keypos));
+            EXPECT_EQ(actual->keys[j]->key_on_press.key, expected->keys[j]->key_on_press.key);
+            EXPECT_FALSE(actual->keys[j]->is_pressed);
+        }
+    }
+
+    ASSERT_NE(loaded.tap_dance, nullptr);
+    ASSERT_EQ(loaded.tap_dance->length, tap_dance->length);
+    pipeline_tap_dance_behaviour_config_t* expected_behaviour = tap_dance->behaviours[0]->config;
+    pipeline_tap_dance_behaviour_config_t* actual_behaviour = loaded.tap_dance->behaviours[0]->config;
+    EXPECT_EQ(actual_behaviour->keycodemodifier, expected_behaviour->keycodemodifier);
+    EXPECT_EQ(actual_behaviour->hold_timeout, expected_behaviour->hold_timeout);
+    EXPECT_EQ(actual_behaviour->tap_timeout, expected_behaviour->tap_timeout);
+    ASSERT_EQ(actual_behaviour->actionslength, expected_behaviour->actionslength);
+    for (size_t i = 0; i < expected_behaviour->actionslength; i++) {
+        EXPECT_EQ(actual_behaviour->actions[i]->tap_count, expected_behaviour->actions[i]->tap_count);
+        EXPECT_EQ(actual_behaviour->actions[i]->action, expected_behaviour->actions[i]->action);
+        if (expected_behaviour->actions[i]->action == TDCL_TAP_KEY_SENDKEY) {
+            EXPECT_EQ(actual_behaviour->actions[i]->keycode, expected_behaviour->actions[i]->keycode);
+        } else {
+            EXPECT_EQ(actual_behaviour->actions[i]->layer, expected_behaviour->actions[i]->layer);
+            EXPECT_EQ(actual_behaviour->actions[i]->hold_strategy, expected_behaviour->actions[i]->hold_strategy);
+        }
+    }
+    EXPECT_EQ(loaded.tap_dance->behaviours[0]->status->state, TAP_DANCE_IDLE);
+
+    ASSERT_NE(loaded.oneshot, nullptr);
+    ASSERT_EQ(loaded.oneshot->config->length, 1u);
+    EXPECT_EQ(loaded.oneshot->config->modifier_pairs[0]->keycode, 3002u);
+    EXPECT_EQ(loaded.oneshot->config->modifier_pairs[0]->modifiers, MONKEEB_MOD_LCTL | MONKEEB_MOD_LSFT);
+    EXPECT_EQ(loaded.oneshot->status->modifiers, 0);
+
+    ASSERT_NE(loaded.key_replacer, nullptr);
+    ASSERT_EQ(loaded.key_replacer->length, 1u);
+    pipeline_key_replacer_pair_t* pair = loaded.key_replacer->modifier_pairs[0];
+    EXPECT_EQ(pair->keycode, 3001u);
+    ASSERT_EQ(pair->press_event_buffer->buffer_length, 2);
+    EXPECT_EQ(pair->press_event_buffer->buffer[0].keycode, 3300u);
+    EXPECT_EQ(pair->press_event_buffer->buffer[1].keycode, 3301u);
+    ASSERT_EQ(pair->release_event_buffer->buffer_length, 1);
+    EXPECT_EQ(pair->release_event_buffer->buffer[0].keycode, 3302u);
+}
+
+// The keymap is used from the blob and the loaded tap dance drives the key presses
+TEST_F(ConfigBlob, LoadedConfigDrivesThePipelines) {
+    const platform_keycode_t TAP_DANCE_KEY = 3000;
+    const platform_keycode_t OUTPUT_KEY = 3001;
+    const platform_keycode_t BASE_KEY = 3002;
+    const platform_keycode_t CUSTOM_KEY = CUSTOM_KEYCODE_MIN + 5;
+    const uint8_t TARGET_LAYER = 1;
+
+    std::vector<std::vector<std::vector<platform_keycode_t>>> keymap = {{
+        { TAP_DANCE_KEY, BASE_KEY }
+    }, {
+        { PLATFORM_KC_TRANSPARENT, CUSTOM_KEY }
+    }};
+    const platform_keycode_t flat_keymap[] = { TAP_DANCE_KEY, BASE_KEY, PLATFORM_KC_TRANSPARENT, CUSTOM_KEY };
+
+    TapDanceConfigBuilder tap_dance_builder;
+    tap_dance_builder.add_tap_hold(TAP_DANCE_KEY, {{1, OUTPUT_KEY}}, {{1, TARGET_LAYER}}, 200, 200, TAP_DANCE_HOLD_PREFERRED);
+
+    monkeyboard_config_packer_sources_t sources = {};
+    sources.keymap = flat_keymap;
+    sources.num_layers = 2;
+    sources.rows = 1;
+    sources.cols = 2;
+    sources.tap_dance = tap_dance_builder.build();
+    size_t blob_size = 0;
+    std::vector<uint32_t> blob = pack(sources, &blob_size);
+
+    TestScenario scenario(keymap);
+    monkeyboard_config_blob_pipelines_t loaded;
+    std::vector<void*> ram = load(blob, blob_size, &loaded);
+    pipeline_tap_dance_global_state_create();
+    scenario.add_physical_pipeline(&pipeline_tap_dance_callback_process_data_executor, &pipeline_tap_dance_callback_reset_executor, loaded.tap_dance);
+    scenario.build();
+    // The scenario initializes its own layout. Loading again on the same buffer sets the blob keymap and
+    // builds the same configurations at the same addresses
+    EXPECT_EQ(monkeyboard_config_blob_load(blob.data(), blob_size, ram.data(), ram.size() * sizeof(void*), &loaded), MONKEYBOARD_CONFIG_BLOB_OK);
+    KeyboardSimulator& keyboard = scenario.keyboard();
+
+    keyboard.press_key_at(TAP_DANCE_KEY, 0);
+    keyboard.press_key_at(BASE_KEY, 250);
+    keyboard.release_key_at(BASE_KEY, 260);
+    keyboard.release_key_at(TAP_DANCE_KEY, 300);
+    keyboard.press_key_at(TAP_DANCE_KEY, 400);
+    keyboard.release_key_at(TAP_DANCE_KEY, 410);
+
+    std::vector<event_t> expected_events = {
+        td_layer(TARGET_LAYER, 200),
+        td_press(CUSTOM_KEY, 250),
+        td_release(CUSTOM_KEY, 260),
+        td_layer(0, 300),
+        td_press(OUTPUT_KEY, 410),
+        td_release(OUTPUT_KEY, 410)
+    };
+    EXPECT_TRUE(g_mock_state.event_actions_match_absolute(expected_events));
+}
+
+// Blobs that are not valid are rejected before anything is loaded
+TEST_F(ConfigBlob, InvalidBlobsAreRejected) {
+    pipeline_oneshot_modifier_global_t* oneshot = OneShotConfigBuilder()
+        .add_modifiers(3000, {MONKEEB_MOD_LALT})
+        .build();
+    monkeyboard_config_packer_sources_t sources = {};
+    sources.oneshot = oneshot->config;
+    size_t blob_size = 0;
+    std::vector<uint32_t> blob = pack(sources, &blob_size);
+    monkeyboard_config_blob_pipelines_t loaded;
+    void* ram[16];
+
+    EXPECT_EQ(monkeyboard_config_blob_validate(blob.data(), blob_size), MONKEYBOARD_CONFIG_BLOB_OK);
+    EXPECT_EQ(monkeyboard_config_blob_load(blob.data(), blob_size - 1, ram, sizeof(ram), &loaded), MONKEYBOARD_CONFIG_BLOB_TRUNCATED);
+    EXPECT_EQ(monkeyboard_config_blob_load(blob.data(), blob_size, ram, 8, &loaded), MONKEYBOARD_CONFIG_BLOB_NO_RAM);
+
+    // A record count beyond the section
+    std::vector<uint32_t> bad_count = blob;
+    monkeyboard_config_blob_section_t* section = reinterpret_cast<monkeyboard_config_blob_section_t*>(
+        reinterpret_cast<uint8_t*>(bad_count.data()) + sizeof(monkeyboard_config_blob_header_t));
+    section->count = 2;
+    EXPECT_EQ(monkeyboard_config_blob_load(bad_count.data(), blob_size, ram, sizeof(ram), &loaded), MONKEYBOARD_CONFIG_BLOB_BAD_SECTION);
+
+    // A section placed past the end of the blob
+    std::vector<uint32_t> bad_offset = blob;
+    section = reinterpret_cast<monkeyboard_config_blob_section_t*>(
+        reinterpret_cast<uint8_t*>(bad_offset.data()) + sizeof(monkeyboard_config_blob_header_t));
+    section->offset = reinterpret_cast<monkeyboard_config_blob_header_t*>(bad_offset.data())->total_size + MONKEYBOARD_CONFIG_BLOB_ALIGNMENT;
+    EXPECT_EQ(monkeyboard_config_blob_validate(bad_offset.data(), blob_size), MONKEYBOARD_CONFIG_BLOB_BAD_SECTION);
+    EXPECT_EQ(monkeyboard_config_blob_load(bad_offset.data(), blob_size, ram, sizeof(ram), &loaded), MONKEYBOARD_CONFIG_BLOB_BAD_SECTION);
+
+    std::vector<uint32_t> bad_version = blob;
+    reinterpret_cast<monkeyboard_config_blob_header_t*>(bad_version.data())->version = MONKEYBOARD_CONFIG_BLOB_VERSION + 1;
+    EXPECT_EQ(monkeyboard_config_blob_validate(bad_version.data(), blob_size), MONKEYBOARD_CONFIG_BLOB_BAD_VERSION);
+
+    std::vector<uint32_t> bad_magic = blob;
+    bad_magic[0] = 0;
+    EXPECT_EQ(monkeyboard_config_blob_validate(bad_magic.data(), blob_size), MONKEYBOARD_CONFIG_BLOB_BAD_MAGIC);
+}
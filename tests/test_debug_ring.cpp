@@ -0,0 +1,101 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "debug_ring_decoder.hpp"
+
+// The binary branch of the DEBUG_* macros, in this translation unit only
+#define MONKEYBOARD_DEBUG_BINARY
+extern "C" {
+#include "monkeyboard_debug.h"
+#include "monkeyboard_debug_ring.h"
+}
+
+class DebugRingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        monkeyboard_debug_ring_reset();
+    }
+
+    void TearDown() override {
+        monkeyboard_debug_ring_reset();
+    }
+
+    static std::vector<uint64_t> drain(size_t max_words = MONKEYBOARD_DEBUG_RING_WORDS) {
+        std::vector<monkeyboard_debug_word_t> words(max_words);
+        size_t count = monkeyboard_debug_ring_read(words.data(), max_words);
+        return std::vector<uint64_t>(words.begin(), words.begin() + static_cast<std::ptrdiff_t>(count));
+    }
+};
+
+// The DEBUG_* macros store the format and the raw arguments, the decoder formats them as printf would
+TEST_F(DebugRingTest, DecodesTheDebugMacros) {
+    uint16_t keycode = 42;
+    uint8_t row = 3;
+    const char* name = "COMBO";
+    DEBUG_PRINT_PREFIX("[TEST] ", "K:%04u, P:%d", keycode, 1);
+    DEBUG_PRINT("%s at row %03hhu", name, row);
+    DEBUG_PRINT_ERROR("%d", -5);
+    DEBUG_PRINT_RAW("no arguments");
+    DEBUG_PRINT_NL();
+
+    std::vector<uint64_t> words = drain();
+    EXPECT_EQ(words.size(), 5u * MONKEYBOARD_DEBUG_RECORD_HEADER_WORDS + 2u + 2u + 1u);
+    EXPECT_EQ(DebugRingDecoder().decode(words),
+              "[TEST] K:0042, P:1\n"
+              "COMBO at row 003\n"
+              "# ERROR #: -5\n"
+              "no arguments\n");
+    EXPECT_EQ(monkeyboard_debug_ring.dropped_records, 0u);
+}
+
+// A record that doesn't fit is dropped whole and counted, the records already in the ring are kept
+TEST_F(DebugRingTest, FullRingDropsRecords) {
+    const size_t record_words = MONKEYBOARD_DEBUG_RECORD_HEADER_WORDS + 1;
+    const size_t fitting = MONKEYBOARD_DEBUG_RING_WORDS / record_words;
+    for (size_t i = 0; i < fitting + 10; i++) {
+        DEBUG_PRINT_RAW("%u,", static_cast<unsigned>(i));
+    }
+    EXPECT_EQ(monkeyboard_debug_ring.dropped_records, 10u);
+
+    std::vector<uint64_t> words = drain();
+    ASSERT_EQ(words.size(), fitting * record_words);
+    std::string expected;
+    for (size_t i = 0; i < fitting; i++) {
+        expected += std::to_string(i) + ",";
+    }
+    EXPECT_EQ(DebugRingDecoder().decode(words), expected);
+}
+
+// Records written across the end of the ring and drained in parts decode in order
+TEST_F(DebugRingTest, WrapsAroundAcrossDrains) {
+    std::string expected;
+    std::string decoded;
+    unsigned value = 0;
+    for (int round = 0; round < 50; round++) {
+        for (int i = 0; i < 37; i++, value++) {
+            DEBUG_PRINT_RAW("%u:%u:%u;", value, value * 2, value * 3);
+            expected += std::to_string(value) + ":" + std::to_string(value * 2) + ":" + std::to_string(value * 3) + ";";
+        }
+        // Smaller than the words written, the rest stays for the next drain. Never splits a record
+        std::vector<uint64_t> words = drain(173);
+        EXPECT_EQ(words.size() % (MONKEYBOARD_DEBUG_RECORD_HEADER_WORDS + 3), 0u);
+        decoded += DebugRingDecoder().decode(words);
+    }
+    for (std::vector<uint64_t> words = drain(); !words.empty(); words = drain()) {
+        decoded += DebugRingDecoder().decode(words);
+    }
+    EXPECT_EQ(decoded, expected);
+    EXPECT_EQ(monkeyboard_debug_ring.dropped_records, 0u);
+}
+
+// Decoding a firmware dump: the strings are read from the image section, an address outside it (a string that isn't
+// a literal) is flagged instead of read
+TEST_F(DebugRingTest, FlagsStringsOutsideTheImage) {
+    const uint64_t base = 0x08004000;
+    const std::string rodata = std::string("%s and %s\0KEY", 14);
+    DebugRingDecoder decoder(DebugRingDecoder::resolve_in_image(base, std::vector<char>(rodata.begin(), rodata.end())));
+
+    std::vector<uint64_t> words = { base, 2, base + 10, 0x20001000 };
+    EXPECT_EQ(decoder.decode(words), "KEY and <outside the image 0x20001000>");
+}
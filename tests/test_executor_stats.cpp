@@ -0,0 +1,140 @@
+#include <cstdint>
+#include <vector>
+#include "keyboard_simulator.hpp"
+#include "gtest/gtest.h"
+#include "platform_interface.h"
+#include "platform_mock.hpp"
+#include "platform_types.h"
+#include "test_scenario.hpp"
+#include "combo_test_helpers.hpp"
+#include "tap_dance_test_helpers.hpp"
+
+extern "C" {
+#include "pipeline_executor.h"
+}
+
+// Executor statistics (MONKEYBOARD_EXECUTOR_STATS, enabled on the unit tests)
+class ExecutorStats : public ::testing::Test {
+protected:
+    static constexpr platform_keycode_t COMBO_KEY_A = 3000;
+    static constexpr platform_keycode_t COMBO_KEY_B = 3001;
+    static constexpr platform_keycode_t TAP_DANCE_KEY = 3002;
+    static constexpr platform_keycode_t KEY_A = 4;
+    static constexpr platform_keycode_t KEY_B = 5;
+    static constexpr platform_keycode_t COMBO_OUTPUT = 7;
+    static constexpr platform_keycode_t TAP_OUTPUT = 8;
+
+    std::vector<std::vector<std::vector<platform_keycode_t>>> keymap = {{
+        { COMBO_KEY_A, COMBO_KEY_B, TAP_DANCE_KEY, KEY_A, KEY_B }
+    }};
+
+    void add_tap_dance(TestScenario& scenario) {
+        TapDanceConfigBuilder tap_dance_builder;
+        tap_dance_builder
+            .add_tap_hold(TAP_DANCE_KEY, {{1, TAP_OUTPUT}}, {{1, 1}}, 200, 200, TAP_DANCE_TAP_PREFERRED)
+            .add_to_scenario(scenario);
+    }
+
+    void add_combo(TestScenario& scenario) {
+        ComboConfigBuilder config_builder;
+        std::vector<ComboKeyBuilder> combo_keys = { ComboKeyBuilder({0, 0}), ComboKeyBuilder({0, 1}) };
+        config_builder
+            .with_strategy(COMBO_STRATEGY_DISCARD_WHEN_ONE_PRESSED_IN_COMMON)
+            .add_combo(combo_keys, create_combo_key_action(COMBO_KEY_ACTION_REGISTER, COMBO_OUTPUT), create_combo_key_action(COMBO_KEY_ACTION_UNREGISTER, COMBO_OUTPUT))
+            .add_to_scenario(scenario);
+    }
+};
+
+// A key no pipeline holds back goes once through each pipeline, without captures or timers
+TEST_F(ExecutorStats, PlainKeysGoStraightThrough) {
+    TestScenario scenario(keymap);
+    add_tap_dance(scenario);
+    scenario.build();
+
+    scenario.keyboard().tap_key(KEY_A, 10, 20);
+
+    const pipeline_executor_stats_t* stats = pipeline_executor_get_stats();
+    EXPECT_EQ(stats->events_ingested, 2u);
+    EXPECT_EQ(stats->events_bypassed, 0u);
+    EXPECT_EQ(stats->physical_callbacks[0], 2u);
+    EXPECT_EQ(stats->replays, 0u);
+    EXPECT_EQ(stats->captures_started, 0u);
+    EXPECT_EQ(stats->timers_scheduled, 0u);
+    EXPECT_EQ(stats->event_buffer_high_water, 1);
+    EXPECT_EQ(stats->virtual_buffer_high_water, 1);
+}
+
+// Keys pressed while the tap dance decides wait on the event buffer. The hold timeout fires once and is cancelled
+// by the tap of the second sequence
+TEST_F(ExecutorStats, CapturesAndTimers) {
+    TestScenario scenario(keymap);
+    add_tap_dance(scenario);
+    scenario.build();
+
+    KeyboardSimulator& keyboard = scenario.keyboard();
+    keyboard.press_key_at(TAP_DANCE_KEY, 0);
+    keyboard.press_key_at(KEY_A, 20);
+    keyboard.press_key_at(KEY_B, 30);
+    keyboard.wait_ms(300);
+    keyboard.release_key_at(KEY_A, 320);
+    keyboard.release_key_at(KEY_B, 330);
+    keyboard.release_key_at(TAP_DANCE_KEY, 340);
+    keyboard.tap_key(TAP_DANCE_KEY, 500, 50);
+    keyboard.wait_ms(300);
+
+    const pipeline_executor_stats_t* stats = pipeline_executor_get_stats();
+    EXPECT_EQ(stats->events_ingested, 8u);
+    EXPECT_EQ(stats->event_buffer_high_water, 3);
+    EXPECT_EQ(stats->timer_fires, 1u);
+    EXPECT_GE(stats->timers_scheduled, 2u);
+    EXPECT_GE(stats->timers_cancelled, 1u);
+    EXPECT_GE(stats->captures_started, 2u);
+    EXPECT_EQ(stats->captures_started, stats->captures_ended);
+}
+
+// A pipeline capturing an event buffered behind another pipeline's capture gets the following events replayed
+TEST_F(ExecutorStats, ReplaysAfterAnEarlierCapture) {
+    TestScenario scenario(keymap);
+    add_combo(scenario);
+    add_tap_dance(scenario);
+    scenario.build();
+
+    KeyboardSimulator& keyboard = scenario.keyboard();
+    keyboard.press_key_at(COMBO_KEY_A, 0);
+    keyboard.press_key_at(TAP_DANCE_KEY, 10);
+    keyboard.press_key_at(KEY_A, 20);
+    keyboard.wait_ms(300);
+
+    const pipeline_executor_stats_t* stats = pipeline_executor_get_stats();
+    EXPECT_GT(stats->replays, 0u);
+    EXPECT_GT(stats->max_replays_per_event, 0u);
+    EXPECT_LE(stats->max_replays_per_event, stats->replays);
+    EXPECT_GT(stats->physical_callbacks[0], 0u);
+    EXPECT_GT(stats->physical_callbacks[1], 0u);
+}
+
+// An overflow reset ends the capture and leaves the high-water mark at the capacity, and the counters go back to zero
+// on request
+TEST_F(ExecutorStats, OverflowResetsAndReset) {
+    TestScenario scenario(keymap);
+    add_tap_dance(scenario);
+    scenario.build();
+
+    KeyboardSimulator& keyboard = scenario.keyboard();
+    keyboard.press_key_at(TAP_DANCE_KEY, 0);
+    for (uint16_t i = 0; i < PLATFORM_KEY_EVENT_MAX_ELEMENTS; i++) {
+        keyboard.press_key_at(KEY_A, 1 + i * 2);
+        keyboard.release_key_at(KEY_A, 2 + i * 2);
+    }
+
+    const pipeline_executor_stats_t* stats = pipeline_executor_get_stats();
+    EXPECT_GE(pipeline_executor_get_overflow_stats()->resets, 1u);
+    EXPECT_EQ(stats->captures_ended, stats->captures_started);
+    EXPECT_EQ(stats->event_buffer_high_water, PLATFORM_KEY_EVENT_MAX_ELEMENTS);
+
+    pipeline_executor_reset_stats();
+    EXPECT_EQ(pipeline_executor_get_overflow_stats()->resets, 0u);
+    EXPECT_EQ(stats->events_ingested, 0u);
+    EXPECT_EQ(stats->captures_started, 0u);
+    EXPECT_EQ(stats->event_buffer_high_water, 0);
+}
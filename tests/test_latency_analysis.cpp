@@ -0,0 +1,155 @@
+#include <cstdint>
+#include <vector>
+#include "keyboard_simulator.hpp"
+#include "gtest/gtest.h"
+#include "platform_interface.h"
+#include "platform_mock.hpp"
+#include "platform_types.h"
+#include "test_scenario.hpp"
+#include "combo_test_helpers.hpp"
+#include "tap_dance_test_helpers.hpp"
+
+extern "C" {
+#include "monkeyboard_latency_analysis.h"
+#include "pipeline_combo.h"
+#include "pipeline_tap_dance.h"
+}
+
+// Static delay of each key computed from the configuration, checked against the delay measured on the simulator
+class LatencyAnalysis : public ::testing::Test {
+protected:
+    static constexpr platform_keycode_t COMBO_KEY_A = 3000;
+    static constexpr platform_keycode_t COMBO_KEY_B = 3001;
+    static constexpr platform_keycode_t TAP_HOLD_KEY = 3002;
+    static constexpr platform_keycode_t MULTI_TAP_KEY = 3003;
+    static constexpr platform_keycode_t KEY_A = 4;
+    static constexpr platform_keycode_t COMBO_OUTPUT = 7;
+    static constexpr platform_keycode_t TAP_OUTPUT = 8;
+    static constexpr platform_keycode_t DOUBLE_TAP_OUTPUT = 9;
+
+    std::vector<std::vector<std::vector<platform_keycode_t>>> keymap = {
+        {{ COMBO_KEY_A, COMBO_KEY_B, TAP_HOLD_KEY, MULTI_TAP_KEY, KEY_A }},
+        {{ KEY_A,       KEY_A,       KEY_A,        KEY_A,         KEY_A }}
+    };
+
+    pipeline_combo_global_config_t* combo_config = nullptr;
+    pipeline_tap_dance_global_config_t* tap_dance_config = nullptr;
+
+    void add_pipelines(TestScenario& scenario, uint32_t hold_timeout, uint32_t tap_timeout) {
+        ComboConfigBuilder combo_builder;
+        std::vector<ComboKeyBuilder> combo_keys = { ComboKeyBuilder({0, 0}), ComboKeyBuilder({0, 1}) };
+        combo_builder
+            .with_strategy(COMBO_STRATEGY_DISCARD_WHEN_ONE_PRESSED_IN_COMMON)
+            .add_combo(combo_keys, create_combo_key_action(COMBO_KEY_ACTION_REGISTER, COMBO_OUTPUT), create_combo_key_action(COMBO_KEY_ACTION_UNREGISTER, COMBO_OUTPUT));
+        pipeline_combo_global_state_create();
+        combo_config = combo_builder.build();
+        scenario.add_physical_pipeline(&pipeline_combo_callback_process_data_executor, &pipeline_combo_callback_reset_executor, combo_config);
+
+        TapDanceConfigBuilder tap_dance_builder;
+        tap_dance_builder
+            .add_tap_hold(TAP_HOLD_KEY, {{1, TAP_OUTPUT}}, {{1, 1}}, hold_timeout, tap_timeout, TAP_DANCE_HOLD_PREFERRED)
+            .add_tap_hold(MULTI_TAP_KEY, {{1, TAP_OUTPUT}, {2, DOUBLE_TAP_OUTPUT}}, {}, hold_timeout, tap_timeout);
+        pipeline_tap_dance_global_state_create();
+        tap_dance_config = tap_dance_builder.build();
+        scenario.add_physical_pipeline(&pipeline_tap_dance_callback_process_data_executor, &pipeline_tap_dance_callback_reset_executor, tap_dance_config);
+    }
+
+    monkeyboard_latency_analysis_config_t analysis_config(uint16_t typical_tap_ms) {
+        monkeyboard_latency_analysis_config_t config;
+        monkeyboard_latency_analysis_config_init(&config, combo_config, tap_dance_config);
+        config.typical_tap_ms = typical_tap_ms;
+        return config;
+    }
+
+    static platform_keypos_t keypos(uint8_t col) {
+        platform_keypos_t position;
+        position.row = 0;
+        position.col = col;
+        return position;
+    }
+};
+
+// Plain keys have no delay, combo keys the combo interval, tap dance keys their timeouts
+TEST_F(LatencyAnalysis, KeyDelaysFollowTheConfiguration) {
+    TestScenario scenario(keymap);
+    add_pipelines(scenario, 200, 150);
+    scenario.build();
+    monkeyboard_latency_analysis_config_t config = analysis_config(100);
+
+    monkeyboard_key_latency_t plain = monkeyboard_latency_analysis_key(&config, 0, keypos(4));
+    EXPECT_EQ(plain.sources, 0);
+    EXPECT_EQ(plain.worst_ms, 0u);
+    EXPECT_EQ(plain.typical_ms, 0u);
+
+    monkeyboard_key_latency_t combo = monkeyboard_latency_analysis_key(&config, 0, keypos(0));
+    EXPECT_EQ(combo.sources, MONKEYBOARD_LATENCY_COMBO);
+    EXPECT_EQ(combo.worst_ms, (uint32_t)PIPELINE_COMBO_INTERVAL_TIMEOUT_MS);
+    EXPECT_EQ(combo.typical_ms, (uint32_t)PIPELINE_COMBO_INTERVAL_TIMEOUT_MS);
+
+    // Without multi-tap the hold timeout bounds the delay, a tap is sent on its release
+    monkeyboard_key_latency_t tap_hold = monkeyboard_latency_analysis_key(&config, 0, keypos(2));
+    EXPECT_EQ(tap_hold.sources, MONKEYBOARD_LATENCY_HOLD);
+    EXPECT_EQ(tap_hold.worst_ms, 200u);
+    EXPECT_EQ(tap_hold.typical_ms, 100u);
+
+    // The first tap waits for its release and then the tap timeout, the second one is sent on press
+    monkeyboard_key_latency_t multi_tap = monkeyboard_latency_analysis_key(&config, 0, keypos(3));
+    EXPECT_EQ(multi_tap.sources, MONKEYBOARD_LATENCY_MULTI_TAP | MONKEYBOARD_LATENCY_WAITS_FOR_RELEASE);
+    EXPECT_EQ(multi_tap.worst_ms, 150u);
+    EXPECT_EQ(multi_tap.typical_ms, 250u);
+
+    // The tap dance keys are not on layer 1, the combo key positions are
+    EXPECT_EQ(monkeyboard_latency_analysis_key(&config, 1, keypos(2)).sources, 0);
+    EXPECT_EQ(monkeyboard_latency_analysis_key(&config, 1, keypos(0)).sources, MONKEYBOARD_LATENCY_COMBO);
+}
+
+// The layer result is the worst of its keys, for a CI check on a latency budget
+TEST_F(LatencyAnalysis, LayerWorstCase) {
+    TestScenario scenario(keymap);
+    add_pipelines(scenario, 200, 150);
+    scenario.build();
+    monkeyboard_latency_analysis_config_t config = analysis_config(100);
+
+    uint16_t keys_with_delay = 0;
+    monkeyboard_key_latency_t base = monkeyboard_latency_analysis_layer(&config, 0, 1, 5, &keys_with_delay);
+    EXPECT_EQ(base.worst_ms, 200u);
+    EXPECT_EQ(base.typical_ms, 250u);
+    EXPECT_EQ(keys_with_delay, 4);
+
+    monkeyboard_key_latency_t upper = monkeyboard_latency_analysis_layer(&config, 1, 1, 5, &keys_with_delay);
+    EXPECT_EQ(upper.worst_ms, (uint32_t)PIPELINE_COMBO_INTERVAL_TIMEOUT_MS);
+    EXPECT_EQ(upper.sources, MONKEYBOARD_LATENCY_COMBO);
+    EXPECT_EQ(keys_with_delay, 2);
+}
+
+#if defined(MONKEYBOARD_EVENT_ORIGIN)
+// The typical delay matches the delay measured on a tap held typical_tap_ms, and no tap goes over the worst case
+TEST_F(LatencyAnalysis, MatchesTheSimulator) {
+    TestScenario scenario(keymap);
+    add_pipelines(scenario, 200, 150);
+    scenario.build();
+    monkeyboard_latency_analysis_config_t config = analysis_config(120);
+
+    KeyboardSimulator& keyboard = scenario.keyboard();
+    keyboard.press_key_at(COMBO_KEY_A, 0);
+    keyboard.release_key_at(COMBO_KEY_A, 120);
+    keyboard.press_key_at(TAP_HOLD_KEY, 1000);
+    keyboard.release_key_at(TAP_HOLD_KEY, 1120);
+    keyboard.wait_ms(1000);
+    LatencyReport typical = g_mock_state.added_latency();
+    std::map<platform_time_t, size_t> expected = {
+        {monkeyboard_latency_analysis_key(&config, 0, keypos(0)).typical_ms, 1},
+        {monkeyboard_latency_analysis_key(&config, 0, keypos(2)).typical_ms, 1}
+    };
+    EXPECT_EQ(typical.histogram, expected);
+
+    // Released just before the hold timeout
+    g_mock_state.reset();
+    keyboard.press_key_at(TAP_HOLD_KEY, 3000);
+    keyboard.release_key_at(TAP_HOLD_KEY, 3199);
+    keyboard.wait_ms(1000);
+    LatencyReport worst = g_mock_state.added_latency();
+    EXPECT_EQ(worst.count, 1u);
+    EXPECT_LE(worst.max, monkeyboard_latency_analysis_key(&config, 0, keypos(2)).worst_ms);
+}
+#endif
@@ -0,0 +1,125 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "gtest/gtest.h"
+#include "platform_interface.h"
+#include "platform_mock.hpp"
+#include "platform_types.h"
+#include "test_scenario.hpp"
+
+extern "C" {
+#include "monkeyboard_layer_manager.h"
+}
+
+class LayerManager : public ::testing::Test {
+protected:
+    std::vector<std::vector<std::vector<platform_keycode_t>>> keymap = {
+        {{ 3000, 3001, 3002, 3003 }},
+        {{ 3100, 3101, 3102, 3103 }},
+        {{ 3200, 3201, 3202, 3203 }},
+        {{ 3300, 3301, 3302, 3303 }}
+    };
+
+    static platform_keypos_t keypos(uint8_t col) {
+        platform_keypos_t position;
+        position.row = 0;
+        position.col = col;
+        return position;
+    }
+};
+
+// The newest layer is active, removing a layer below it doesn't change the active layer
+TEST_F(LayerManager, NewestLayerWinsAndMiddleRemovalKeepsActiveLayer) {
+    TestScenario scenario(keymap);
+    scenario.build();
+
+    layout_manager_add_layer(keypos(0), 1, 1);
+    layout_manager_add_layer(keypos(1), 2, 3);
+    layout_manager_add_layer(keypos(2), 3, 2);
+    layout_manager_remove_layer_by_press_id(2);
+    layout_manager_remove_layer_by_press_id(3);
+    layout_manager_remove_layer_by_press_id(1);
+
+    std::vector<event_t> expected_events = {
+        td_layer(1),
+        td_layer(3),
+        td_layer(2),
+        td_layer(1),
+        td_layer(0)
+    };
+    EXPECT_TRUE(g_mock_state.event_actions_match_relative(expected_events));
+}
+
+// Removing the oldest layers many times reuses the slots without losing the activation order
+TEST_F(LayerManager, SlotsAreCompactedKeepingActivationOrder) {
+    TestScenario scenario(keymap);
+    scenario.build();
+
+    layout_manager_add_layer(keypos(0), 1, 1);
+    for (uint8_t i = 0; i < MAX_NUM_NESTED_LAYERS * 2; i++) {
+        layout_manager_add_layer(keypos(1 + (i % 2)), i + 2, 2 + (i % 2));
+        if (i > 0) layout_manager_remove_layer_by_press_id(i + 1); // The layer of the previous iteration
+    }
+    g_mock_state.events.clear();
+
+    // The last layer added (layer 3, col 2) is active, the first one (layer 1, col 0) is still below it
+    layout_manager_remove_layer_by_press_id(MAX_NUM_NESTED_LAYERS * 2 + 1);
+    layout_manager_remove_layer_by_press_id(1);
+
+    std::vector<event_t> expected_events = {
+        td_layer(1),
+        td_layer(0)
+    };
+    EXPECT_TRUE(g_mock_state.event_actions_match_relative(expected_events));
+}
+
+// Layers beyond the maximum number of nested layers are ignored
+TEST_F(LayerManager, LayersBeyondMaximumAreIgnored) {
+    TestScenario scenario(keymap);
+    scenario.build();
+
+    for (uint8_t i = 0; i < MAX_NUM_NESTED_LAYERS; i++) {
+        layout_manager_add_layer(keypos(0), i + 1, 1);
+    }
+    layout_manager_add_layer(keypos(1), MAX_NUM_NESTED_LAYERS + 1, 2);
+
+    EXPECT_EQ(g_mock_state.events.size(), (size_t)MAX_NUM_NESTED_LAYERS);
+    EXPECT_EQ(platform_layout_get_current_layer(), 1);
+}
+
+// The owner table removes the layer of the released key from anywhere in the stack (docs/multi-tap.md): a middle
+// layer leaves the newest one active, the top layer gives back the one below. A press id without a layer changes
+// nothing
+TEST_F(LayerManager, RemovesMiddleAndTopLayersByOwner) {
+    TestScenario scenario(keymap);
+    scenario.build();
+
+    layout_manager_add_layer(keypos(0), 5, 1);
+    layout_manager_add_layer(keypos(1), 6, 2);
+    layout_manager_add_layer(keypos(2), 7, 3);
+    EXPECT_EQ(platform_layout_get_current_layer(), 3);
+
+    layout_manager_remove_layer_by_press_id(6);
+    EXPECT_EQ(platform_layout_get_current_layer(), 3);
+    EXPECT_EQ(platform_layout_get_keycode(keypos(3)), 3303u);
+
+    layout_manager_remove_layer_by_press_id(7);
+    EXPECT_EQ(platform_layout_get_current_layer(), 1);
+    EXPECT_EQ(platform_layout_get_keycode(keypos(3)), 3103u);
+
+    layout_manager_remove_layer_by_press_id(6);
+    layout_manager_remove_layer_by_press_id(9);
+    EXPECT_EQ(platform_layout_get_current_layer(), 1);
+
+    layout_manager_remove_layer_by_press_id(5);
+    EXPECT_EQ(platform_layout_get_current_layer(), 0);
+
+    std::vector<event_t> expected_events = {
+        td_layer(1),
+        td_layer(2),
+        td_layer(3),
+        td_layer(1),
+        td_layer(0)
+    };
+    EXPECT_TRUE(g_mock_state.event_actions_match_relative(expected_events));
+}
@@ -0,0 +1,57 @@
+#include <cstdint>
+#include <vector>
+#include "event_buffer_test_helpers.hpp"
+#include "gtest/gtest.h"
+#include "platform_interface.h"
+#include "platform_mock.hpp"
+#include "platform_types.h"
+#include "test_scenario.hpp"
+
+extern "C" {
+#include "key_event_buffer.h"
+}
+
+class LayerReresolution : public ::testing::Test {
+protected:
+    std::vector<std::vector<std::vector<platform_keycode_t>>> keymap = {
+        {{ 3000, 3001, 3002, 3003 }},
+        {{ 3100, 3101, 3102, 3103 }}
+    };
+};
+
+// The bulk re-resolution gives the same keycodes as changing each event on its own
+TEST_F(LayerReresolution, MatchesChangingEachEvent) {
+    TestScenario scenario(keymap);
+    scenario.build();
+    EventBufferManager bulk;
+    EventBufferManager one_by_one;
+
+    for (EventBufferManager* buffer : { &bulk, &one_by_one }) {
+        // Key 0 was pressed before: its release keeps the keycode sent for the press
+        buffer->add_physical_press(0, 0, 0, 3000);
+        platform_key_event_remove_physical_press_by_press_id(buffer->get(), buffer->get_event(0)->press_id);
+        buffer->add_physical_press(10, 0, 1, 3001);
+        buffer->add_physical_release(20, 0, 0);
+        buffer->add_physical_press(30, 0, 2, 3002);
+        buffer->add_physical_release(40, 0, 1);
+        // Outside the events of the pipeline
+        buffer->add_physical_press(50, 0, 3, 3003);
+    }
+
+    platform_key_event_change_keycodes_from_layer(bulk.get(), 4, 1);
+    for (uint8_t i = 0; i < 4; i++) {
+        platform_key_event_t* event = one_by_one.get_event(i);
+        platform_key_event_change_keycode(one_by_one.get(), event->press_id, platform_layout_get_keycode_from_layer(1, event->keypos));
+    }
+
+    std::vector<platform_keycode_t> expected_keycodes = { 3101, 3000, 3102, 3101, 3003 };
+    ASSERT_EQ(bulk.get_event_count(), expected_keycodes.size());
+    for (uint8_t i = 0; i < expected_keycodes.size(); i++) {
+        EXPECT_EQ(bulk.get_event(i)->keycode, expected_keycodes[i]);
+        EXPECT_EQ(one_by_one.get_event(i)->keycode, expected_keycodes[i]);
+    }
+    ASSERT_EQ(bulk.get_press_count(), one_by_one.get_press_count());
+    for (uint8_t i = 0; i < bulk.get_press_count(); i++) {
+        EXPECT_EQ(bulk.get_press(i)->keycode, one_by_one.get_press(i)->keycode);
+    }
+}
@@ -0,0 +1,85 @@
+#include <cstddef>
+#include <cstdint>
+#include "gtest/gtest.h"
+#include "platform_interface.h"
+#include "platform_mock.hpp"
+#include "platform_types.h"
+
+extern "C" {
+#include "key_event_buffer.h"
+#include "key_virtual_buffer.h"
+#include "monkeyboard_memory.h"
+#include "pipeline_tap_dance_initializer.h"
+}
+
+static size_t exhausted_calls = 0;
+static size_t exhausted_requested = 0;
+
+static void record_exhaustion(size_t requested) {
+    exhausted_calls++;
+    exhausted_requested = requested;
+}
+
+class MemoryArena : public ::testing::Test {
+protected:
+    alignas(std::max_align_t) static uint8_t arena[4096];
+
+    void SetUp() override {
+        exhausted_calls = 0;
+        exhausted_requested = 0;
+        monkeyboard_memory_set_exhausted_handler(record_exhaustion);
+        monkeyboard_memory_set_arena(arena, sizeof(arena));
+    }
+
+    void TearDown() override {
+        monkeyboard_memory_set_arena(NULL, 0);
+        monkeyboard_memory_set_exhausted_handler(NULL);
+    }
+
+    static bool in_arena(const void* ptr) {
+        return static_cast<const uint8_t*>(ptr) >= arena && static_cast<const uint8_t*>(ptr) < arena + sizeof(arena);
+    }
+};
+
+alignas(std::max_align_t) uint8_t MemoryArena::arena[4096];
+
+// Buffers and initializers are allocated from the arena, aligned for any type
+TEST_F(MemoryArena, AllocationsComeFromTheArena) {
+    platform_key_event_buffer_t* event_buffer = platform_key_event_create();
+    platform_virtual_event_buffer_t* virtual_buffer = platform_virtual_event_create();
+    pipeline_tap_dance_action_config_t* action = createbehaviouraction_tap(1, 3000);
+
+    EXPECT_TRUE(in_arena(event_buffer));
+    EXPECT_TRUE(in_arena(virtual_buffer));
+    EXPECT_TRUE(in_arena(action));
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(virtual_buffer) % alignof(std::max_align_t), 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(action) % alignof(std::max_align_t), 0u);
+    EXPECT_GE(monkeyboard_memory_arena_used(), sizeof(platform_key_event_buffer_t) + sizeof(platform_virtual_event_buffer_t) + sizeof(pipeline_tap_dance_action_config_t));
+    EXPECT_EQ(exhausted_calls, 0u);
+}
+
+// The high-water mark is kept when the arena is reset
+TEST_F(MemoryArena, HighWaterMarkSurvivesReset) {
+    monkeyboard_malloc(100);
+    monkeyboard_malloc(200);
+    size_t used = monkeyboard_memory_arena_used();
+    EXPECT_GE(used, 300u);
+
+    monkeyboard_memory_reset_arena();
+    EXPECT_EQ(monkeyboard_memory_arena_used(), 0u);
+    monkeyboard_malloc(10);
+
+    EXPECT_EQ(monkeyboard_memory_arena_high_water_mark(), used);
+}
+
+// An allocation the arena can't serve calls the exhausted handler and returns NULL
+TEST_F(MemoryArena, ExhaustionCallsTheHandler) {
+    EXPECT_NE(monkeyboard_malloc(sizeof(arena) - 64), nullptr);
+    EXPECT_EQ(monkeyboard_malloc(128), nullptr);
+
+    EXPECT_EQ(exhausted_calls, 1u);
+    EXPECT_EQ(exhausted_requested, 128u);
+    // The failed allocation doesn't use the arena
+    EXPECT_LE(monkeyboard_memory_arena_used(), sizeof(arena));
+    EXPECT_NE(monkeyboard_malloc(32), nullptr);
+}
@@ -0,0 +1,123 @@
+#include <cstdint>
+#include <vector>
+#include "keyboard_simulator.hpp"
+#include "gtest/gtest.h"
+#include "platform_interface.h"
+#include "platform_mock.hpp"
+#include "platform_types.h"
+#include "test_scenario.hpp"
+#include "combo_test_helpers.hpp"
+#include "tap_dance_test_helpers.hpp"
+
+extern "C" {
+#include "monkeyboard_output_queue.h"
+#include "pipeline_executor.h"
+}
+
+// The latency is measured from the origin of the outputs
+#if defined(MONKEYBOARD_EVENT_ORIGIN)
+
+// Latency added by the pipelines, from the physical key event to the output it causes
+class OutputLatency : public ::testing::Test {
+protected:
+    static constexpr platform_keycode_t COMBO_KEY_A = 3000;
+    static constexpr platform_keycode_t COMBO_KEY_B = 3001;
+    static constexpr platform_keycode_t TAP_DANCE_KEY = 3002;
+    static constexpr platform_keycode_t KEY_A = 4;
+    static constexpr platform_keycode_t KEY_B = 5;
+    static constexpr platform_keycode_t KEY_C = 6;
+    static constexpr platform_keycode_t COMBO_OUTPUT = 7;
+    static constexpr platform_keycode_t TAP_OUTPUT = 8;
+
+    std::vector<std::vector<std::vector<platform_keycode_t>>> keymap = {{
+        { COMBO_KEY_A, COMBO_KEY_B, TAP_DANCE_KEY, KEY_A, KEY_B, KEY_C }
+    }};
+
+    void add_combo(TestScenario& scenario) {
+        ComboConfigBuilder config_builder;
+        std::vector<ComboKeyBuilder> combo_keys = { ComboKeyBuilder({0, 0}), ComboKeyBuilder({0, 1}) };
+        config_builder
+            .with_strategy(COMBO_STRATEGY_DISCARD_WHEN_ONE_PRESSED_IN_COMMON)
+            .add_combo(combo_keys, create_combo_key_action(COMBO_KEY_ACTION_REGISTER, COMBO_OUTPUT), create_combo_key_action(COMBO_KEY_ACTION_UNREGISTER, COMBO_OUTPUT))
+            .add_to_scenario(scenario);
+    }
+};
+
+// Keys outside the combo and the tap dance go through the pipelines within the same millisecond
+TEST_F(OutputLatency, NonComboKeysAddUnder1ms) {
+    TestScenario scenario(keymap);
+    add_combo(scenario);
+    TapDanceConfigBuilder tap_dance_builder;
+    tap_dance_builder
+        .add_tap_hold(TAP_DANCE_KEY, {{1, TAP_OUTPUT}}, {{1, 1}}, 200, 200, TAP_DANCE_HOLD_PREFERRED)
+        .add_to_scenario(scenario);
+    scenario.build();
+
+    KeyboardSimulator& keyboard = scenario.keyboard();
+    platform_time_t time = 0;
+    for (uint8_t i = 0; i < 20; i++) {
+        platform_keycode_t key = KEY_A + i % 3;
+        platform_keycode_t next = KEY_A + (i + 1) % 3;
+        keyboard.press_key_at(key, time += 30);
+        keyboard.press_key_at(next, time += 20); // Rollover
+        keyboard.release_key_at(key, time += 10);
+        keyboard.release_key_at(next, time += 30);
+    }
+
+    LatencyReport latency = g_mock_state.added_latency();
+    EXPECT_EQ(latency.count, 40u);
+    EXPECT_LT(latency.max, 1u);
+}
+
+// A combo key pressed alone is held back for the combo interval, the tap dance tap until its release
+TEST_F(OutputLatency, HeldBackKeysAddTheirDecisionTime) {
+    TestScenario scenario(keymap);
+    add_combo(scenario);
+    TapDanceConfigBuilder tap_dance_builder;
+    tap_dance_builder
+        .add_tap_hold(TAP_DANCE_KEY, {{1, TAP_OUTPUT}}, {{1, 1}}, 200, 200, TAP_DANCE_HOLD_PREFERRED)
+        .add_to_scenario(scenario);
+    scenario.build();
+
+    KeyboardSimulator& keyboard = scenario.keyboard();
+    keyboard.press_key_at(COMBO_KEY_A, 0);
+    keyboard.release_key_at(COMBO_KEY_A, 200);
+    keyboard.press_key_at(TAP_DANCE_KEY, 300);
+    keyboard.release_key_at(TAP_DANCE_KEY, 420);
+    keyboard.press_key_at(COMBO_KEY_A, 600);
+    keyboard.press_key_at(COMBO_KEY_B, 620);
+    keyboard.release_key_at(COMBO_KEY_A, 700);
+    keyboard.release_key_at(COMBO_KEY_B, 700);
+    keyboard.tap_key(KEY_A, 800, 20);
+    keyboard.wait_ms(500);
+
+    LatencyReport latency = g_mock_state.added_latency();
+    // Combo interval (50), tap dance tap (120), combo (20, the second key completes it) and a plain key (0)
+    std::map<platform_time_t, size_t> expected = {{0, 1}, {20, 1}, {50, 1}, {120, 1}};
+    EXPECT_EQ(latency.histogram, expected);
+    EXPECT_EQ(latency.count, 4u);
+    EXPECT_EQ(latency.p50, 20u);
+    EXPECT_EQ(latency.p99, 120u);
+    EXPECT_EQ(latency.max, 120u);
+}
+
+// Outputs deferred on the output queue keep their origin until the transport task executes them
+TEST_F(OutputLatency, OutputQueueKeepsTheOrigin) {
+    TestScenario scenario(keymap);
+    scenario.build();
+    monkeyboard_output_queue_t* queue = monkeyboard_output_queue_create();
+    pipeline_executor_set_output_queue(queue);
+
+    KeyboardSimulator& keyboard = scenario.keyboard();
+    keyboard.press_key_at(KEY_A, 10);
+    keyboard.press_key_at(KEY_B, 12);
+    g_mock_state.set_timer(16);
+    monkeyboard_output_queue_drain(queue, MONKEYBOARD_OUTPUT_QUEUE_MAX_ELEMENTS);
+    pipeline_executor_set_output_queue(NULL);
+
+    LatencyReport latency = g_mock_state.added_latency();
+    std::map<platform_time_t, size_t> expected = {{4, 1}, {6, 1}};
+    EXPECT_EQ(latency.histogram, expected);
+}
+
+#endif
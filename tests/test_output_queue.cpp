@@ -0,0 +1,189 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "keyboard_simulator.hpp"
+#include "gtest/gtest.h"
+#include "platform_interface.h"
+#include "platform_mock.hpp"
+#include "platform_types.h"
+#include "test_scenario.hpp"
+#include "key_replacer_test_helpers.hpp"
+
+extern "C" {
+#include "monkeyboard_memory.h"
+#include "monkeyboard_output_action.h"
+#include "monkeyboard_output_queue.h"
+#include "pipeline_executor.h"
+}
+
+class OutputQueue : public ::testing::Test {
+protected:
+    monkeyboard_output_queue_t* queue = nullptr;
+
+    // Output action without origin
+    static monkeyboard_output_action_t make_action(platform_keycode_t keycode, monkeyboard_output_action_type_t type) {
+        monkeyboard_output_action_t action = {};
+        action.keycode = keycode;
+        action.type = type;
+        return action;
+    }
+
+    void SetUp() override {
+        queue = monkeyboard_output_queue_create();
+    }
+
+    void TearDown() override {
+        pipeline_executor_set_output_queue(NULL);
+        monkeyboard_free(queue);
+    }
+};
+
+// Push and pop keep the order of the actions
+TEST_F(OutputQueue, PopReturnsActionsInPushOrder) {
+    for (platform_keycode_t keycode = 1; keycode <= 3; keycode++) {
+        monkeyboard_output_action_t action = make_action(keycode, MONKEYBOARD_OUTPUT_REGISTER);
+        EXPECT_TRUE(monkeyboard_output_queue_push(queue, &action));
+    }
+    EXPECT_EQ(monkeyboard_output_queue_count(queue), 3);
+
+    monkeyboard_output_action_t action;
+    for (platform_keycode_t keycode = 1; keycode <= 3; keycode++) {
+        EXPECT_TRUE(monkeyboard_output_queue_pop(queue, &action));
+        EXPECT_EQ(action.keycode, keycode);
+    }
+    EXPECT_FALSE(monkeyboard_output_queue_pop(queue, &action));
+}
+
+// A full queue drops the new actions and counts them
+TEST_F(OutputQueue, FullQueueDropsActions) {
+    monkeyboard_output_action_t action = make_action(4, MONKEYBOARD_OUTPUT_REPORT_ADD);
+    for (int i = 0; i < MONKEYBOARD_OUTPUT_QUEUE_MAX_ELEMENTS; i++) {
+        EXPECT_TRUE(monkeyboard_output_queue_push(queue, &action));
+    }
+    EXPECT_FALSE(monkeyboard_output_queue_push(queue, &action));
+    EXPECT_EQ(queue->dropped, 1u);
+    EXPECT_EQ(monkeyboard_output_queue_count(queue), MONKEYBOARD_OUTPUT_QUEUE_MAX_ELEMENTS);
+}
+
+// The executor records the output actions on the queue and nothing reaches the platform until the queue is drained
+TEST_F(OutputQueue, ExecutorDefersOutputUntilDrained) {
+    const platform_keycode_t KEY = 100;
+    const platform_keycode_t OUTPUT_KEY1 = 101;
+    const platform_keycode_t OUTPUT_KEY2 = 102;
+    const platform_keycode_t PLAIN_KEY = 3000;
+
+    std::vector<std::vector<std::vector<platform_keycode_t>>> keymap = {{
+        { KEY, PLAIN_KEY }
+    }};
+
+    TestScenario scenario(keymap);
+    KeyReplacerConfigBuilder config_builder;
+    config_builder
+        .add_replacement(KEY, { OUTPUT_KEY1 }, { OUTPUT_KEY2 })
+        .add_to_scenario(scenario);
+
+    scenario.build();
+    pipeline_executor_set_output_queue(queue);
+    KeyboardSimulator& keyboard = scenario.keyboard();
+
+    keyboard.press_key(KEY);
+    keyboard.release_key(KEY);
+    keyboard.press_key(PLAIN_KEY);
+    keyboard.release_key(PLAIN_KEY);
+
+    EXPECT_TRUE(g_mock_state.events.empty());
+    EXPECT_EQ(monkeyboard_output_queue_count(queue), 6);
+
+    EXPECT_EQ(monkeyboard_output_queue_drain(queue, UINT16_MAX), 6);
+
+    std::vector<event_t> expected_events = {
+        td_report_press(OUTPUT_KEY1, 0),
+        td_report_send(0),
+        td_report_release(OUTPUT_KEY2, 0),
+        td_report_send(0),
+        td_press(PLAIN_KEY, 0),
+        td_release(PLAIN_KEY, 0)
+    };
+    EXPECT_TRUE(g_mock_state.event_actions_match_relative(expected_events));
+}
+
+// The presses leave the reserve of a nearly full queue to the releases, so a held key is always released on the host
+TEST_F(OutputQueue, FullQueueStillDeliversReleases) {
+    const platform_keycode_t KEY_A = 3000;
+    const platform_keycode_t KEY_B = 3001;
+    const platform_keycode_t FILLER_KEY = 50;
+
+    std::vector<std::vector<std::vector<platform_keycode_t>>> keymap = {{
+        { KEY_A, KEY_B }
+    }};
+
+    TestScenario scenario(keymap);
+    scenario.build();
+    pipeline_executor_set_output_queue(queue);
+    KeyboardSimulator& keyboard = scenario.keyboard();
+
+    // One slot left before the reserve
+    monkeyboard_output_action_t filler = make_action(FILLER_KEY, MONKEYBOARD_OUTPUT_REPORT_ADD);
+    for (int i = 0; i < MONKEYBOARD_OUTPUT_QUEUE_MAX_ELEMENTS - MONKEYBOARD_OUTPUT_QUEUE_RELEASE_RESERVE - 1; i++) {
+        ASSERT_TRUE(monkeyboard_output_queue_push(queue, &filler));
+    }
+    keyboard.press_key(KEY_A);
+    keyboard.press_key(KEY_B); // Dropped, only the releases fit
+    keyboard.release_key(KEY_A);
+    keyboard.release_key(KEY_B);
+
+    const pipeline_executor_overflow_stats_t* stats = pipeline_executor_get_overflow_stats();
+    EXPECT_EQ(stats->dropped_outputs, 1u);
+    EXPECT_EQ(stats->dropped_releases, 0u);
+    EXPECT_EQ(queue->dropped, 1u);
+
+    monkeyboard_output_action_t action;
+    std::vector<monkeyboard_output_action_t> actions;
+    while (monkeyboard_output_queue_pop(queue, &action)) {
+        if (action.keycode != FILLER_KEY) actions.push_back(action);
+    }
+    ASSERT_EQ(actions.size(), 3u);
+    EXPECT_EQ(actions[0].keycode, KEY_A);
+    EXPECT_EQ(actions[0].type, MONKEYBOARD_OUTPUT_REGISTER);
+    EXPECT_EQ(actions[1].keycode, KEY_A);
+    EXPECT_EQ(actions[1].type, MONKEYBOARD_OUTPUT_UNREGISTER);
+    EXPECT_EQ(actions[2].keycode, KEY_B);
+    EXPECT_EQ(actions[2].type, MONKEYBOARD_OUTPUT_UNREGISTER);
+}
+
+// Stress test: a producer and a consumer running on separate threads never lose, duplicate or reorder actions
+TEST_F(OutputQueue, ConcurrentProducerAndConsumer) {
+    const uint32_t TOTAL_ACTIONS = 200000;
+
+    std::thread producer([this, TOTAL_ACTIONS]() {
+        for (uint32_t i = 0; i < TOTAL_ACTIONS; i++) {
+            monkeyboard_output_action_t action = make_action(i, MONKEYBOARD_OUTPUT_REPORT_ADD);
+            while (!monkeyboard_output_queue_push(queue, &action)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t expected = 0;
+    bool in_order = true;
+    std::thread consumer([this, TOTAL_ACTIONS, &expected, &in_order]() {
+        monkeyboard_output_action_t action;
+        while (expected < TOTAL_ACTIONS) {
+            if (!monkeyboard_output_queue_pop(queue, &action)) {
+                std::this_thread::yield();
+                continue;
+            }
+            if (action.keycode != expected) in_order = false;
+            expected++;
+        }
+    });
+
+    producer.join();
+    consumer.join();
+
+    EXPECT_TRUE(in_order);
+    EXPECT_EQ(expected, TOTAL_ACTIONS);
+    EXPECT_EQ(monkeyboard_output_queue_count(queue), 0);
+}
@@ -0,0 +1,125 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include "keyboard_simulator.hpp"
+#include "gtest/gtest.h"
+#include "platform_interface.h"
+#include "platform_mock.hpp"
+#include "platform_types.h"
+#include "test_scenario.hpp"
+#include "key_replacer_test_helpers.hpp"
+
+extern "C" {
+#include "monkeyboard_memory.h"
+#include "monkeyboard_output_scheduler.h"
+#include "pipeline_executor.h"
+}
+
+class OutputScheduler : public ::testing::Test {
+protected:
+    monkeyboard_output_scheduler_t* scheduler = nullptr;
+
+    // Output action without origin
+    static monkeyboard_output_action_t make_action(platform_keycode_t keycode, monkeyboard_output_action_type_t type) {
+        monkeyboard_output_action_t action = {};
+        action.keycode = keycode;
+        action.type = type;
+        return action;
+    }
+
+    void SetUp() override {
+        scheduler = monkeyboard_output_scheduler_create(MONKEYBOARD_OUTPUT_SCHEDULER_INTERVAL_LOW_SPEED, NULL);
+    }
+
+    void TearDown() override {
+        pipeline_executor_set_output_scheduler(NULL);
+        monkeyboard_output_scheduler_reset(scheduler);
+        monkeyboard_free(scheduler);
+    }
+};
+
+// A macro is played back at one report per interval, keeping the order of the actions
+TEST_F(OutputScheduler, MacroIsPacedOneReportPerInterval) {
+    const platform_keycode_t KEY = 100;
+    const platform_keycode_t OUTPUT_KEY1 = 101;
+    const platform_keycode_t OUTPUT_KEY2 = 102;
+    const platform_keycode_t OUTPUT_KEY3 = 103;
+
+    std::vector<std::vector<std::vector<platform_keycode_t>>> keymap = {{
+        { KEY }
+    }};
+
+    TestScenario scenario(keymap);
+    KeyReplacerConfigBuilder config_builder;
+    config_builder
+        .add_replacement(KEY, { OUTPUT_KEY1, OUTPUT_KEY2 }, { OUTPUT_KEY3 })
+        .add_to_scenario(scenario);
+
+    scenario.build();
+    pipeline_executor_set_output_scheduler(scheduler);
+    KeyboardSimulator& keyboard = scenario.keyboard();
+
+    keyboard.press_key_at(KEY, 0);
+    keyboard.release_key_at(KEY, 1);
+    keyboard.press_key_at(KEY, 2);
+    keyboard.release_key_at(KEY, 3);
+    keyboard.wait_ms(50);
+
+    std::vector<event_t> expected_events = {
+        td_report_press(OUTPUT_KEY1, 0),
+        td_report_press(OUTPUT_KEY2, 0),
+        td_report_send(0),
+        td_report_release(OUTPUT_KEY3, 8),
+        td_report_send(8),
+        td_report_press(OUTPUT_KEY1, 16),
+        td_report_press(OUTPUT_KEY2, 16),
+        td_report_send(16),
+        td_report_release(OUTPUT_KEY3, 24),
+        td_report_send(24)
+    };
+    EXPECT_TRUE(g_mock_state.event_actions_match_absolute(expected_events));
+}
+
+// Keys registered by the default path produce their own report and are paced as a frame each
+TEST_F(OutputScheduler, RegisteredKeysArePacedAndIdleSchedulerEmitsImmediately) {
+    const platform_keycode_t KEY = 3000;
+
+    std::vector<std::vector<std::vector<platform_keycode_t>>> keymap = {{
+        { KEY }
+    }};
+
+    TestScenario scenario(keymap);
+    scenario.build();
+    pipeline_executor_set_output_scheduler(scheduler);
+    KeyboardSimulator& keyboard = scenario.keyboard();
+
+    keyboard.press_key_at(KEY, 0);
+    keyboard.release_key_at(KEY, 2);
+    keyboard.press_key_at(KEY, 30);
+    keyboard.release_key_at(KEY, 50);
+
+    std::vector<event_t> expected_events = {
+        td_press(KEY, 0),
+        td_release(KEY, 8),
+        td_press(KEY, 30),
+        td_release(KEY, 50)
+    };
+    EXPECT_TRUE(g_mock_state.event_actions_match_absolute(expected_events));
+}
+
+// When the scheduler is full the oldest frame is emitted early, so no action is lost
+TEST_F(OutputScheduler, FullSchedulerEmitsOldestFrameEarly) {
+    g_mock_state.reset();
+    monkeyboard_output_action_t action = make_action(4, MONKEYBOARD_OUTPUT_REGISTER);
+    for (int i = 0; i < MONKEYBOARD_OUTPUT_SCHEDULER_MAX_ELEMENTS + 2; i++) {
+        monkeyboard_output_scheduler_push(scheduler, &action);
+    }
+    // The first frame is emitted immediately, the next one early to make room
+    EXPECT_EQ(g_mock_state.events.size(), 2u);
+    EXPECT_EQ(scheduler->overruns, 1u);
+    EXPECT_EQ(monkeyboard_output_scheduler_count(scheduler), MONKEYBOARD_OUTPUT_SCHEDULER_MAX_ELEMENTS);
+
+    monkeyboard_output_scheduler_flush(scheduler);
+    EXPECT_EQ(g_mock_state.events.size(), (size_t)MONKEYBOARD_OUTPUT_SCHEDULER_MAX_ELEMENTS + 2);
+}
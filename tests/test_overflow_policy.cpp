@@ -0,0 +1,120 @@
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "keyboard_simulator.hpp"
+#include "gtest/gtest.h"
+#include "platform_interface.h"
+#include "platform_mock.hpp"
+#include "platform_types.h"
+#include "test_scenario.hpp"
+
+extern "C" {
+#include "key_event_buffer.h"
+#include "pipeline_executor.h"
+}
+
+// Holds back every key event for 200ms after the trigger key is pressed, as a tap dance deciding between tap and hold
+typedef struct {
+    platform_keycode_t trigger;
+    uint8_t resolved_press_id;
+} hold_back_pipeline_t;
+
+static void hold_back_callback(pipeline_physical_callback_params_t* params, const pipeline_physical_actions_t* actions, const pipeline_physical_return_actions_t* return_actions, void* user_data) {
+    hold_back_pipeline_t* pipeline = static_cast<hold_back_pipeline_t*>(user_data);
+    if (params->callback_type == PIPELINE_CALLBACK_TIMER) {
+        pipeline->resolved_press_id = actions->get_physical_key_event_fn(0)->press_id;
+        return_actions->no_capture_fn();
+        return;
+    }
+    if (params->is_capturing_keys) {
+        return_actions->key_capture_fn(PIPELINE_EXECUTOR_TIMEOUT_PREVIOUS, 0);
+        return;
+    }
+    platform_key_event_t* event = params->key_event;
+    if (event->is_press && event->keycode == pipeline->trigger && event->press_id != pipeline->resolved_press_id) {
+        return_actions->key_capture_fn(PIPELINE_EXECUTOR_TIMEOUT_NEW, 200);
+        return;
+    }
+    return_actions->no_capture_fn();
+}
+
+static void hold_back_reset(void* user_data) {
+    (void)user_data;
+}
+
+class OverflowPolicy : public ::testing::Test {
+protected:
+    static constexpr platform_keycode_t TRIGGER = 3000;
+    static constexpr uint8_t KEY_COUNT = 8;
+
+    std::vector<std::vector<std::vector<platform_keycode_t>>> keymap = {
+        {{ TRIGGER, 3001, 3002, 3003, 3004, 3005, 3006, 3007, 3008 }}
+    };
+    hold_back_pipeline_t pipeline = { TRIGGER, 0 };
+
+    // Holds the trigger and types every other key faster than the hold back timeout, with room for 4 events
+    std::vector<std::pair<event_type_t, platform_keycode_t>> type_roll(pipeline_executor_overflow_policy_t policy) {
+        EventBufferManager event_buffer(platform_key_event_create_with_capacity(4, 10, false));
+        TestScenario scenario(keymap, event_buffer);
+        scenario.add_physical_pipeline(&hold_back_callback, &hold_back_reset, &pipeline);
+        scenario.build();
+        pipeline_executor_set_overflow_policy(policy);
+
+        KeyboardSimulator& keyboard = scenario.keyboard();
+        keyboard.press_key_at(TRIGGER, 0);
+        for (uint8_t i = 1; i <= KEY_COUNT; i++) {
+            keyboard.press_key_at(TRIGGER + i, 10 * i);
+            keyboard.release_key_at(TRIGGER + i, 10 * i + 5);
+        }
+        keyboard.release_key_at(TRIGGER, 500);
+
+        std::vector<std::pair<event_type_t, platform_keycode_t>> actions;
+        for (const event_t& event : g_mock_state.events) {
+            actions.push_back({ event.type, event.keycode });
+        }
+        return actions;
+    }
+
+    static std::vector<std::pair<event_type_t, platform_keycode_t>> every_key_in_order() {
+        std::vector<std::pair<event_type_t, platform_keycode_t>> actions = {{ event_type_t::KEY_PRESS, TRIGGER }};
+        for (uint8_t i = 1; i <= KEY_COUNT; i++) {
+            actions.push_back({ event_type_t::KEY_PRESS, TRIGGER + i });
+            actions.push_back({ event_type_t::KEY_RELEASE, TRIGGER + i });
+        }
+        actions.push_back({ event_type_t::KEY_RELEASE, TRIGGER });
+        return actions;
+    }
+};
+
+// The default policy resets the executor, losing the buffered events
+TEST_F(OverflowPolicy, ResetLosesTheBufferedEvents) {
+    std::vector<std::pair<event_type_t, platform_keycode_t>> actions = type_roll(PIPELINE_EXECUTOR_OVERFLOW_RESET);
+
+    const pipeline_executor_overflow_stats_t* stats = pipeline_executor_get_overflow_stats();
+    EXPECT_GE(stats->resets, 1u);
+    EXPECT_GT(stats->dropped_events, 0u);
+    EXPECT_LT(actions.size(), every_key_in_order().size());
+}
+
+// Firing the timeout of the capturing pipeline early frees the buffer without losing events
+TEST_F(OverflowPolicy, ForceResolveKeepsEveryEvent) {
+    std::vector<std::pair<event_type_t, platform_keycode_t>> actions = type_roll(PIPELINE_EXECUTOR_OVERFLOW_FORCE_RESOLVE);
+
+    const pipeline_executor_overflow_stats_t* stats = pipeline_executor_get_overflow_stats();
+    EXPECT_EQ(stats->overflows, 1u);
+    EXPECT_EQ(stats->forced_resolutions, 1u);
+    EXPECT_EQ(stats->resets, 0u);
+    EXPECT_EQ(stats->dropped_events, 0u);
+    EXPECT_EQ(actions, every_key_in_order());
+}
+
+// Flushing the oldest event to the virtual stage frees the buffer without losing events
+TEST_F(OverflowPolicy, FlushOldestKeepsEveryEvent) {
+    std::vector<std::pair<event_type_t, platform_keycode_t>> actions = type_roll(PIPELINE_EXECUTOR_OVERFLOW_FLUSH_OLDEST);
+
+    const pipeline_executor_overflow_stats_t* stats = pipeline_executor_get_overflow_stats();
+    EXPECT_EQ(stats->overflows, 1u);
+    EXPECT_EQ(stats->flushed_events, 1u);
+    EXPECT_EQ(stats->resets, 0u);
+    EXPECT_EQ(actions, every_key_in_order());
+}
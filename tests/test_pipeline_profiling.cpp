@@ -0,0 +1,138 @@
+#include <cstdint>
+#include <vector>
+#include "keyboard_simulator.hpp"
+#include "gtest/gtest.h"
+#include "platform_interface.h"
+#include "platform_mock.hpp"
+#include "platform_types.h"
+#include "test_scenario.hpp"
+
+extern "C" {
+#include "pipeline_executor.h"
+}
+
+// Physical pipeline that costs a fixed number of cycles per callback. The trigger key is held back 100ms
+typedef struct {
+    platform_keycode_t trigger;
+    uint32_t press_cycles;
+    uint32_t release_cycles;
+    uint32_t timer_cycles;
+} costly_physical_pipeline_t;
+
+static void costly_physical_callback(pipeline_physical_callback_params_t* params, const pipeline_physical_actions_t* actions, const pipeline_physical_return_actions_t* return_actions, void* user_data) {
+    (void)actions;
+    costly_physical_pipeline_t* pipeline = static_cast<costly_physical_pipeline_t*>(user_data);
+    if (params->callback_type == PIPELINE_CALLBACK_TIMER) {
+        g_mock_state.cycles += pipeline->timer_cycles;
+        return_actions->no_capture_fn();
+        return;
+    }
+    platform_key_event_t* event = params->key_event;
+    g_mock_state.cycles += event->is_press ? pipeline->press_cycles : pipeline->release_cycles;
+    if (event->is_press && event->keycode == pipeline->trigger && !params->is_capturing_keys) {
+        return_actions->key_capture_fn(PIPELINE_EXECUTOR_TIMEOUT_NEW, 100);
+        return;
+    }
+    return_actions->no_capture_fn();
+}
+
+static void costly_virtual_callback(pipeline_virtual_callback_params_t* params, const pipeline_virtual_actions_t* actions, void* user_data) {
+    (void)params;
+    (void)actions;
+    g_mock_state.cycles += *static_cast<uint32_t*>(user_data);
+}
+
+static void costly_reset(void* user_data) {
+    (void)user_data;
+}
+
+class PipelineProfiling : public ::testing::Test {
+protected:
+    static constexpr platform_keycode_t TRIGGER = 3000;
+    static constexpr platform_keycode_t KEY_A = 4;
+
+    std::vector<std::vector<std::vector<platform_keycode_t>>> keymap = {{
+        { TRIGGER, KEY_A }
+    }};
+    costly_physical_pipeline_t costly = { TRIGGER, 500, 100, 200 };
+    costly_physical_pipeline_t free_of_cost = { 0, 0, 0, 0 };
+    uint32_t virtual_cycles = 30;
+
+    void build(TestScenario& scenario) {
+        scenario.add_physical_pipeline(&costly_physical_callback, &costly_reset, &costly);
+        scenario.add_physical_pipeline(&costly_physical_callback, &costly_reset, &free_of_cost);
+        scenario.add_virtual_pipeline(&costly_virtual_callback, &costly_reset, &virtual_cycles);
+        scenario.build();
+        g_mock_state.manual_cycles = true; // The callbacks advance the counter by their cost
+    }
+};
+
+// Key event and timer callbacks are profiled apart, per pipeline
+TEST_F(PipelineProfiling, CyclesPerPipelineAndCallbackType) {
+    TestScenario scenario(keymap);
+    build(scenario);
+
+    KeyboardSimulator& keyboard = scenario.keyboard();
+    keyboard.tap_key(KEY_A, 10, 20);
+    keyboard.press_key_at(TRIGGER, 100);
+    keyboard.release_key_at(TRIGGER, 300);
+
+    const pipeline_executor_profiling_t* profiling = pipeline_executor_get_profiling();
+    const pipeline_executor_profile_t& costly_key_events = profiling->physical_key_events[0];
+    EXPECT_EQ(costly_key_events.calls, 4u);
+    EXPECT_EQ(costly_key_events.min_cycles, 100u);
+    EXPECT_EQ(costly_key_events.max_cycles, 500u);
+    EXPECT_EQ(costly_key_events.total_cycles, 1200u);
+
+    const pipeline_executor_profile_t& costly_timers = profiling->physical_timers[0];
+    EXPECT_EQ(costly_timers.calls, 1u);
+    EXPECT_EQ(costly_timers.total_cycles, 200u);
+
+    EXPECT_EQ(profiling->physical_key_events[1].calls, 4u);
+    EXPECT_EQ(profiling->physical_key_events[1].max_cycles, 0u);
+    EXPECT_EQ(profiling->physical_timers[1].calls, 0u);
+
+    EXPECT_EQ(profiling->virtual_key_events[0].calls, 4u);
+    EXPECT_EQ(profiling->virtual_key_events[0].min_cycles, 30u);
+    EXPECT_EQ(profiling->virtual_key_events[0].total_cycles, 120u);
+}
+
+// The cycle counter can wrap between the start and the end of a callback
+TEST_F(PipelineProfiling, CounterWraps) {
+    TestScenario scenario(keymap);
+    build(scenario);
+    g_mock_state.cycles = UINT32_MAX - 200;
+
+    scenario.keyboard().press_key_at(KEY_A, 10);
+
+    EXPECT_EQ(pipeline_executor_get_profiling()->physical_key_events[0].max_cycles, 500u);
+}
+
+TEST_F(PipelineProfiling, Reset) {
+    TestScenario scenario(keymap);
+    build(scenario);
+    scenario.keyboard().tap_key(KEY_A, 10, 20);
+
+    pipeline_executor_reset_profiling();
+    const pipeline_executor_profile_t& profile = pipeline_executor_get_profiling()->physical_key_events[0];
+    EXPECT_EQ(profile.calls, 0u);
+    EXPECT_EQ(profile.min_cycles, UINT32_MAX);
+    EXPECT_EQ(profile.max_cycles, 0u);
+    EXPECT_EQ(profile.total_cycles, 0u);
+}
+
+// By default the mock reads the host clock, so the simulator sessions are profiled with their real cost
+TEST_F(PipelineProfiling, HostClockByDefault) {
+    TestScenario scenario(keymap);
+    scenario.add_physical_pipeline(&costly_physical_callback, &costly_reset, &free_of_cost);
+    scenario.build();
+
+    uint32_t start = platform_cycle_count();
+    KeyboardSimulator& keyboard = scenario.keyboard();
+    for (platform_time_t time = 10; time < 1000; time += 10) {
+        keyboard.tap_key(KEY_A, time, 5);
+    }
+
+    EXPECT_NE(platform_cycle_count(), start);
+    EXPECT_GT(pipeline_executor_get_profiling()->physical_key_events[0].total_cycles, 0u);
+}
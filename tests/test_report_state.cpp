@@ -0,0 +1,176 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include "keyboard_simulator.hpp"
+#include "gtest/gtest.h"
+#include "platform_interface.h"
+#include "platform_mock.hpp"
+#include "platform_types.h"
+#include "test_scenario.hpp"
+#include "key_replacer_test_helpers.hpp"
+
+extern "C" {
+#include "monkeyboard_keycodes.h"
+#include "monkeyboard_memory.h"
+#include "monkeyboard_report_state.h"
+#include "pipeline_executor.h"
+}
+
+class ReportState : public ::testing::Test {
+protected:
+    monkeyboard_report_state_t* report_state = nullptr;
+
+    void SetUp() override {
+        report_state = monkeyboard_report_state_create();
+    }
+
+    void TearDown() override {
+        pipeline_executor_set_report_state(NULL);
+        monkeyboard_free(report_state);
+    }
+};
+
+static const platform_keycode_t KC_A = 0x04;
+static const platform_keycode_t KC_B = 0x05;
+
+// Adding a key already on the report doesn't change the report
+TEST_F(ReportState, RedundantAddDoesNotChangeReport) {
+    EXPECT_TRUE(monkeyboard_report_state_add(report_state, KC_A));
+    EXPECT_TRUE(monkeyboard_report_state_take_dirty(report_state));
+    EXPECT_FALSE(monkeyboard_report_state_add(report_state, KC_A));
+    EXPECT_FALSE(monkeyboard_report_state_take_dirty(report_state));
+    EXPECT_TRUE(monkeyboard_report_state_del(report_state, KC_A));
+    EXPECT_FALSE(monkeyboard_report_state_del(report_state, KC_A));
+}
+
+// Modifiers are reference counted and only released with the last key holding them
+TEST_F(ReportState, SharedModifierIsReleasedWithLastKey) {
+    monkeyboard_report_state_add(report_state, MONKEEB_LCTL(KC_A));
+    monkeyboard_report_state_add(report_state, MONKEEB_LCTL(KC_B));
+    EXPECT_EQ(report_state->mods, MONKEEB_MOD_LCTL);
+
+    monkeyboard_report_state_del(report_state, MONKEEB_LCTL(KC_A));
+    EXPECT_EQ(report_state->mods, MONKEEB_MOD_LCTL);
+    EXPECT_FALSE(monkeyboard_report_state_has_key(report_state, KC_A));
+
+    monkeyboard_report_state_del(report_state, MONKEEB_LCTL(KC_B));
+    EXPECT_EQ(report_state->mods, 0);
+}
+
+// Keys beyond the sixth one are only reported on the NKRO bitmap
+TEST_F(ReportState, SeventhKeyOnlyOnNkroBitmap) {
+    for (platform_keycode_t keycode = KC_A; keycode < KC_A + 7; keycode++) {
+        monkeyboard_report_state_add(report_state, keycode);
+    }
+    for (uint8_t i = 0; i < MONKEYBOARD_REPORT_6KRO_KEYS; i++) {
+        EXPECT_EQ(report_state->keys[i], KC_A + i);
+    }
+    EXPECT_TRUE(monkeyboard_report_state_has_key(report_state, KC_A + 6));
+
+    // The freed 6KRO slot goes to the key only on the NKRO bitmap, the next key waits on the bitmap
+    monkeyboard_report_state_del(report_state, KC_A);
+    EXPECT_EQ(report_state->keys[0], KC_A + 6);
+    monkeyboard_report_state_add(report_state, KC_A + 7);
+    EXPECT_EQ(report_state->keys[0], KC_A + 6);
+    EXPECT_TRUE(monkeyboard_report_state_has_key(report_state, KC_A + 7));
+}
+
+// Releasing one of six keys while a seventh is held reports the seventh on the 6KRO array
+TEST_F(ReportState, SeventhKeyTakesTheFreedSlot) {
+    for (platform_keycode_t keycode = KC_A; keycode < KC_A + 7; keycode++) {
+        monkeyboard_report_state_add(report_state, keycode);
+    }
+    monkeyboard_report_state_del(report_state, KC_A + 3);
+
+    std::vector<uint8_t> keys(report_state->keys, report_state->keys + MONKEYBOARD_REPORT_6KRO_KEYS);
+    std::vector<uint8_t> expected = { KC_A, KC_A + 1, KC_A + 2, KC_A + 6, KC_A + 4, KC_A + 5 };
+    EXPECT_EQ(keys, expected);
+    EXPECT_FALSE(monkeyboard_report_state_has_key(report_state, KC_A + 3));
+
+    // Without keys left on the bitmap the slot stays free
+    monkeyboard_report_state_del(report_state, KC_A);
+    EXPECT_EQ(report_state->keys[0], 0);
+}
+
+// Unicode and custom keycodes are not part of the report
+TEST_F(ReportState, NonReportableKeycodesAreIgnored) {
+    EXPECT_FALSE(monkeyboard_report_state_add(report_state, UNICODE_KEYCODE_MIN));
+    EXPECT_FALSE(monkeyboard_report_state_add(report_state, CUSTOM_KEYCODE_MIN));
+    EXPECT_FALSE(monkeyboard_report_state_take_dirty(report_state));
+}
+
+// The executor only sends a report when the report changes
+TEST_F(ReportState, ExecutorCollapsesRedundantReports) {
+    const platform_keycode_t KEY1 = 100;
+    const platform_keycode_t KEY2 = 101;
+    const platform_keycode_t KEY3 = 102;
+
+    std::vector<std::vector<std::vector<platform_keycode_t>>> keymap = {{
+        { KEY1, KEY2, KEY3 }
+    }};
+
+    TestScenario scenario(keymap);
+    KeyReplacerConfigBuilder config_builder;
+    config_builder
+        .add_replacement(KEY1, { MONKEEB_LCTL(KC_A) }, { MONKEEB_LCTL(KC_A) })
+        .add_replacement(KEY2, { MONKEEB_LCTL(KC_B) }, { MONKEEB_LCTL(KC_B) })
+        .add_replacement(KEY3, { KC_A, KC_A }, { KC_B })
+        .add_to_scenario(scenario);
+
+    scenario.build();
+    pipeline_executor_set_report_state(report_state);
+    KeyboardSimulator& keyboard = scenario.keyboard();
+
+    keyboard.press_key(KEY1);
+    keyboard.press_key(KEY2);
+    keyboard.release_key(KEY1);
+    keyboard.release_key(KEY2);
+    keyboard.press_key(KEY3);
+    keyboard.release_key(KEY3);
+
+    std::vector<event_t> expected_events = {
+        td_report_press(PLATFORM_KC_LEFT_CTRL, 0),
+        td_report_press(KC_A, 0),
+        td_report_send(0),
+        td_report_press(KC_B, 0),
+        td_report_send(0),
+        td_report_release(KC_A, 0),
+        td_report_send(0),
+        td_report_release(PLATFORM_KC_LEFT_CTRL, 0),
+        td_report_release(KC_B, 0),
+        td_report_send(0),
+        td_report_press(KC_A, 0),
+        td_report_send(0)
+    };
+    EXPECT_TRUE(g_mock_state.event_actions_match_relative(expected_events));
+}
+
+// Keys not processed by any pipeline are added to the report instead of being registered one by one
+TEST_F(ReportState, ExecutorDefaultPathUsesReportState) {
+    const platform_keycode_t CUSTOM_KEY = CUSTOM_KEYCODE_MIN;
+
+    std::vector<std::vector<std::vector<platform_keycode_t>>> keymap = {{
+        { KC_A, CUSTOM_KEY }
+    }};
+
+    TestScenario scenario(keymap);
+    scenario.build();
+    pipeline_executor_set_report_state(report_state);
+    KeyboardSimulator& keyboard = scenario.keyboard();
+
+    keyboard.press_key(KC_A);
+    keyboard.press_key(CUSTOM_KEY);
+    keyboard.release_key(CUSTOM_KEY);
+    keyboard.release_key(KC_A);
+
+    std::vector<event_t> expected_events = {
+        td_report_press(KC_A, 0),
+        td_report_send(0),
+        td_press(CUSTOM_KEY, 0),
+        td_release(CUSTOM_KEY, 0),
+        td_report_release(KC_A, 0),
+        td_report_send(0)
+    };
+    EXPECT_TRUE(g_mock_state.event_actions_match_relative(expected_events));
+}
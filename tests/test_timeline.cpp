@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "keyboard_simulator.hpp"
+#include "gtest/gtest.h"
+#include "platform_interface.h"
+#include "platform_mock.hpp"
+#include "platform_types.h"
+#include "test_scenario.hpp"
+#include "combo_test_helpers.hpp"
+#include "tap_dance_test_helpers.hpp"
+#include "chrome_trace_exporter.hpp"
+
+extern "C" {
+#include "monkeyboard_timeline.h"
+#include "pipeline_executor.h"
+}
+
+// Timeline of a combo and a tap dance holding a layer. With MONKEYBOARD_CHROME_TRACE set to a path, the session is
+// written there as a Chrome trace
+class TimelineTest : public ::testing::Test {
+protected:
+    static constexpr platform_keycode_t COMBO_KEY_A = 3000;
+    static constexpr platform_keycode_t COMBO_KEY_B = 3001;
+    static constexpr platform_keycode_t TAP_DANCE_KEY = 3002;
+    static constexpr platform_keycode_t KEY_A = 4;
+    static constexpr platform_keycode_t KEY_B = 5;
+    static constexpr platform_keycode_t COMBO_OUTPUT = 7;
+    static constexpr platform_keycode_t TAP_OUTPUT = 8;
+
+    std::vector<std::vector<std::vector<platform_keycode_t>>> keymap = {
+        {{ COMBO_KEY_A, COMBO_KEY_B, TAP_DANCE_KEY, KEY_A }},
+        {{ KEY_B,       KEY_B,       TAP_DANCE_KEY, KEY_B }}
+    };
+
+    ChromeTraceExporter exporter;
+
+    void build(TestScenario& scenario) {
+        ComboConfigBuilder combo_builder;
+        std::vector<ComboKeyBuilder> combo_keys = { ComboKeyBuilder({0, 0}), ComboKeyBuilder({0, 1}) };
+        combo_builder
+            .with_strategy(COMBO_STRATEGY_DISCARD_WHEN_ONE_PRESSED_IN_COMMON)
+            .add_combo(combo_keys, create_combo_key_action(COMBO_KEY_ACTION_REGISTER, COMBO_OUTPUT), create_combo_key_action(COMBO_KEY_ACTION_UNREGISTER, COMBO_OUTPUT))
+            .add_to_scenario(scenario);
+        TapDanceConfigBuilder tap_dance_builder;
+        tap_dance_builder
+            .add_tap_hold(TAP_DANCE_KEY, {{1, TAP_OUTPUT}}, {{1, 1}}, 200, 200, TAP_DANCE_HOLD_PREFERRED)
+            .add_to_scenario(scenario);
+        scenario.build();
+        monkeyboard_timeline_set_sink(&ChromeTraceExporter::sink, &exporter);
+    }
+
+    void TearDown() override {
+        monkeyboard_timeline_set_sink(nullptr, nullptr);
+    }
+
+    std::vector<uint8_t> types() const {
+        std::vector<uint8_t> result;
+        for (const monkeyboard_timeline_event_t& event : exporter.events()) {
+            result.push_back(event.type);
+        }
+        return result;
+    }
+
+    size_t count(monkeyboard_timeline_event_type_t type) const {
+        size_t total = 0;
+        for (const monkeyboard_timeline_event_t& event : exporter.events()) {
+            if (event.type == type) total++;
+        }
+        return total;
+    }
+};
+
+// A combo key pressed alone is captured by the combo until its interval expires, then goes out as a regular key
+TEST_F(TimelineTest, CapturedKeyWaitsForTheTimer) {
+    TestScenario scenario(keymap);
+    build(scenario);
+    KeyboardSimulator& keyboard = scenario.keyboard();
+    keyboard.press_key_at(COMBO_KEY_A, 10);
+    keyboard.wait_ms(100);
+    keyboard.release_key_at(COMBO_KEY_A, 200);
+
+    const std::vector<monkeyboard_timeline_event_t>& events = exporter.events();
+    ASSERT_GE(events.size(), 4u);
+    EXPECT_EQ(events[0].type, MONKEYBOARD_TIMELINE_PHYSICAL_EVENT);
+    EXPECT_TRUE(events[0].pressed);
+    EXPECT_EQ(events[0].time, 10u);
+    EXPECT_EQ(events[1].type, MONKEYBOARD_TIMELINE_CAPTURE_START);
+    EXPECT_EQ(events[1].pipeline, 0u);
+    EXPECT_EQ(events[2].type, MONKEYBOARD_TIMELINE_TIMER_SCHEDULE);
+    EXPECT_EQ(events[2].pipeline, 0u);
+
+    std::vector<uint8_t> sequence = types();
+    auto fire = std::find(sequence.begin(), sequence.end(), MONKEYBOARD_TIMELINE_TIMER_FIRE);
+    ASSERT_NE(fire, sequence.end());
+    const monkeyboard_timeline_event_t& fired = events[static_cast<size_t>(fire - sequence.begin())];
+    EXPECT_EQ(fired.time, events[2].time + events[2].value);
+    auto capture_end = std::find(fire, sequence.end(), MONKEYBOARD_TIMELINE_CAPTURE_END);
+    auto output = std::find(fire, sequence.end(), MONKEYBOARD_TIMELINE_OUTPUT);
+    ASSERT_NE(capture_end, sequence.end());
+    ASSERT_NE(output, sequence.end());
+    EXPECT_LT(capture_end, output);
+    EXPECT_EQ(count(MONKEYBOARD_TIMELINE_CAPTURE_START), count(MONKEYBOARD_TIMELINE_CAPTURE_END));
+}
+
+// A tap dance hold changes the layer when its timeout fires and restores it on the release
+TEST_F(TimelineTest, HoldChangesTheLayer) {
+    TestScenario scenario(keymap);
+    build(scenario);
+    KeyboardSimulator& keyboard = scenario.keyboard();
+    keyboard.press_key_at(TAP_DANCE_KEY, 0);
+    keyboard.wait_ms(250);
+    keyboard.release_key_at(TAP_DANCE_KEY, 300);
+
+    std::vector<uint32_t> layers;
+    for (const monkeyboard_timeline_event_t& event : exporter.events()) {
+        if (event.type == MONKEYBOARD_TIMELINE_LAYER_CHANGE) layers.push_back(event.value);
+    }
+    EXPECT_EQ(layers, (std::vector<uint32_t>{1, 0}));
+    EXPECT_GE(count(MONKEYBOARD_TIMELINE_TIMER_FIRE), 1u);
+}
+
+// The exported trace has one record per event on its track, plus the track names
+TEST_F(TimelineTest, ExportsChromeTrace) {
+    TestScenario scenario(keymap);
+    build(scenario);
+    KeyboardSimulator& keyboard = scenario.keyboard();
+    keyboard.press_key_at(COMBO_KEY_A, 0);
+    keyboard.press_key_at(COMBO_KEY_B, 10);
+    keyboard.release_key_at(COMBO_KEY_A, 60);
+    keyboard.release_key_at(COMBO_KEY_B, 70);
+    keyboard.tap_key(KEY_A, 20, 30);
+    keyboard.press_key_at(TAP_DANCE_KEY, 200);
+    keyboard.wait_ms(250);
+    keyboard.release_key_at(TAP_DANCE_KEY, 500);
+
+    EXPECT_GT(count(MONKEYBOARD_TIMELINE_VIRTUAL_EVENT), 0u);
+    EXPECT_GT(count(MONKEYBOARD_TIMELINE_OUTPUT), 0u);
+    std::string json = exporter.json();
+    EXPECT_EQ(json.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0), 0u);
+    EXPECT_NE(json.find("\"name\":\"pipeline 0\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"press 0,0\",\"ph\":\"i\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"hold 0,2\",\"cat\":\"keys\",\"ph\":\"b\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"register 7\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"layer\",\"ph\":\"C\""), std::string::npos);
+    EXPECT_NE(json.find("\"end\":\"fired\""), std::string::npos);
+    EXPECT_EQ(json.substr(json.size() - 3), "]}\n");
+
+    const char* path = std::getenv("MONKEYBOARD_CHROME_TRACE");
+    if (path != nullptr) {
+        EXPECT_TRUE(exporter.write(path));
+    }
+}
+
+// A reset of the executor while a pipeline captures ends the capture and the timer it was waiting for, so the trace
+// has no open slices
+TEST_F(TimelineTest, ResetEndsTheCapture) {
+    TestScenario scenario(keymap);
+    build(scenario);
+    scenario.keyboard().press_key_at(COMBO_KEY_A, 10);
+    ASSERT_EQ(count(MONKEYBOARD_TIMELINE_CAPTURE_START), 1u);
+
+    pipeline_executor_reset_state();
+
+    const std::vector<monkeyboard_timeline_event_t>& events = exporter.events();
+    ASSERT_GE(events.size(), 2u);
+    const monkeyboard_timeline_event_t& capture_end = events[events.size() - 2];
+    const monkeyboard_timeline_event_t& timer_cancel = events[events.size() - 1];
+    EXPECT_EQ(capture_end.type, MONKEYBOARD_TIMELINE_CAPTURE_END);
+    EXPECT_EQ(capture_end.pipeline, 0u);
+    EXPECT_EQ(timer_cancel.type, MONKEYBOARD_TIMELINE_TIMER_CANCEL);
+    EXPECT_EQ(timer_cancel.pipeline, 0u);
+    EXPECT_EQ(count(MONKEYBOARD_TIMELINE_CAPTURE_END), 1u);
+}
@@ -0,0 +1,156 @@
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "keyboard_simulator.hpp"
+#include "gtest/gtest.h"
+#include "platform_interface.h"
+#include "platform_mock.hpp"
+#include "platform_types.h"
+#include "test_scenario.hpp"
+#include "tap_dance_test_helpers.hpp"
+#include "trace_replayer.hpp"
+
+extern "C" {
+#include "monkeyboard_trace.h"
+#include "pipeline_executor.h"
+#include "pipeline_tap_dance.h"
+}
+
+class KeyEventTrace : public ::testing::Test {
+protected:
+    static constexpr platform_keycode_t TAP_DANCE_KEY = 3000;
+
+    std::vector<std::vector<std::vector<platform_keycode_t>>> keymap = {
+        {{ TAP_DANCE_KEY, 3001, 3002 }, { 3003, 3004, 3005 }},
+        {{ 3100, 3101, 3102 }, { 3103, 3104, 3105 }}
+    };
+
+    static abskeyevent_t key_event(uint8_t row, uint8_t col, bool pressed, platform_time_t time) {
+        abskeyevent_t event;
+        event.keypos.row = row;
+        event.keypos.col = col;
+        event.pressed = pressed;
+        event.time = time;
+        return event;
+    }
+
+    static void append_to_vector(const uint8_t* data, size_t size, void* user_data) {
+        std::vector<uint8_t>* trace = static_cast<std::vector<uint8_t>*>(user_data);
+        trace->insert(trace->end(), data, data + size);
+    }
+
+    void build_tap_dance(TestScenario& scenario) {
+        TapDanceConfigBuilder config_builder;
+        config_builder
+            .add_tap_hold(TAP_DANCE_KEY, {{1, 3010}}, {{1, 1}}, 200, 200, TAP_DANCE_HOLD_PREFERRED)
+            .add_to_scenario(scenario);
+        scenario.build();
+    }
+};
+
+// Events are decoded as they were encoded, including long pauses and the time wrapping around
+TEST_F(KeyEventTrace, RoundTrip) {
+    std::vector<abskeyevent_t> events = {
+        key_event(0, 0, true, 0xFFFFFF00), key_event(1, 2, true, 0xFFFFFF10), key_event(0, 0, false, 0x20),
+        key_event(1, 2, false, 0x00100000), key_event(5, 11, true, 0x00100001)
+    };
+    uint8_t buffer[MONKEYBOARD_TRACE_HEADER_SIZE + 5 * MONKEYBOARD_TRACE_MAX_RECORD_SIZE];
+    monkeyboard_trace_encoder_t encoder;
+    size_t size = monkeyboard_trace_write_header(buffer, 12, 0xFFFFFF00);
+    monkeyboard_trace_encoder_init(&encoder, 12, 0xFFFFFF00);
+    for (const abskeyevent_t& event : events) {
+        size += monkeyboard_trace_encode_event(&encoder, event, buffer + size);
+    }
+    // 2 bytes per event with deltas under 128ms and key indexes under 64, more for the long pause and key 71
+    EXPECT_EQ(size, (size_t)MONKEYBOARD_TRACE_HEADER_SIZE + 2 + 2 + 3 + 4 + 3);
+
+    monkeyboard_trace_reader_t reader;
+    ASSERT_TRUE(monkeyboard_trace_reader_init(&reader, buffer, size));
+    for (const abskeyevent_t& expected : events) {
+        abskeyevent_t event;
+        ASSERT_TRUE(monkeyboard_trace_read_event(&reader, &event));
+        EXPECT_EQ(event.keypos.row, expected.keypos.row);
+        EXPECT_EQ(event.keypos.col, expected.keypos.col);
+        EXPECT_EQ(event.pressed, expected.pressed);
+        EXPECT_EQ(event.time, expected.time);
+    }
+    abskeyevent_t event;
+    EXPECT_FALSE(monkeyboard_trace_read_event(&reader, &event));
+
+    // A truncated record is not decoded
+    ASSERT_TRUE(monkeyboard_trace_reader_init(&reader, buffer, size - 1));
+    for (size_t i = 0; i < events.size() - 1; i++) {
+        EXPECT_TRUE(monkeyboard_trace_read_event(&reader, &event));
+    }
+    EXPECT_FALSE(monkeyboard_trace_read_event(&reader, &event));
+
+    buffer[0] = 'X';
+    EXPECT_FALSE(monkeyboard_trace_reader_init(&reader, buffer, size));
+}
+
+// A session recorded by the executor and replayed from a memory mapped file produces the same output
+TEST_F(KeyEventTrace, RecordedSessionReplaysTheSameOutput) {
+    std::vector<uint8_t> trace;
+    uint8_t record_buffer[32]; // Flushed several times along the session
+    monkeyboard_trace_recorder_t recorder;
+    std::vector<event_t> recorded_output;
+    {
+        TestScenario scenario(keymap);
+        build_tap_dance(scenario);
+        ASSERT_TRUE(monkeyboard_trace_recorder_init(&recorder, record_buffer, sizeof(record_buffer), 3, 0, &append_to_vector, &trace));
+        pipeline_executor_set_trace_recorder(&recorder);
+
+        KeyboardSimulator& keyboard = scenario.keyboard();
+        keyboard.press_key_at(TAP_DANCE_KEY, 0);
+        keyboard.release_key_at(TAP_DANCE_KEY, 100);
+        keyboard.press_key_at(TAP_DANCE_KEY, 400);
+        keyboard.press_key_at(3004, 700);
+        keyboard.release_key_at(3004, 750);
+        keyboard.release_key_at(TAP_DANCE_KEY, 800);
+        keyboard.press_key_at(3002, 820);
+        keyboard.press_key_at(3003, 830);
+        keyboard.release_key_at(3002, 840);
+        keyboard.release_key_at(3003, 900);
+        keyboard.wait_ms(500);
+        monkeyboard_trace_recorder_flush(&recorder);
+        pipeline_executor_set_trace_recorder(nullptr);
+        recorded_output = g_mock_state.events;
+    }
+    EXPECT_EQ(recorder.recorded_events, 10u);
+    EXPECT_EQ(recorder.dropped_events, 0u);
+
+    char path[] = "/tmp/monkeyboard_trace_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(write(fd, trace.data(), trace.size()), (ssize_t)trace.size());
+    close(fd);
+
+    TestScenario scenario(keymap);
+    build_tap_dance(scenario);
+    {
+        MappedTrace mapped(path);
+        ASSERT_TRUE(mapped.is_open());
+        EXPECT_EQ(replay_trace(mapped.data(), mapped.size(), [](platform_time_t time) { g_mock_state.set_timer(time); }), 10);
+    }
+    g_mock_state.advance_timer(500);
+    std::remove(path);
+
+    ASSERT_EQ(g_mock_state.events.size(), recorded_output.size());
+    for (size_t i = 0; i < recorded_output.size(); i++) {
+        EXPECT_EQ(g_mock_state.events[i], recorded_output[i]);
+        EXPECT_EQ(g_mock_state.events[i].time, recorded_output[i].time);
+    }
+    EXPECT_GT(recorded_output.size(), 0u);
+}
+
+// Without flush callback the events that don't fit in the buffer are dropped and counted
+TEST_F(KeyEventTrace, RecorderWithoutFlushDropsEvents) {
+    uint8_t buffer[MONKEYBOARD_TRACE_HEADER_SIZE + MONKEYBOARD_TRACE_MAX_RECORD_SIZE];
+    monkeyboard_trace_recorder_t recorder;
+    ASSERT_TRUE(monkeyboard_trace_recorder_init(&recorder, buffer, sizeof(buffer), 3, 0, nullptr, nullptr));
+    monkeyboard_trace_recorder_record(&recorder, key_event(0, 0, true, 10));
+    monkeyboard_trace_recorder_record(&recorder, key_event(0, 0, false, 20));
+
+    EXPECT_EQ(recorder.recorded_events, 1u);
+    EXPECT_EQ(recorder.dropped_events, 1u);
+}
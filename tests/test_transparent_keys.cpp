@@ -0,0 +1,113 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include "keyboard_simulator.hpp"
+#include "gtest/gtest.h"
+#include "platform_interface.h"
+#include "platform_mock.hpp"
+#include "platform_types.h"
+#include "test_scenario.hpp"
+#include "tap_dance_test_helpers.hpp"
+
+extern "C" {
+#include "monkeyboard_keycodes.h"
+#include "monkeyboard_layer_manager.h"
+#include "pipeline_tap_dance.h"
+#include "pipeline_tap_dance_initializer.h"
+#include "pipeline_executor.h"
+}
+
+class TransparentKeys : public ::testing::Test {
+protected:
+    static const platform_keycode_t TRNS = PLATFORM_KC_TRANSPARENT;
+
+    static platform_keypos_t keypos(uint8_t col) {
+        platform_keypos_t position;
+        position.row = 0;
+        position.col = col;
+        return position;
+    }
+};
+
+// Transparent keys of the layer held by a tap dance fall through to the base layer
+TEST_F(TransparentKeys, HeldLayerFallsThroughToBaseLayer) {
+    const platform_keycode_t TAP_DANCE_KEY = 3000;
+    const platform_keycode_t OUTPUT_KEY = 3001;
+    const platform_keycode_t BASE_KEY1 = 3010;
+    const platform_keycode_t BASE_KEY2 = 3011;
+    const platform_keycode_t LAYER_KEY1 = 3110;
+    const uint8_t TARGET_LAYER = 1;
+
+    std::vector<std::vector<std::vector<platform_keycode_t>>> keymap = {{
+        { TAP_DANCE_KEY, BASE_KEY1, BASE_KEY2 }
+    }, {
+        { TRNS, LAYER_KEY1, TRNS }
+    }};
+
+    TestScenario scenario(keymap);
+    TapDanceConfigBuilder config_builder;
+    config_builder
+        .add_tap_hold(TAP_DANCE_KEY, {{1, OUTPUT_KEY}}, {{1, TARGET_LAYER}}, 200, 200, TAP_DANCE_HOLD_PREFERRED)
+        .add_to_scenario(scenario);
+
+    scenario.build();
+    KeyboardSimulator& keyboard = scenario.keyboard();
+
+    keyboard.press_key_at(TAP_DANCE_KEY, 0);
+    keyboard.press_key_at(BASE_KEY1, 250);
+    keyboard.release_key_at(BASE_KEY1, 260);
+    keyboard.press_key_at(BASE_KEY2, 270);
+    keyboard.release_key_at(BASE_KEY2, 280);
+    keyboard.release_key_at(TAP_DANCE_KEY, 300);
+
+    std::vector<event_t> expected_events = {
+        td_layer(TARGET_LAYER, 200),
+        td_press(LAYER_KEY1, 250),
+        td_release(LAYER_KEY1, 260),
+        td_press(BASE_KEY2, 270),
+        td_release(BASE_KEY2, 280),
+        td_layer(0, 300)
+    };
+    EXPECT_TRUE(g_mock_state.event_actions_match_absolute(expected_events));
+}
+
+// Transparent keys fall through every active layer, from the newest to the oldest
+TEST_F(TransparentKeys, FallThroughFollowsTheLayerStack) {
+    std::vector<std::vector<std::vector<platform_keycode_t>>> keymap = {
+        {{ 3000, 3001, 3002, 3003 }},
+        {{ 3100, TRNS, TRNS, TRNS }},
+        {{ TRNS, TRNS, 3202, TRNS }},
+        {{ TRNS, 3301, TRNS, TRNS }}
+    };
+
+    TestScenario scenario(keymap);
+    scenario.build();
+
+    layout_manager_add_layer(keypos(0), 1, 1);
+    layout_manager_add_layer(keypos(1), 2, 2);
+    layout_manager_add_layer(keypos(2), 3, 3);
+
+    EXPECT_EQ(platform_layout_get_keycode(keypos(0)), 3100u);
+    EXPECT_EQ(platform_layout_get_keycode(keypos(1)), 3301u);
+    EXPECT_EQ(platform_layout_get_keycode(keypos(2)), 3202u);
+    EXPECT_EQ(platform_layout_get_keycode(keypos(3)), 3003u);
+
+    // Removing a layer below the active one changes what the transparent keys resolve to
+    layout_manager_remove_layer_by_press_id(2);
+    EXPECT_EQ(platform_layout_get_current_layer(), 3);
+    EXPECT_EQ(platform_layout_get_keycode(keypos(2)), 3002u);
+    EXPECT_EQ(platform_layout_get_keycode(keypos(0)), 3100u);
+}
+
+// A transparent key on the base layer resolves to no key
+TEST_F(TransparentKeys, TransparentBaseLayerKeyResolvesToNoKey) {
+    std::vector<std::vector<std::vector<platform_keycode_t>>> keymap = {
+        {{ 3000, TRNS }}
+    };
+
+    TestScenario scenario(keymap);
+    scenario.build();
+
+    EXPECT_EQ(platform_layout_get_keycode(keypos(1)), (platform_keycode_t)PLATFORM_KC_NO);
+}
@@ -0,0 +1,146 @@
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "platform_interface.h"
+#include "platform_mock.hpp"
+#include "platform_types.h"
+#include "test_scenario.hpp"
+#include "typing_corpus_generator.hpp"
+
+extern "C" {
+#include "pipeline_executor.h"
+}
+
+class TypingCorpus : public ::testing::Test {
+protected:
+    // HID keycodes of a 3x10 letter block and a space bar
+    std::vector<platform_keycode_t> layer = {
+        0x14, 0x1A, 0x08, 0x15, 0x17, 0x1C, 0x18, 0x0C, 0x12, 0x13,
+        0x04, 0x16, 0x07, 0x09, 0x0A, 0x0B, 0x0D, 0x0E, 0x0F, 0x33,
+        0x1D, 0x1B, 0x06, 0x19, 0x05, 0x11, 0x10, 0x36, 0x37, 0x2C
+    };
+    std::map<char, platform_keypos_t> key_positions = TypingCorpusGenerator::key_positions_from_keymap(layer.data(), 3, 10);
+
+    static bool same_stream(const std::vector<abskeyevent_t>& a, const std::vector<abskeyevent_t>& b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); i++) {
+            if (a[i].time != b[i].time || a[i].pressed != b[i].pressed || a[i].keypos.row != b[i].keypos.row || a[i].keypos.col != b[i].keypos.col) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Presses that happen while the previous key is still held
+    static size_t count_rollovers(const std::vector<abskeyevent_t>& events) {
+        size_t held = 0;
+        size_t rollovers = 0;
+        for (const abskeyevent_t& event : events) {
+            if (event.pressed) {
+                if (held > 0) rollovers++;
+                held++;
+            } else {
+                held--;
+            }
+        }
+        return rollovers;
+    }
+};
+
+// The same seed gives the same stream, another seed a different one
+TEST_F(TypingCorpus, SeedIsDeterministic) {
+    TypingModel model;
+    TypingCorpusGenerator first(key_positions, model, 42);
+    TypingCorpusGenerator second(key_positions, model, 42);
+    TypingCorpusGenerator third(key_positions, model, 43);
+    std::string text = first.random_text(50);
+    EXPECT_EQ(second.random_text(50), text);
+    third.random_text(50);
+
+    std::vector<abskeyevent_t> events = first.generate(text);
+    EXPECT_TRUE(same_stream(second.generate(text), events));
+    EXPECT_FALSE(same_stream(third.generate(text), events));
+}
+
+// Every press is released once, no key is pressed while held and the time never goes back
+TEST_F(TypingCorpus, StreamIsWellFormed) {
+    TypingModel model;
+    model.burst_wpm = 200;
+    model.rollover_probability = 0.5;
+    TypingCorpusGenerator generator(key_positions, model, 7);
+    std::string text = generator.random_text(400);
+    std::vector<abskeyevent_t> events = generator.generate(text);
+
+    size_t typed_characters = 0;
+    for (char character : text) {
+        typed_characters += key_positions.count(character);
+    }
+    ASSERT_EQ(events.size(), typed_characters * 2);
+
+    std::map<std::pair<uint8_t, uint8_t>, bool> held;
+    platform_time_t time = 0;
+    for (const abskeyevent_t& event : events) {
+        EXPECT_GE(event.time, time);
+        time = event.time;
+        bool& is_held = held[{event.keypos.row, event.keypos.col}];
+        EXPECT_NE(is_held, event.pressed);
+        is_held = event.pressed;
+    }
+    for (const auto& key : held) {
+        EXPECT_FALSE(key.second);
+    }
+}
+
+// The typing speed follows the model, and there are no rollovers without rollover probability
+TEST_F(TypingCorpus, TimingFollowsTheModel) {
+    for (double wpm : { 60.0, 120.0, 200.0 }) {
+        TypingModel model;
+        model.burst_wpm = wpm;
+        model.word_pause_ms = 0;
+        model.rollover_probability = 0;
+        TypingCorpusGenerator generator(key_positions, model, 1);
+        std::vector<abskeyevent_t> events = generator.generate(std::string(2000, 'e'));
+        double mean_interval = (double)(events.back().time - events.front().time) / 1999.0;
+        double expected_interval = 60000.0 / (wpm * 5.0);
+        EXPECT_NEAR(mean_interval, expected_interval, expected_interval * 0.1) << wpm << " WPM";
+        EXPECT_EQ(count_rollovers(events), 0u) << wpm << " WPM";
+    }
+
+    TypingModel model;
+    model.rollover_probability = 1;
+    TypingCorpusGenerator generator(key_positions, model, 1);
+    std::string text = generator.random_text(200);
+    std::vector<abskeyevent_t> events = generator.generate(text);
+    EXPECT_GT(count_rollovers(events), events.size() / 4);
+}
+
+// Without pipelines the corpus types the text
+TEST_F(TypingCorpus, TypesTheTextThroughTheExecutor) {
+    std::vector<std::vector<std::vector<platform_keycode_t>>> keymap = {{
+        { layer.begin(), layer.begin() + 10 }, { layer.begin() + 10, layer.begin() + 20 }, { layer.begin() + 20, layer.end() }
+    }};
+    TestScenario scenario(keymap);
+    scenario.build();
+
+    TypingModel model;
+    model.burst_wpm = 150;
+    TypingCorpusGenerator generator(key_positions, model, 3);
+    std::string text = "the quick brown fox jumps over the lazy dog.";
+    for (const abskeyevent_t& event : generator.generate(text, 100)) {
+        g_mock_state.set_timer(event.time);
+        pipeline_process_key(event);
+    }
+
+    std::vector<platform_keycode_t> pressed;
+    for (const event_t& event : g_mock_state.events) {
+        if (event.type == event_type_t::KEY_PRESS) pressed.push_back(event.keycode);
+    }
+    std::vector<platform_keycode_t> expected;
+    for (char character : text) {
+        platform_keypos_t keypos = key_positions.at(character);
+        expected.push_back(layer[keypos.row * 10 + keypos.col]);
+    }
+    EXPECT_EQ(pressed, expected);
+}
@@ -0,0 +1,75 @@
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "keyboard_simulator.hpp"
+#include "gtest/gtest.h"
+#include "platform_interface.h"
+#include "platform_mock.hpp"
+#include "platform_types.h"
+#include "test_scenario.hpp"
+
+extern "C" {
+#include "key_virtual_buffer.h"
+#include "pipeline_executor.h"
+}
+
+// Sends a macro of MACRO_LENGTH taps when the macro key is pressed, more virtual events than the virtual buffer holds
+static constexpr platform_keycode_t MACRO_KEY = 3000;
+static constexpr platform_keycode_t MACRO_FIRST_KEYCODE = 4000;
+static constexpr uint8_t MACRO_LENGTH = 3 * PLATFORM_KEY_VIRTUAL_BUFFER_MAX_ELEMENTS;
+
+static void macro_callback(pipeline_physical_callback_params_t* params, const pipeline_physical_actions_t* actions, const pipeline_physical_return_actions_t* return_actions, void* user_data) {
+    platform_key_event_t* event = params->key_event;
+    if (params->callback_type == PIPELINE_CALLBACK_KEY_EVENT && event->keycode == MACRO_KEY) {
+        if (event->is_press) {
+            for (uint8_t i = 0; i < MACRO_LENGTH; i++) {
+                actions->tap_key_fn(MACRO_FIRST_KEYCODE + i);
+            }
+            actions->remove_physical_press_fn(event->press_id);
+        } else {
+            actions->remove_physical_release_fn(event->press_id);
+        }
+    }
+    return_actions->no_capture_fn();
+}
+
+static void macro_reset(void* user_data) {
+    (void)user_data;
+}
+
+class VirtualEventStream : public ::testing::Test {
+protected:
+    std::vector<std::vector<std::vector<platform_keycode_t>>> keymap = {
+        {{ MACRO_KEY, 3001 }}
+    };
+
+    static std::vector<std::pair<event_type_t, platform_keycode_t>> recorded_actions() {
+        std::vector<std::pair<event_type_t, platform_keycode_t>> actions;
+        for (const event_t& event : g_mock_state.events) {
+            actions.push_back({ event.type, event.keycode });
+        }
+        return actions;
+    }
+};
+
+// A macro longer than the virtual buffer is streamed through the virtual stage without losing any key
+TEST_F(VirtualEventStream, LongMacroIsNotTruncated) {
+    TestScenario scenario(keymap);
+    scenario.add_physical_pipeline(&macro_callback, &macro_reset, nullptr);
+    scenario.build();
+
+    KeyboardSimulator& keyboard = scenario.keyboard();
+    keyboard.press_key_at(MACRO_KEY, 0);
+    keyboard.release_key_at(MACRO_KEY, 10);
+    keyboard.press_key_at(3001, 20);
+    keyboard.release_key_at(3001, 30);
+
+    std::vector<std::pair<event_type_t, platform_keycode_t>> expected;
+    for (uint8_t i = 0; i < MACRO_LENGTH; i++) {
+        expected.push_back({ event_type_t::KEY_PRESS, MACRO_FIRST_KEYCODE + i });
+        expected.push_back({ event_type_t::KEY_RELEASE, MACRO_FIRST_KEYCODE + i });
+    }
+    expected.push_back({ event_type_t::KEY_PRESS, 3001 });
+    expected.push_back({ event_type_t::KEY_RELEASE, 3001 });
+    EXPECT_EQ(recorded_actions(), expected);
+}
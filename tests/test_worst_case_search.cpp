@@ -0,0 +1,135 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "keyboard_simulator.hpp"
+#include "gtest/gtest.h"
+#include "platform_interface.h"
+#include "platform_mock.hpp"
+#include "platform_types.h"
+#include "test_scenario.hpp"
+#include "combo_test_helpers.hpp"
+#include "tap_dance_test_helpers.hpp"
+#include "trace_replayer.hpp"
+#include "worst_case_search.hpp"
+
+extern "C" {
+#include "pipeline_executor.h"
+}
+
+// Worst case search on a combo and a tap dance with multi-tap and hold. With MONKEYBOARD_WORST_CASE_TRACE set to a
+// path, the worst sequence found is written there as a trace
+class WorstCaseSearchTest : public ::testing::Test {
+protected:
+    static constexpr platform_keycode_t COMBO_KEY_A = 3000;
+    static constexpr platform_keycode_t COMBO_KEY_B = 3001;
+    static constexpr platform_keycode_t TAP_DANCE_KEY = 3002;
+    static constexpr platform_keycode_t KEY_A = 4;
+    static constexpr platform_keycode_t KEY_B = 5;
+    static constexpr uint8_t COLS = 5;
+
+    std::vector<std::vector<std::vector<platform_keycode_t>>> keymap = {
+        {{ COMBO_KEY_A, COMBO_KEY_B, TAP_DANCE_KEY, KEY_A, KEY_B }},
+        {{ KEY_A,       KEY_B,       TAP_DANCE_KEY, KEY_A, KEY_B }}
+    };
+
+    void build(TestScenario& scenario) {
+        ComboConfigBuilder combo_builder;
+        std::vector<ComboKeyBuilder> combo_keys = { ComboKeyBuilder({0, 0}), ComboKeyBuilder({0, 1}) };
+        combo_builder
+            .with_strategy(COMBO_STRATEGY_DISCARD_WHEN_ONE_PRESSED_IN_COMMON)
+            .add_combo(combo_keys, create_combo_key_action(COMBO_KEY_ACTION_REGISTER, 7), create_combo_key_action(COMBO_KEY_ACTION_UNREGISTER, 7))
+            .add_to_scenario(scenario);
+        TapDanceConfigBuilder tap_dance_builder;
+        tap_dance_builder
+            .add_tap_hold(TAP_DANCE_KEY, {{1, 8}, {2, 9}}, {{1, 1}}, 200, 200, TAP_DANCE_TAP_PREFERRED)
+            .add_to_scenario(scenario);
+        scenario.build();
+    }
+
+    std::vector<platform_keypos_t> keys() {
+        std::vector<platform_keypos_t> positions;
+        for (uint8_t col = 0; col < COLS; col++) {
+            platform_keypos_t keypos;
+            keypos.row = 0;
+            keypos.col = col;
+            positions.push_back(keypos);
+        }
+        return positions;
+    }
+
+    static void set_timer(platform_time_t time) {
+        g_mock_state.set_timer(time);
+    }
+};
+
+// The search finds sequences costlier than its random start, and the same seed finds the same sequence
+TEST_F(WorstCaseSearchTest, ClimbsOverRandomInput) {
+    WorstCaseSearchOptions options;
+    options.iterations = 1;
+    WorstCaseResult random_start;
+    {
+        TestScenario scenario(keymap);
+        build(scenario);
+        random_start = WorstCaseSearch<void (*)(platform_time_t)>(keys(), options, &set_timer).run(0);
+    }
+
+    options.iterations = 300;
+    WorstCaseResult first;
+    {
+        TestScenario scenario(keymap);
+        build(scenario);
+        first = WorstCaseSearch<void (*)(platform_time_t)>(keys(), options, &set_timer).run(0);
+    }
+    WorstCaseResult second;
+    {
+        TestScenario scenario(keymap);
+        build(scenario);
+        second = WorstCaseSearch<void (*)(platform_time_t)>(keys(), options, &set_timer).run(0);
+    }
+
+    EXPECT_EQ(first.evaluated, 300u);
+    EXPECT_GT(first.improvements, 0u);
+    EXPECT_GT(first.worst_callbacks, random_start.worst_callbacks);
+    EXPECT_EQ(second.worst_callbacks, first.worst_callbacks);
+    EXPECT_EQ(second.trace(COLS), first.trace(COLS));
+}
+
+// Replaying the trace of the worst sequence on a fresh executor costs the same
+TEST_F(WorstCaseSearchTest, WorstSequenceReplaysFromItsTrace) {
+    WorstCaseSearchOptions options;
+    options.iterations = 200;
+    options.seed = 7;
+    WorstCaseResult result;
+    {
+        TestScenario scenario(keymap);
+        build(scenario);
+        result = WorstCaseSearch<void (*)(platform_time_t)>(keys(), options, &set_timer).run(0);
+    }
+    std::vector<uint8_t> trace = result.trace(COLS);
+
+    const char* path = std::getenv("MONKEYBOARD_WORST_CASE_TRACE");
+    if (path != nullptr) {
+        FILE* file = std::fopen(path, "wb");
+        ASSERT_NE(file, nullptr);
+        std::fwrite(trace.data(), 1, trace.size(), file);
+        std::fclose(file);
+        std::printf("Worst case: %u callbacks at event %zu of %zu, written to %s\n", result.worst_callbacks, result.worst_event, result.events.size(), path);
+    }
+
+    TestScenario scenario(keymap);
+    build(scenario);
+    monkeyboard_trace_reader_t reader;
+    ASSERT_TRUE(monkeyboard_trace_reader_init(&reader, trace.data(), trace.size()));
+    std::vector<abskeyevent_t> events;
+    abskeyevent_t event;
+    while (monkeyboard_trace_read_event(&reader, &event)) {
+        events.push_back(event);
+    }
+    ASSERT_EQ(events.size(), result.events.size());
+    g_mock_state.set_timer(events.front().time - 1);
+    WorstCaseCost cost = measure_worst_case(events, &set_timer, options.settle_ms);
+    EXPECT_EQ(cost.worst, result.worst_callbacks);
+    EXPECT_EQ(cost.worst_event, result.worst_event);
+    EXPECT_EQ(cost.total, result.total_callbacks);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "platform_types.h"
+
+extern "C" {
+#include "monkeyboard_trace.h"
+#include "pipeline_executor.h"
+}
+
+// Read-only memory mapping of a trace file (see monkeyboard_trace.h). The events are decoded from the mapping, the
+// file is never copied, so traces of millions of events can be replayed
+class MappedTrace {
+public:
+    explicit MappedTrace(const char* path) {
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) return;
+        struct stat status;
+        if (fstat(fd, &status) == 0 && status.st_size > 0) {
+            void* mapping = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED) {
+                madvise(mapping, static_cast<size_t>(status.st_size), MADV_SEQUENTIAL);
+                data_ = static_cast<const uint8_t*>(mapping);
+                size_ = static_cast<size_t>(status.st_size);
+            }
+        }
+        close(fd);
+    }
+
+    ~MappedTrace() {
+        if (data_ != nullptr) munmap(const_cast<uint8_t*>(data_), size_);
+    }
+
+    MappedTrace(const MappedTrace&) = delete;
+    MappedTrace& operator=(const MappedTrace&) = delete;
+
+    bool is_open() const { return data_ != nullptr; }
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Feeds every event of the trace to pipeline_process_key as fast as possible under virtual time:
+// set_timer(time) has to move the platform time to the event time, executing the deferred callbacks due
+// (g_mock_state.set_timer in the tests, g_bench_state.set_timer in the benchmarks).
+// Returns the number of events replayed, or -1 when the trace header is invalid
+template <typename SetTimer>
+long long replay_trace(const uint8_t* data, size_t size, SetTimer set_timer) {
+    monkeyboard_trace_reader_t reader;
+    if (!monkeyboard_trace_reader_init(&reader, data, size)) {
+        return -1;
+    }
+    long long count = 0;
+    abskeyevent_t event;
+    while (monkeyboard_trace_read_event(&reader, &event)) {
+        set_timer(event.time);
+        pipeline_process_key(event);
+        count++;
+    }
+    return count;
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "platform_types.h"
+
+// Synthetic typing corpus: turns text into abskeyevent_t streams with a statistical timing model, to stress the
+// combo and tap dance decisions with realistic rollovers at 60-200 WPM. The same seed always gives the same stream.
+// Shared by the tests and the benchmarks.
+//
+// Characters are looked up by their HID keycode on a layer of the keymap. Uppercase letters are typed as lowercase
+// (no shift is modeled) and characters not on the layer are skipped.
+
+struct TypingModel {
+    double burst_wpm = 80;              // Speed within a word, 5 characters per word
+    double interval_jitter = 0.35;      // Sigma of the log-normal interval between two presses
+    double word_pause_ms = 120;         // Mean extra pause after a space
+    double hold_mean_ms = 95;           // Time a key is held
+    double hold_stddev_ms = 25;
+    double rollover_probability = 0.2;  // Probability that a key is still held when the next one is pressed
+};
+
+class TypingCorpusGenerator {
+public:
+    static constexpr platform_time_t MIN_INTERVAL_MS = 15;
+    static constexpr platform_time_t MIN_HOLD_MS = 20;
+
+    TypingCorpusGenerator(const std::map<char, platform_keypos_t>& key_positions, const TypingModel& model, uint32_t seed)
+        : key_positions_(key_positions), model_(model), random_(seed) {}
+
+    // Positions of the characters with a HID keycode on the layer (rows * cols keycodes)
+    static std::map<char, platform_keypos_t> key_positions_from_keymap(const platform_keycode_t* layer, uint8_t rows, uint8_t cols) {
+        std::map<char, platform_keypos_t> positions;
+        for (uint8_t row = 0; row < rows; row++) {
+            for (uint8_t col = 0; col < cols; col++) {
+                char character = character_from_keycode(layer[row * cols + col]);
+                if (character != 0 && positions.find(character) == positions.end()) {
+                    platform_keypos_t keypos;
+                    keypos.row = row;
+                    keypos.col = col;
+                    positions[character] = keypos;
+                }
+            }
+        }
+        return positions;
+    }
+
+    // Lowercase pseudo words with the letter frequencies of English text, separated by spaces
+    std::string random_text(size_t words) {
+        static const double letter_frequencies[26] = {
+            8.2, 1.5, 2.8, 4.3, 12.7, 2.2, 2.0, 6.1, 7.0, 0.2, 0.8, 4.0, 2.4,
+            6.7, 7.5, 1.9, 0.1, 6.0, 6.3, 9.1, 2.8, 1.0, 2.4, 0.2, 2.0, 0.1
+        };
+        std::discrete_distribution<int> letter(std::begin(letter_frequencies), std::end(letter_frequencies));
+        std::uniform_int_distribution<int> length(1, 8);
+        std::string text;
+        for (size_t i = 0; i < words; i++) {
+            if (i > 0) text += ' ';
+            for (int j = length(random_); j > 0; j--) {
+                text += static_cast<char>('a' + letter(random_));
+            }
+        }
+        return text;
+    }
+
+    // Events sorted by time, a release before a press at the same time
+    std::vector<abskeyevent_t> generate(const std::string& text, platform_time_t start_time = 0) {
+        std::vector<platform_keypos_t> keys;
+        std::vector<platform_time_t> presses;
+        platform_time_t time = start_time;
+        char previous = 0;
+        for (char character : text) {
+            auto position = key_positions_.find(static_cast<char>(std::tolower(static_cast<unsigned char>(character))));
+            if (position == key_positions_.end()) continue;
+            if (!keys.empty()) {
+                time += next_interval(previous == ' ');
+            }
+            keys.push_back(position->second);
+            presses.push_back(time);
+            previous = position->first;
+        }
+
+        std::vector<abskeyevent_t> events;
+        events.reserve(keys.size() * 2);
+        for (size_t i = 0; i < keys.size(); i++) {
+            platform_time_t release = presses[i] + next_hold();
+            if (i + 1 < keys.size()) {
+                platform_time_t next_press = presses[i + 1];
+                if (std::bernoulli_distribution(model_.rollover_probability)(random_) && !same_key(keys[i], keys[i + 1])) {
+                    // Released after the next press
+                    release = std::max<platform_time_t>(release, next_press + 1);
+                } else {
+                    release = std::min<platform_time_t>(release, next_press - 1);
+                }
+            }
+            // A key is always released before it's pressed again
+            for (size_t j = i + 1; j < keys.size(); j++) {
+                if (same_key(keys[i], keys[j])) {
+                    release = std::min<platform_time_t>(release, presses[j] - 1);
+                    break;
+                }
+            }
+            release = std::max<platform_time_t>(release, presses[i] + 1);
+            events.push_back(make_event(keys[i], true, presses[i]));
+            events.push_back(make_event(keys[i], false, release));
+        }
+        std::stable_sort(events.begin(), events.end(), [](const abskeyevent_t& a, const abskeyevent_t& b) {
+            return a.time != b.time ? a.time < b.time : (!a.pressed && b.pressed);
+        });
+        return events;
+    }
+
+private:
+    std::map<char, platform_keypos_t> key_positions_;
+    TypingModel model_;
+    std::mt19937 random_;
+
+    static char character_from_keycode(platform_keycode_t keycode) {
+        if (keycode >= 0x04 && keycode <= 0x1D) return static_cast<char>('a' + keycode - 0x04);
+        if (keycode >= 0x1E && keycode <= 0x26) return static_cast<char>('1' + keycode - 0x1E);
+        switch (keycode) {
+            case 0x27: return '0';
+            case 0x28: return '\n';
+            case 0x2C: return ' ';
+            case 0x2D: return '-';
+            case 0x2E: return '=';
+            case 0x2F: return '[';
+            case 0x30: return ']';
+            case 0x31: return '\\';
+            case 0x33: return ';';
+            case 0x34: return '\'';
+            case 0x35: return '`';
+            case 0x36: return ',';
+            case 0x37: return '.';
+            case 0x38: return '/';
+        }
+        return 0;
+    }
+
+    static bool same_key(platform_keypos_t a, platform_keypos_t b) {
+        return a.row == b.row && a.col == b.col;
+    }
+
+    static abskeyevent_t make_event(platform_keypos_t keypos, bool pressed, platform_time_t time) {
+        abskeyevent_t event;
+        event.keypos = keypos;
+        event.pressed = pressed;
+        event.time = time;
+        return event;
+    }
+
+    platform_time_t next_interval(bool after_space) {
+        double mean = 60000.0 / (model_.burst_wpm * 5.0);
+        double sigma = model_.interval_jitter;
+        // Log-normal with the given mean: typing intervals are skewed towards long pauses
+        std::lognormal_distribution<double> interval(std::log(mean) - sigma * sigma / 2.0, sigma);
+        double value = interval(random_);
+        if (after_space && model_.word_pause_ms > 0) {
+            value += std::exponential_distribution<double>(1.0 / model_.word_pause_ms)(random_);
+        }
+        return std::max<platform_time_t>(MIN_INTERVAL_MS, static_cast<platform_time_t>(std::lround(value)));
+    }
+
+    platform_time_t next_hold() {
+        double value = std::normal_distribution<double>(model_.hold_mean_ms, model_.hold_stddev_ms)(random_);
+        return std::max<platform_time_t>(MIN_HOLD_MS, static_cast<platform_time_t>(std::lround(std::max(0.0, value))));
+    }
+};
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "platform_types.h"
+
+extern "C" {
+#include "monkeyboard_trace.h"
+#include "pipeline_executor.h"
+}
+
+// Adversarial input search for the worst case execution of the executor: looks for the key sequences that make a single
+// pipeline_process_key (or a single timer) run the most pipeline callbacks, counted with the executor stats
+// (MONKEYBOARD_EXECUTOR_STATS). The worst sequence found is returned as a trace (monkeyboard_trace.h), to replay it
+// with trace_replayer.hpp and measure it on the target.
+//
+// The search is a hill climbing on sequences of key toggles: each step presses the key if it's released and releases
+// it otherwise, so every mutation is a valid key sequence. The held keys are released at the end and the timeouts are
+// let expire, the pipelines are idle again before the next candidate. The intervals are drawn around the timeouts of
+// the configuration, where the decisions of the pipelines change.
+//
+// The executor has to be built with the configuration before running the search. set_timer(time) moves the platform
+// time executing the deferred callbacks due (g_mock_state.set_timer in the tests).
+
+struct WorstCaseSearchOptions {
+    size_t toggles = 24;                              // Key toggles per candidate
+    size_t iterations = 500;                          // Candidates evaluated
+    uint32_t seed = 1;
+    platform_time_t max_interval_ms = 300;
+    std::vector<platform_time_t> timeouts = { 50, 200 }; // The intervals are biased towards these values +-1ms
+    platform_time_t settle_ms = 1000;                 // Wait after each candidate for the timeouts to expire
+};
+
+struct WorstCaseResult {
+    std::vector<abskeyevent_t> events; // Key events of the worst candidate, with absolute times
+    uint32_t worst_callbacks = 0;      // Callbacks of the costliest pipeline_process_key or timer of the candidate
+    uint32_t total_callbacks = 0;      // Callbacks of the whole candidate
+    // Event whose processing, or the timers fired before it, cost the most. events.size() for the timers fired after
+    // the last event
+    size_t worst_event = 0;
+    size_t evaluated = 0;
+    size_t improvements = 0;
+
+    // The events in the trace format, replayable with replay_trace
+    std::vector<uint8_t> trace(uint8_t cols) const {
+        std::vector<uint8_t> data(MONKEYBOARD_TRACE_HEADER_SIZE + events.size() * MONKEYBOARD_TRACE_MAX_RECORD_SIZE);
+        platform_time_t start_time = events.empty() ? 0 : events.front().time;
+        size_t size = monkeyboard_trace_write_header(data.data(), cols, start_time);
+        monkeyboard_trace_encoder_t encoder;
+        monkeyboard_trace_encoder_init(&encoder, cols, start_time);
+        for (const abskeyevent_t& event : events) {
+            size += monkeyboard_trace_encode_event(&encoder, event, data.data() + size);
+        }
+        data.resize(size);
+        return data;
+    }
+};
+
+// Pipeline callbacks run by the executor so far
+inline uint32_t executor_callbacks() {
+    const pipeline_executor_stats_t* stats = pipeline_executor_get_stats();
+    uint32_t callbacks = 0;
+    for (size_t i = 0; i < PIPELINE_EXECUTOR_STATS_MAX_PIPELINES; i++) {
+        callbacks += stats->physical_callbacks[i] + stats->virtual_callbacks[i];
+    }
+    return callbacks;
+}
+
+struct WorstCaseCost {
+    uint32_t worst = 0;
+    uint32_t total = 0;
+    size_t worst_event = 0;
+
+    bool operator>=(const WorstCaseCost& other) const {
+        return worst != other.worst ? worst > other.worst : total >= other.total;
+    }
+};
+
+// Runs the events through the executor and measures the callbacks of every pipeline_process_key and of the timers
+// fired before each event. The timers fired in the settle_ms after the last event count as event events.size()
+template <typename SetTimer>
+WorstCaseCost measure_worst_case(const std::vector<abskeyevent_t>& events, SetTimer set_timer, platform_time_t settle_ms) {
+    WorstCaseCost cost;
+    uint32_t start = executor_callbacks();
+    for (size_t i = 0; i < events.size(); i++) {
+        uint32_t before_timers = executor_callbacks();
+        set_timer(events[i].time);
+        uint32_t before_event = executor_callbacks();
+        pipeline_process_key(events[i]);
+        uint32_t after_event = executor_callbacks();
+        uint32_t event_cost = std::max(before_event - before_timers, after_event - before_event);
+        if (event_cost > cost.worst) {
+            cost.worst = event_cost;
+            cost.worst_event = i;
+        }
+    }
+    if (!events.empty()) {
+        uint32_t before_timers = executor_callbacks();
+        set_timer(events.back().time + settle_ms);
+        if (executor_callbacks() - before_timers > cost.worst) {
+            cost.worst = executor_callbacks() - before_timers;
+            cost.worst_event = events.size();
+        }
+    }
+    cost.total = executor_callbacks() - start;
+    return cost;
+}
+
+template <typename SetTimer>
+class WorstCaseSearch {
+public:
+    WorstCaseSearch(const std::vector<platform_keypos_t>& keys, const WorstCaseSearchOptions& options, SetTimer set_timer)
+        : keys_(keys), options_(options), set_timer_(set_timer), random_(options.seed) {}
+
+    // current_time is the platform time when the search starts, the candidates are played after it
+    WorstCaseResult run(platform_time_t current_time) {
+        time_ = current_time;
+        WorstCaseResult result;
+        std::vector<toggle_t> best = random_candidate();
+        WorstCaseCost best_cost = evaluate(best, result.events);
+        result.evaluated = 1;
+
+        for (size_t i = 1; i < options_.iterations; i++) {
+            std::vector<toggle_t> candidate = mutate(best);
+            std::vector<abskeyevent_t> events;
+            WorstCaseCost cost = evaluate(candidate, events);
+            result.evaluated++;
+            // Equal costs are accepted to move along plateaus
+            if (cost >= best_cost) {
+                if (cost.worst > best_cost.worst) result.improvements++;
+                best = candidate;
+                best_cost = cost;
+                result.events = events;
+            }
+        }
+        result.worst_callbacks = best_cost.worst;
+        result.total_callbacks = best_cost.total;
+        result.worst_event = best_cost.worst_event;
+        return result;
+    }
+
+    platform_time_t time() const { return time_; }
+
+private:
+    struct toggle_t {
+        size_t key;
+        platform_time_t interval; // Since the previous toggle
+    };
+
+    std::vector<platform_keypos_t> keys_;
+    WorstCaseSearchOptions options_;
+    SetTimer set_timer_;
+    std::mt19937 random_;
+    platform_time_t time_ = 0;
+
+    platform_time_t random_interval() {
+        if (!options_.timeouts.empty() && std::bernoulli_distribution(0.5)(random_)) {
+            platform_time_t timeout = options_.timeouts[std::uniform_int_distribution<size_t>(0, options_.timeouts.size() - 1)(random_)];
+            int offset = std::uniform_int_distribution<int>(-1, 1)(random_);
+            return static_cast<platform_time_t>(std::max(0, static_cast<int>(timeout) + offset));
+        }
+        return std::uniform_int_distribution<platform_time_t>(0, options_.max_interval_ms)(random_);
+    }
+
+    toggle_t random_toggle() {
+        toggle_t toggle;
+        toggle.key = std::uniform_int_distribution<size_t>(0, keys_.size() - 1)(random_);
+        toggle.interval = random_interval();
+        return toggle;
+    }
+
+    std::vector<toggle_t> random_candidate() {
+        std::vector<toggle_t> candidate;
+        for (size_t i = 0; i < options_.toggles; i++) {
+            candidate.push_back(random_toggle());
+        }
+        return candidate;
+    }
+
+    std::vector<toggle_t> mutate(std::vector<toggle_t> candidate) {
+        int mutations = std::uniform_int_distribution<int>(1, 3)(random_);
+        for (int i = 0; i < mutations; i++) {
+            size_t position = std::uniform_int_distribution<size_t>(0, candidate.size() - 1)(random_);
+            switch (std::uniform_int_distribution<int>(0, 3)(random_)) {
+                case 0: candidate[position].key = random_toggle().key; break;
+                case 1: candidate[position].interval = random_interval(); break;
+                case 2:
+                    if (position + 1 < candidate.size()) std::swap(candidate[position], candidate[position + 1]);
+                    break;
+                default: {
+                    // Moves a toggle elsewhere, keeping the length
+                    toggle_t toggle = candidate[position];
+                    candidate.erase(candidate.begin() + static_cast<std::ptrdiff_t>(position));
+                    size_t target = std::uniform_int_distribution<size_t>(0, candidate.size())(random_);
+                    candidate.insert(candidate.begin() + static_cast<std::ptrdiff_t>(target), toggle);
+                    break;
+                }
+            }
+        }
+        return candidate;
+    }
+
+    static abskeyevent_t make_event(platform_keypos_t keypos, bool pressed, platform_time_t time) {
+        abskeyevent_t event;
+        event.keypos = keypos;
+        event.pressed = pressed;
+        event.time = time;
+        return event;
+    }
+
+    WorstCaseCost evaluate(const std::vector<toggle_t>& candidate, std::vector<abskeyevent_t>& events) {
+        events.clear();
+        std::vector<bool> held(keys_.size(), false);
+        platform_time_t time = time_ + 1;
+        for (const toggle_t& toggle : candidate) {
+            time += toggle.interval;
+            held[toggle.key] = !held[toggle.key];
+            events.push_back(make_event(keys_[toggle.key], held[toggle.key], time));
+        }
+        for (size_t key = 0; key < keys_.size(); key++) {
+            if (held[key]) events.push_back(make_event(keys_[key], false, ++time));
+        }
+        WorstCaseCost cost = measure_worst_case(events, set_timer_, options_.settle_ms);
+        time_ = time + options_.settle_ms;
+        return cost;
+    }
+};